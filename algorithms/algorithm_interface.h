@@ -1,4 +1,7 @@
 #pragma once
+#include <cstddef>
+
+class Arena; // Scratch memory for whole-array runs, see arena.h
 
 /**
  * Simple interface for sorting algorithms
@@ -22,6 +25,75 @@ struct SwapResult
  */
 typedef SwapResult (*SortingFunction)(int array[], int size, int *state);
 
+/**
+ * Typed state, for algorithms that need more than a few ints
+ * (a recursion stack, buckets as big as the array, ...)
+ *
+ * Each run allocates bytesFor(size) zeroed bytes, calls init, hands the block
+ * to every step as `state` (use typedState<T>(state) to get your struct back)
+ * and calls destroy when the run ends. Keep the block free of pointers - use
+ * indices, and put variable-sized parts right after the struct - so a run can
+ * be snapshotted and restored by copying its bytes.
+ */
+struct StateType
+{
+    size_t (*bytesFor)(int size);
+    void (*init)(void *state, int size); // nullptr: all zero is the initial state
+    void (*destroy)(void *state);        // nullptr: nothing to release
+};
+
+template <typename T>
+inline T &typedState(int *state)
+{
+    return *reinterpret_cast<T *>(state);
+}
+
+/**
+ * Optional fast path that sorts the whole array in one call
+ * Used when nothing is being visualized (file sorting, benchmarks)
+ * @param array: Array to sort (modify in place)
+ * @param size: Number of elements in array
+ * @param scratch: Take temporary buffers from here instead of the heap
+ */
+typedef void (*BulkSortFunction)(int array[], int size, Arena &scratch);
+
+/**
+ * Fast path of a selection algorithm (ALGO_SELECTION)
+ * @param array: Array to rearrange in place
+ * @param size: Number of elements in array
+ * @param k: With ALGO_PARTIAL_SORT the k smallest end up sorted in array[0..k);
+ *           otherwise array[k] ends up holding the value it would have after a
+ *           full sort, with nothing larger before it and nothing smaller after
+ */
+typedef void (*SelectFunction)(int array[], int size, int k);
+
+/**
+ * The k that step versions of selection algorithms work on, so a visualized
+ * run ends with the median in place
+ */
+inline int selectionStepRank(int size)
+{
+    return size / 2;
+}
+
+/**
+ * Capability flags an algorithm declares when it is registered
+ * Combine with | and pass as the last argument of registerAlgorithm()
+ */
+enum AlgorithmCapability
+{
+    ALGO_STABLE = 1 << 0,        // Equal elements keep their original relative order
+    ALGO_IN_PLACE = 1 << 1,      // Only the array itself and the state are modified, and the
+                                 // whole-array path needs no buffer the size of the array
+    ALGO_ADAPTIVE = 1 << 2,      // Does less work on input that is already partly sorted
+    ALGO_PARALLEL_SAFE = 1 << 3, // Several runs may step at the same time (no shared statics)
+    ALGO_SELECTION = 1 << 4,     // Selects the k smallest instead of sorting (see SelectFunction)
+    ALGO_PARTIAL_SORT = 1 << 5,  // With ALGO_SELECTION: the k smallest come out sorted
+    ALGO_PERMUTING = 1 << 6      // After every step the array is a permutation of the input
+                                 // (values are moved, never overwritten), so min, max and
+                                 // median stay what they were
+};
+
 /**
  * Information about a registered algorithm
  */
@@ -29,5 +101,17 @@ struct AlgorithmInfo
 {
     const char *name;
     SortingFunction function;
-    int stateSize; // Number of integers needed for state
+    int stateSize;       // Number of integers needed for state (0 with a StateType)
+    StateType stateType; // All nullptr for plain int state
+    int capabilities;    // AlgorithmCapability flags
+    BulkSortFunction bulkFunction; // nullptr if the algorithm only steps
+    SelectFunction selectFunction; // Selection algorithms only
 };
+
+/**
+ * Check whether an algorithm declares all of the given capability flags
+ */
+inline bool hasCapabilities(const AlgorithmInfo &algorithm, int required)
+{
+    return (algorithm.capabilities & required) == required;
+}
@@ -8,15 +8,41 @@ static std::vector<AlgorithmInfo> registeredAlgorithms;
  * Register a new sorting algorithm
  * Call this function to add your algorithm to the visualizer
  */
-void registerAlgorithm(const char *name, SortingFunction function, int stateSize)
+void registerAlgorithm(const char *name, SortingFunction function, int stateSize, int capabilities,
+                       BulkSortFunction bulkFunction)
 {
     AlgorithmInfo info;
     info.name = name;
     info.function = function;
     info.stateSize = stateSize;
+    info.stateType = StateType{nullptr, nullptr, nullptr};
+    info.capabilities = capabilities;
+    info.bulkFunction = bulkFunction;
+    info.selectFunction = nullptr;
     registeredAlgorithms.push_back(info);
 }
 
+/**
+ * Register an algorithm whose state is a typed, size-dependent block
+ */
+void registerAlgorithm(const char *name, SortingFunction function, const StateType &stateType,
+                       int capabilities, BulkSortFunction bulkFunction)
+{
+    registerAlgorithm(name, function, 0, capabilities, bulkFunction);
+    registeredAlgorithms.back().stateType = stateType;
+}
+
+/**
+ * Register a selection algorithm (ALGO_SELECTION is added to capabilities)
+ * Its step function selects k = selectionStepRank(size)
+ */
+void registerSelectionAlgorithm(const char *name, SortingFunction function, const StateType &stateType,
+                                int capabilities, SelectFunction selectFunction)
+{
+    registerAlgorithm(name, function, stateType, capabilities | ALGO_SELECTION, nullptr);
+    registeredAlgorithms.back().selectFunction = selectFunction;
+}
+
 /**
  * Get all registered algorithms
  */
@@ -25,6 +51,23 @@ std::vector<AlgorithmInfo> getRegisteredAlgorithms()
     return registeredAlgorithms;
 }
 
+/**
+ * Get all algorithms that declare every flag in required
+ * e.g. getAlgorithmsWithCapabilities(ALGO_STABLE) for multi-key pipelines
+ */
+std::vector<AlgorithmInfo *> getAlgorithmsWithCapabilities(int required)
+{
+    std::vector<AlgorithmInfo *> matches;
+    for (auto &algo : registeredAlgorithms)
+    {
+        if (hasCapabilities(algo, required))
+        {
+            matches.push_back(&algo);
+        }
+    }
+    return matches;
+}
+
 /**
  * Get algorithm by name
  */
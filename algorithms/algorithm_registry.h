@@ -7,8 +7,14 @@
  * These functions manage the list of available sorting algorithms
  */
 
-void registerAlgorithm(const char *name, SortingFunction function, int stateSize);
+void registerAlgorithm(const char *name, SortingFunction function, int stateSize, int capabilities = 0,
+                       BulkSortFunction bulkFunction = nullptr);
+void registerAlgorithm(const char *name, SortingFunction function, const StateType &stateType,
+                       int capabilities = 0, BulkSortFunction bulkFunction = nullptr);
+void registerSelectionAlgorithm(const char *name, SortingFunction function, const StateType &stateType,
+                                int capabilities, SelectFunction selectFunction);
 std::vector<AlgorithmInfo> getRegisteredAlgorithms();
+std::vector<AlgorithmInfo *> getAlgorithmsWithCapabilities(int required);
 AlgorithmInfo *getAlgorithmByName(const char *name);
 AlgorithmInfo *getAlgorithmByIndex(int index);
 int getAlgorithmCount();
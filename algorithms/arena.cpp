@@ -0,0 +1,177 @@
+#include "arena.h"
+#include <algorithm>
+#include <new>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+namespace
+{
+const size_t MIN_BLOCK_BYTES = static_cast<size_t>(64) * 1024;
+const size_t HUGE_PAGE_BYTES = static_cast<size_t>(2) * 1024 * 1024;
+
+size_t roundUp(size_t value, size_t multiple)
+{
+    return (value + multiple - 1) / multiple * multiple;
+}
+
+/**
+ * Page-aligned memory straight from the OS (so large blocks never fragment
+ * the heap); huge pages are a best-effort hint
+ */
+void *mapBlock(size_t bytes, bool hugePages)
+{
+#ifdef _WIN32
+    if (hugePages)
+    {
+        // Needs the "Lock pages in memory" privilege; fall back to normal pages without it
+        SIZE_T largePage = GetLargePageMinimum();
+        if (largePage > 0 && bytes % largePage == 0)
+        {
+            void *block = VirtualAlloc(nullptr, bytes, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+            if (block)
+                return block;
+        }
+    }
+    return VirtualAlloc(nullptr, bytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+#else
+    if (!hugePages)
+    {
+        void *block = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        return block == MAP_FAILED ? nullptr : block;
+    }
+
+    // Over-map and trim so the block starts on a huge page boundary
+    size_t mapped = bytes + HUGE_PAGE_BYTES;
+    void *raw = mmap(nullptr, mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED)
+        return nullptr;
+
+    char *start = static_cast<char *>(raw);
+    char *aligned = reinterpret_cast<char *>(roundUp(reinterpret_cast<size_t>(start), HUGE_PAGE_BYTES));
+    if (aligned > start)
+        munmap(start, aligned - start);
+    if (start + mapped > aligned + bytes)
+        munmap(aligned + bytes, start + mapped - (aligned + bytes));
+
+#ifdef MADV_HUGEPAGE
+    madvise(aligned, bytes, MADV_HUGEPAGE);
+#endif
+    return aligned;
+#endif
+}
+
+void unmapBlock(void *block, size_t bytes)
+{
+#ifdef _WIN32
+    (void)bytes;
+    VirtualFree(block, 0, MEM_RELEASE);
+#else
+    munmap(block, bytes);
+#endif
+}
+}
+
+Arena::Arena(size_t initialBytes, bool hugePages)
+    : current(nullptr), hugePages(hugePages)
+{
+    if (initialBytes > 0)
+    {
+        addBlock(initialBytes);
+    }
+}
+
+Arena::~Arena()
+{
+    releaseBlocks();
+}
+
+void *Arena::allocate(size_t bytes, size_t alignment)
+{
+    for (;;)
+    {
+        Block *block = current.load(std::memory_order_acquire);
+        if (block)
+        {
+            // Blocks are page aligned, so aligning the offset aligns the address
+            size_t used = block->used.load(std::memory_order_relaxed);
+            for (;;)
+            {
+                size_t start = roundUp(used, alignment);
+                if (start + bytes > block->size)
+                    break;
+                if (block->used.compare_exchange_weak(used, start + bytes, std::memory_order_relaxed))
+                    return block->base + start;
+            }
+        }
+
+        std::lock_guard<std::mutex> guard(growLock);
+        if (current.load(std::memory_order_acquire) == block)
+        {
+            addBlock(std::max(bytes + alignment, capacity()));
+        }
+    }
+}
+
+void Arena::reset()
+{
+    if (blocks.size() > 1)
+    {
+        // Grown during the run: keep one block big enough for the whole run next time
+        size_t total = capacity();
+        releaseBlocks();
+        addBlock(total);
+        return;
+    }
+
+    if (!blocks.empty())
+    {
+        blocks[0]->used.store(0, std::memory_order_relaxed);
+    }
+}
+
+size_t Arena::capacity() const
+{
+    size_t total = 0;
+    for (const std::unique_ptr<Block> &block : blocks)
+    {
+        total += block->size;
+    }
+    return total;
+}
+
+void Arena::addBlock(size_t minimumBytes)
+{
+    size_t bytes = roundUp(std::max(minimumBytes, MIN_BLOCK_BYTES), hugePages ? HUGE_PAGE_BYTES : 4096);
+    void *memory = mapBlock(bytes, hugePages);
+    if (!memory)
+        throw std::bad_alloc();
+
+    std::unique_ptr<Block> block(new Block());
+    block->base = static_cast<char *>(memory);
+    block->size = bytes;
+    block->used.store(0, std::memory_order_relaxed);
+
+    blocks.push_back(std::move(block));
+    current.store(blocks.back().get(), std::memory_order_release);
+}
+
+void Arena::releaseBlocks()
+{
+    for (const std::unique_ptr<Block> &block : blocks)
+    {
+        unmapBlock(block->base, block->size);
+    }
+    blocks.clear();
+    current.store(nullptr, std::memory_order_release);
+}
+
+Arena &threadScratchArena()
+{
+    thread_local Arena arena;
+    return arena;
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+/**
+ * Bump allocator for the scratch memory of one sorting run
+ *
+ * Algorithms take merge buffers, ping-pong buffers, histograms and stacks from
+ * the arena instead of the heap; nothing is freed individually. reset() makes
+ * all of it available again for the next run. When a run needed more than one
+ * block, reset() replaces them with a single block of their combined size, so
+ * after the first run of a given size a reset is O(1) and runs allocate
+ * nothing from the system.
+ *
+ * allocate() is safe to call from several threads at once (parallel engines);
+ * reset() must only be called when no run is using the arena.
+ */
+class Arena
+{
+public:
+    /**
+     * @param initialBytes: Size of the first block (0 waits for the first allocation)
+     * @param hugePages: Back blocks with huge pages where the OS supports it
+     */
+    explicit Arena(size_t initialBytes = 0, bool hugePages = false);
+    ~Arena();
+
+    /**
+     * Uninitialised memory, aligned to alignment (a power of two up to 4096)
+     */
+    void *allocate(size_t bytes, size_t alignment = 64);
+
+    template <typename T>
+    T *allocateArray(size_t count)
+    {
+        static_assert(std::is_trivially_destructible<T>::value, "arena memory is never destroyed");
+        return static_cast<T *>(allocate(count * sizeof(T), alignof(T) > 64 ? alignof(T) : 64));
+    }
+
+    void reset();
+
+    size_t capacity() const;
+    size_t blockCount() const { return blocks.size(); }
+
+private:
+    struct Block
+    {
+        char *base;
+        size_t size;
+        std::atomic<size_t> used;
+    };
+
+    std::vector<std::unique_ptr<Block>> blocks;
+    std::atomic<Block *> current;
+    std::mutex growLock;
+    bool hugePages;
+
+    void addBlock(size_t minimumBytes);
+    void releaseBlocks();
+
+    Arena(const Arena &) = delete;
+    Arena &operator=(const Arena &) = delete;
+};
+
+/**
+ * An arena owned by the calling thread, for callers that do not manage one
+ */
+Arena &threadScratchArena();
@@ -0,0 +1,433 @@
+#include "auto_sort.h"
+#include "algorithm_registry.h"
+#include "arena.h"
+#include "input_generator.h"
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+
+namespace
+{
+// Size classes 2^6, 2^8, ... 2^24; an input uses the largest class not above its size
+const int MIN_CLASS_LOG = 6;
+const int CLASS_STEP = 2;
+const int SIZE_CLASSES = 10;
+
+const int PROBE_SAMPLES = 512;
+
+// Shape boundaries (structural, not machine dependent)
+const int NEARLY_SORTED_RUN_DIVISOR = 16;    // At most size/16 runs
+const double NEARLY_SORTED_INVERSIONS = 0.05;
+const double FEW_DISTINCT_RATIO = 0.25;      // Sample is 75% repeats
+const long long SMALL_RANGE_FACTOR = 4;      // range < 4 * size
+
+const char *const SHAPE_NAMES[SHAPE_COUNT] = {"random", "nearly-sorted", "few-distinct", "small-range"};
+
+std::mutex tableLock;
+std::string chosen[SHAPE_COUNT][SIZE_CLASSES];
+bool tableLoaded = false;
+
+int sizeClassOf(int size)
+{
+    int log2Size = 0;
+    while ((2LL << log2Size) <= size)
+        log2Size++;
+    return std::max(0, std::min(SIZE_CLASSES - 1, (log2Size - MIN_CLASS_LOG) / CLASS_STEP));
+}
+
+void setDefaults()
+{
+    for (int c = 0; c < SIZE_CLASSES; c++)
+    {
+        int log2Size = MIN_CLASS_LOG + c * CLASS_STEP;
+        chosen[SHAPE_RANDOM][c] = log2Size <= 8 ? "Quick Sort" : log2Size <= 20 ? "Radix Sort" : "Sample Sort";
+        chosen[SHAPE_NEARLY_SORTED][c] = "Quick Sort";
+        chosen[SHAPE_FEW_DISTINCT][c] = log2Size <= 6 ? "Quick Sort" : "Bucket Sort";
+        chosen[SHAPE_SMALL_RANGE][c] = "Counting Sort";
+    }
+}
+
+/**
+ * Read a cache file into the table (tableLock held)
+ * A missing file is not an error when optional is set
+ */
+bool readCache(const std::string &path, bool optional, std::string &error)
+{
+    FILE *file = std::fopen(path.c_str(), "r");
+    if (!file)
+    {
+        error = "cannot open " + path;
+        return optional;
+    }
+
+    char line[256];
+    int lineNumber = 0;
+    bool ok = true;
+    while (std::fgets(line, sizeof(line), file))
+    {
+        lineNumber++;
+        if (line[0] == '#' || line[0] == '\n')
+            continue;
+
+        // shape<TAB>size<TAB>algorithm name
+        char *sizeField = std::strchr(line, '\t');
+        char *nameField = sizeField ? std::strchr(sizeField + 1, '\t') : nullptr;
+        if (!nameField)
+        {
+            error = path + ":" + std::to_string(lineNumber) + ": expected shape, size and algorithm";
+            ok = false;
+            continue;
+        }
+        *sizeField++ = '\0';
+        *nameField++ = '\0';
+        nameField[std::strcspn(nameField, "\r\n")] = '\0';
+
+        int shape = 0;
+        while (shape < SHAPE_COUNT && std::strcmp(SHAPE_NAMES[shape], line) != 0)
+            shape++;
+        if (shape == SHAPE_COUNT)
+        {
+            error = path + ":" + std::to_string(lineNumber) + ": unknown shape " + line;
+            ok = false;
+            continue;
+        }
+
+        chosen[shape][sizeClassOf(std::atoi(sizeField))] = nameField;
+    }
+
+    std::fclose(file);
+    return ok;
+}
+
+/**
+ * Fill the table on first use: defaults, overridden by the cache file if there
+ * is one (tableLock held)
+ */
+void ensureTable()
+{
+    if (tableLoaded)
+        return;
+
+    setDefaults();
+    tableLoaded = true;
+
+    std::string error;
+    if (!readCache(defaultAutoSortCachePath(), true, error))
+        std::fprintf(stderr, "Auto sort: %s\n", error.c_str());
+}
+
+bool isCandidate(const AlgorithmInfo &algorithm)
+{
+    // Auto only delegates to engines with a fast path and snapshot-safe state
+    return algorithm.bulkFunction && algorithm.bulkFunction != autoSortAll && !algorithm.stateType.destroy;
+}
+
+/**
+ * Synthetic inputs for calibration, one fixed seed per shape
+ */
+void generate(InputShape shape, std::vector<int> &values)
+{
+    int size = static_cast<int>(values.size());
+    InputSpec spec;
+    spec.seed = 20240 + static_cast<uint64_t>(shape);
+    switch (shape)
+    {
+    case SHAPE_RANDOM:
+        spec.distribution = DIST_UNIFORM;
+        spec.range = INT_MAX;
+        break;
+
+    case SHAPE_NEARLY_SORTED:
+        spec.distribution = DIST_SORTED_SWAPS;
+        break;
+
+    case SHAPE_FEW_DISTINCT:
+        spec.distribution = DIST_DUPLICATE_HEAVY;
+        spec.distinct = 16;
+        break;
+
+    default:
+        spec.distribution = DIST_UNIFORM;
+        spec.range = size / 2 + 1;
+        break;
+    }
+    generateInput(spec, values.data(), size);
+}
+}
+
+InputProfile probeInput(const int array[], int size)
+{
+    InputProfile profile = {size, size > 0 ? 1 : 0, size > 1, 0.0, 1.0, 0};
+    if (size < 2)
+        return profile;
+
+    // One pass: run boundaries and range
+    int minValue = array[0];
+    int maxValue = array[0];
+    int descents = 0;
+    for (int i = 1; i < size; i++)
+    {
+        descents += array[i] < array[i - 1];
+        minValue = std::min(minValue, array[i]);
+        maxValue = std::max(maxValue, array[i]);
+    }
+    profile.runs = descents + 1;
+    profile.strictlyDescending = descents == size - 1;
+    profile.range = static_cast<long long>(maxValue) - minValue;
+
+    // Random pairs for inversions, random elements for duplicates
+    uint64_t seed = 0x9E3779B97F4A7C15ULL ^ static_cast<uint64_t>(size);
+    auto next = [&seed, size]() {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        return static_cast<int>((seed >> 33) % static_cast<uint64_t>(size));
+    };
+
+    int samples = std::min(size, PROBE_SAMPLES);
+    int inversions = 0;
+    int sample[PROBE_SAMPLES];
+    for (int s = 0; s < samples; s++)
+    {
+        int i = next();
+        int j = next();
+        if (i > j)
+            std::swap(i, j);
+        inversions += array[i] > array[j];
+        sample[s] = array[i];
+    }
+    std::sort(sample, sample + samples);
+
+    profile.inversionRatio = static_cast<double>(inversions) / samples;
+    profile.distinctRatio = static_cast<double>(std::unique(sample, sample + samples) - sample) / samples;
+    return profile;
+}
+
+InputShape classifyInput(const InputProfile &profile)
+{
+    if (profile.runs <= std::max(1, profile.size / NEARLY_SORTED_RUN_DIVISOR) ||
+        profile.inversionRatio < NEARLY_SORTED_INVERSIONS)
+        return SHAPE_NEARLY_SORTED;
+    if (profile.range < SMALL_RANGE_FACTOR * profile.size)
+        return SHAPE_SMALL_RANGE;
+    if (profile.distinctRatio < FEW_DISTINCT_RATIO)
+        return SHAPE_FEW_DISTINCT;
+    return SHAPE_RANDOM;
+}
+
+const char *inputShapeName(InputShape shape)
+{
+    return shape >= 0 && shape < SHAPE_COUNT ? SHAPE_NAMES[shape] : "?";
+}
+
+const AlgorithmInfo *chooseAlgorithm(const InputProfile &profile)
+{
+    std::string name;
+    {
+        std::lock_guard<std::mutex> guard(tableLock);
+        ensureTable();
+        name = chosen[classifyInput(profile)][sizeClassOf(profile.size)];
+    }
+
+    const AlgorithmInfo *algorithm = getAlgorithmByName(name.c_str());
+    if (algorithm && isCandidate(*algorithm))
+        return algorithm;
+
+    // The table names an engine that is not registered: any candidate will do
+    for (int i = 0; i < getAlgorithmCount(); i++)
+    {
+        if (isCandidate(*getAlgorithmByIndex(i)))
+            return getAlgorithmByIndex(i);
+    }
+    return nullptr;
+}
+
+std::vector<CalibrationResult> calibrateAutoSort(int maxSize)
+{
+    std::vector<CalibrationResult> results;
+    Arena scratch;
+
+    std::lock_guard<std::mutex> guard(tableLock);
+    ensureTable();
+
+    for (int c = 0; c < SIZE_CLASSES; c++)
+    {
+        int size = 1 << (MIN_CLASS_LOG + c * CLASS_STEP);
+        if (size > maxSize)
+        {
+            // Too big to time here: inherit the largest calibrated class
+            for (int shape = 0; shape < SHAPE_COUNT && c > 0; shape++)
+                chosen[shape][c] = chosen[shape][c - 1];
+            continue;
+        }
+
+        std::vector<int> input(size);
+        std::vector<int> work(size);
+        int repeats = std::max(3, std::min(50, (1 << 20) / size));
+
+        for (int shape = 0; shape < SHAPE_COUNT; shape++)
+        {
+            generate(static_cast<InputShape>(shape), input);
+            double bestSeconds = 0.0;
+
+            for (int i = 0; i < getAlgorithmCount(); i++)
+            {
+                const AlgorithmInfo *algorithm = getAlgorithmByIndex(i);
+                if (!isCandidate(*algorithm))
+                    continue;
+
+                double seconds = 1e30;
+                for (int r = 0; r < repeats; r++)
+                {
+                    std::copy(input.begin(), input.end(), work.begin());
+                    scratch.reset();
+                    auto start = std::chrono::steady_clock::now();
+                    algorithm->bulkFunction(work.data(), size, scratch);
+                    seconds = std::min(seconds, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+                }
+
+                results.push_back({static_cast<InputShape>(shape), size, algorithm, seconds});
+                if (bestSeconds == 0.0 || seconds < bestSeconds)
+                {
+                    bestSeconds = seconds;
+                    chosen[shape][c] = algorithm->name;
+                }
+            }
+        }
+    }
+    return results;
+}
+
+bool loadAutoSortCache(const std::string &path, std::string &error)
+{
+    std::lock_guard<std::mutex> guard(tableLock);
+    ensureTable();
+    return readCache(path, false, error);
+}
+
+bool saveAutoSortCache(const std::string &path, std::string &error)
+{
+    FILE *file = std::fopen(path.c_str(), "w");
+    if (!file)
+    {
+        error = "cannot write " + path;
+        return false;
+    }
+
+    std::lock_guard<std::mutex> guard(tableLock);
+    ensureTable();
+
+    std::fprintf(file, "# Auto sort choices: shape<TAB>size<TAB>algorithm (written by sortbench)\n");
+    for (int shape = 0; shape < SHAPE_COUNT; shape++)
+    {
+        for (int c = 0; c < SIZE_CLASSES; c++)
+        {
+            std::fprintf(file, "%s\t%d\t%s\n", SHAPE_NAMES[shape], 1 << (MIN_CLASS_LOG + c * CLASS_STEP),
+                         chosen[shape][c].c_str());
+        }
+    }
+
+    bool ok = std::fclose(file) == 0;
+    if (!ok)
+        error = "cannot write " + path;
+    return ok;
+}
+
+std::string defaultAutoSortCachePath()
+{
+    const char *path = std::getenv("SORT_AUTOTUNE_CACHE");
+    return path && *path ? path : "autotune.cache";
+}
+
+/**
+ * Auto Sort (visualization)
+ * The first step probes the array and picks an algorithm; every later step is
+ * that algorithm's step
+ *
+ * State (AutoSortState, then the chosen algorithm's own state at INNER_OFFSET):
+ * chosenIndex = registry index of the chosen algorithm (-1 before the first step)
+ */
+struct AutoSortState
+{
+    int chosenIndex;
+};
+
+static const size_t INNER_OFFSET = 64;
+
+static size_t innerStateBytes(const AlgorithmInfo &algorithm, int size)
+{
+    return algorithm.stateType.bytesFor ? algorithm.stateType.bytesFor(size)
+                                        : static_cast<size_t>(std::max(algorithm.stateSize, 1)) * sizeof(int);
+}
+
+static size_t autoSortStateBytes(int size)
+{
+    // Room for whichever candidate gets chosen
+    size_t largest = 0;
+    for (int i = 0; i < getAlgorithmCount(); i++)
+    {
+        const AlgorithmInfo &algorithm = *getAlgorithmByIndex(i);
+        if (isCandidate(algorithm))
+            largest = std::max(largest, innerStateBytes(algorithm, size));
+    }
+    return INNER_OFFSET + largest;
+}
+
+static void autoSortStateInit(void *state, int)
+{
+    static_cast<AutoSortState *>(state)->chosenIndex = -1;
+}
+
+extern const StateType autoSortState = {autoSortStateBytes, autoSortStateInit, nullptr};
+
+SwapResult autoSort(int array[], int size, int *state)
+{
+    AutoSortState &s = typedState<AutoSortState>(state);
+    int *inner = reinterpret_cast<int *>(reinterpret_cast<char *>(state) + INNER_OFFSET);
+
+    if (s.chosenIndex < 0)
+    {
+        const AlgorithmInfo *algorithm = chooseAlgorithm(probeInput(array, size));
+        if (!algorithm)
+        {
+            SwapResult done = {-1, -1, false, true};
+            return done;
+        }
+
+        for (int i = 0; i < getAlgorithmCount(); i++)
+        {
+            if (getAlgorithmByIndex(i) == algorithm)
+                s.chosenIndex = i;
+        }
+        if (algorithm->stateType.init)
+            algorithm->stateType.init(inner, size);
+
+        SwapResult probed = {-1, -1, false, false};
+        return probed;
+    }
+
+    return getAlgorithmByIndex(s.chosenIndex)->function(array, size, inner);
+}
+
+/**
+ * Auto Sort - whole array in one call
+ */
+void autoSortAll(int array[], int size, Arena &scratch)
+{
+    InputProfile profile = probeInput(array, size);
+    if (profile.runs <= 1)
+        return;
+
+    if (profile.strictlyDescending)
+    {
+        std::reverse(array, array + size);
+        return;
+    }
+
+    const AlgorithmInfo *algorithm = chooseAlgorithm(profile);
+    if (algorithm)
+        algorithm->bulkFunction(array, size, scratch);
+}
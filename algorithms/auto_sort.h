@@ -0,0 +1,74 @@
+#pragma once
+#include "algorithm_interface.h"
+#include <string>
+#include <vector>
+
+/**
+ * "Auto" engine: look at the input, then hand it to the registered algorithm
+ * that sorts that kind of input fastest on this machine
+ *
+ * probeInput() measures the input in one pass plus a small random sample.
+ * The profile is reduced to a shape and a size class, and the winner for that
+ * cell comes from a table filled in by calibrateAutoSort() (the benchmark
+ * suite, see sortbench) and kept in a cache file. Without a cache the
+ * built-in defaults are used.
+ */
+
+enum InputShape
+{
+    SHAPE_RANDOM,
+    SHAPE_NEARLY_SORTED, // Few runs or few inversions
+    SHAPE_FEW_DISTINCT,  // Many duplicates over a wide range
+    SHAPE_SMALL_RANGE,   // Keys packed into a range not much bigger than the size
+    SHAPE_COUNT
+};
+
+struct InputProfile
+{
+    int size;
+    int runs;               // Maximal non-descending runs (1 = already sorted)
+    bool strictlyDescending;
+    double inversionRatio;  // Estimated fraction of pairs out of order
+    double distinctRatio;   // Distinct values in a random sample / sample size
+    long long range;        // max - min
+};
+
+InputProfile probeInput(const int array[], int size);
+InputShape classifyInput(const InputProfile &profile);
+const char *inputShapeName(InputShape shape);
+
+/**
+ * Algorithm the table picks for this profile (never "Auto" itself)
+ */
+const AlgorithmInfo *chooseAlgorithm(const InputProfile &profile);
+
+/**
+ * One timed cell of the calibration grid
+ */
+struct CalibrationResult
+{
+    InputShape shape;
+    int size;
+    const AlgorithmInfo *algorithm;
+    double seconds; // Best of a few runs
+};
+
+/**
+ * Time every bulk-capable algorithm on every shape at sizes up to maxSize and
+ * make the fastest of each cell the choice for it
+ * @return: Every timing taken, for reporting
+ */
+std::vector<CalibrationResult> calibrateAutoSort(int maxSize);
+
+/**
+ * Cache file with one "shape<TAB>size<TAB>algorithm" line per cell
+ * loadAutoSortCache() is called automatically on first use, with the path
+ * from $SORT_AUTOTUNE_CACHE or "autotune.cache"
+ */
+bool loadAutoSortCache(const std::string &path, std::string &error);
+bool saveAutoSortCache(const std::string &path, std::string &error);
+std::string defaultAutoSortCachePath();
+
+extern const StateType autoSortState;
+SwapResult autoSort(int array[], int size, int *state);
+void autoSortAll(int array[], int size, Arena &scratch);
@@ -0,0 +1,111 @@
+#include "algorithm_interface.h"
+#include "algorithm_registry.h"
+#include "arena.h"
+#include "counting_sort.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+/**
+ * Bucket Sort (visualization)
+ * One bucket per element, chosen by scaling value - min to the bucket count;
+ * the histogram gives each bucket its slot, and an insertion pass sorts
+ * within buckets. See distributionSortStep in counting_sort.cpp.
+ */
+extern const StateType bucketSortState = {distributionSortStateBytes, nullptr, nullptr};
+
+SwapResult bucketSort(int array[], int size, int *state)
+{
+    return distributionSortStep(array, size, state, false);
+}
+
+// Average elements per bucket for the whole-array path
+static const int BUCKET_LOAD = 4;
+// Buckets up to this size are insertion sorted
+static const int INSERTION_LIMIT = 32;
+// Buckets per parallel task
+static const long long PARALLEL_GRAIN = 1 << 12;
+
+static void sortBucket(int *first, int *last)
+{
+    if (last - first > INSERTION_LIMIT)
+    {
+        // Skewed data piled into one bucket
+        std::sort(first, last);
+        return;
+    }
+
+    for (int *i = first + 1; i < last; i++)
+    {
+        int value = *i;
+        int *j = i;
+        while (j > first && *(j - 1) > value)
+        {
+            *j = *(j - 1);
+            j--;
+        }
+        *j = value;
+    }
+}
+
+/**
+ * Bucket Sort - whole array in one call
+ * Histogram pass, scatter into a buffer by bucket, then every bucket is sorted
+ * on its own (in parallel for large arrays) and the buffer copied back. Small
+ * ranges go straight to counting sort.
+ */
+void bucketSortAll(int array[], int size, Arena &scratch)
+{
+    if (size < 2)
+        return;
+
+    auto bounds = std::minmax_element(array, array + size);
+    int minValue = *bounds.first;
+    long long range = static_cast<long long>(*bounds.second) - minValue;
+    if (countingSortFits(size, range))
+    {
+        countingSortRange(array, size, minValue, *bounds.second, scratch);
+        return;
+    }
+
+    int buckets = std::max(1, size / BUCKET_LOAD);
+    uint64_t scale = (static_cast<uint64_t>(buckets) << 32) / static_cast<uint64_t>(range + 1);
+    auto bucketOf = [minValue, scale](int value) {
+        uint64_t offset = static_cast<uint32_t>(static_cast<unsigned>(value) - static_cast<unsigned>(minValue));
+        return static_cast<int>((offset * scale) >> 32);
+    };
+
+    int *starts = scratch.allocateArray<int>(static_cast<size_t>(buckets) + 1);
+    int *next = scratch.allocateArray<int>(buckets);
+    int *buffer = scratch.allocateArray<int>(size);
+    std::memset(next, 0, static_cast<size_t>(buckets) * sizeof(int));
+
+    for (int i = 0; i < size; i++)
+    {
+        next[bucketOf(array[i])]++;
+    }
+
+    int offset = 0;
+    for (int b = 0; b < buckets; b++)
+    {
+        starts[b] = offset;
+        offset += next[b];
+        next[b] = starts[b];
+    }
+    starts[buckets] = size;
+
+    for (int i = 0; i < size; i++)
+    {
+        buffer[next[bucketOf(array[i])]++] = array[i];
+    }
+
+    parallelFor(0, buckets, PARALLEL_GRAIN, [starts, buffer](long long first, long long last) {
+        for (long long b = first; b < last; b++)
+        {
+            sortBucket(buffer + starts[b], buffer + starts[b + 1]);
+        }
+    });
+
+    std::copy(buffer, buffer + size, array);
+}
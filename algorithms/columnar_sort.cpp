@@ -0,0 +1,243 @@
+#include "columnar_sort.h"
+#include "radix_keys.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <cstring>
+
+// Buckets this small are finished by insertion sort
+static const size_t INSERTION_SORT_MAX = 16;
+// Batches larger than this encode and sort on the thread pool
+static const size_t PARALLEL_ABOVE = 1 << 16;
+static const long long ENCODE_GRAIN = 1 << 14;
+// Row index appended to every encoded row
+static const size_t ROW_BYTES = 4;
+
+namespace
+{
+/**
+ * Where one key's bytes go in the encoded row, and how to make them
+ */
+struct KeyLayout
+{
+    const Column *column;
+    size_t offset;
+    size_t valueBytes;
+    bool nullable;
+    bool descending;
+    bool nullsFirst;
+};
+
+bool isValid(const uint8_t *validity, size_t row)
+{
+    return !validity || (validity[row / 8] >> (row % 8)) & 1;
+}
+
+void storeBigEndian(uint8_t *out, uint64_t value, size_t bytes)
+{
+    for (size_t i = 0; i < bytes; i++)
+    {
+        out[i] = static_cast<uint8_t>(value >> (8 * (bytes - 1 - i)));
+    }
+}
+
+/**
+ * The row's bytes for one key: compare as unsigned bytes, in key order
+ */
+void encodeKey(const KeyLayout &key, size_t row, uint8_t *out)
+{
+    bool valid = isValid(key.column->validity, row);
+    if (key.nullable)
+    {
+        *out++ = static_cast<uint8_t>(valid == key.nullsFirst);
+    }
+    if (!valid)
+    {
+        std::memset(out, 0, key.valueBytes);
+        return;
+    }
+
+    uint64_t bits;
+    if (key.column->type == COLUMN_INT32)
+        bits = static_cast<uint32_t>(static_cast<const int32_t *>(key.column->values)[row]) ^ 0x80000000u;
+    else
+        bits = static_cast<uint64_t>(static_cast<const int64_t *>(key.column->values)[row]) ^ 0x8000000000000000ULL;
+    if (key.descending)
+        bits = ~bits;
+    storeBigEndian(out, bits, key.valueBytes);
+}
+
+void encodeRow(const std::vector<KeyLayout> &layout, size_t keyBytes, size_t row, uint8_t *out)
+{
+    for (const KeyLayout &key : layout)
+    {
+        encodeKey(key, row, out + key.offset);
+    }
+    storeBigEndian(out + keyBytes, row, ROW_BYTES);
+}
+
+/**
+ * Insertion sort of count rows of width bytes, which agree before byte from
+ */
+void insertionSortRows(uint8_t *rows, size_t count, size_t width, size_t from)
+{
+    for (size_t i = 1; i < count; i++)
+    {
+        for (size_t j = i; j > 0; j--)
+        {
+            uint8_t *right = rows + j * width;
+            uint8_t *left = right - width;
+            if (std::memcmp(left + from, right + from, width - from) <= 0)
+                break;
+            std::swap_ranges(left, right, right);
+        }
+    }
+}
+
+/**
+ * MSD radix sort of count rows of width bytes, which agree before byte
+ * Rows are distinct (they end in the row index), so a bucket always splits
+ * before the bytes run out
+ */
+void msdRadixSortRows(uint8_t *rows, uint8_t *buffer, size_t count, size_t width, size_t byte, bool parallel)
+{
+    size_t offsets[256];
+    for (;;)
+    {
+        if (count <= INSERTION_SORT_MAX)
+        {
+            insertionSortRows(rows, count, width, byte);
+            return;
+        }
+
+        std::fill(offsets, offsets + 256, 0);
+        for (size_t i = 0; i < count; i++)
+        {
+            offsets[rows[i * width + byte]]++;
+        }
+        // Every row has the same byte here: nothing to distribute
+        if (offsets[rows[byte]] != count)
+            break;
+        byte++;
+    }
+
+    size_t starts[257];
+    size_t offset = 0;
+    for (int bucket = 0; bucket < 256; bucket++)
+    {
+        starts[bucket] = offset;
+        offset += offsets[bucket];
+        offsets[bucket] = starts[bucket];
+    }
+    starts[256] = count;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        const uint8_t *row = rows + i * width;
+        std::memcpy(buffer + offsets[row[byte]]++ * width, row, width);
+    }
+    std::memcpy(rows, buffer, count * width);
+
+    auto sortBuckets = [=, &starts](long long first, long long last) {
+        for (long long bucket = first; bucket < last; bucket++)
+        {
+            size_t begin = starts[bucket];
+            size_t size = starts[bucket + 1] - begin;
+            if (size > 1)
+                msdRadixSortRows(rows + begin * width, buffer + begin * width, size, width, byte + 1, false);
+        }
+    };
+    if (parallel)
+        parallelFor(0, 256, 1, sortBuckets);
+    else
+        sortBuckets(0, 256);
+}
+} // namespace
+
+bool sortColumnar(const RecordBatch &batch, const SortKey keys[], int keyCount, std::vector<uint32_t> &order,
+                  Arena &scratch, std::string &error)
+{
+    size_t rowCount = batch.rowCount;
+    if (rowCount > 0xFFFFFFFFULL)
+    {
+        error = "a batch holds at most 2^32 rows";
+        return false;
+    }
+
+    std::vector<KeyLayout> layout;
+    size_t keyBytes = 0;
+    for (int k = 0; k < keyCount; k++)
+    {
+        if (keys[k].column < 0 || keys[k].column >= static_cast<int>(batch.columns.size()))
+        {
+            error = "sort key " + std::to_string(k) + " names column " + std::to_string(keys[k].column) +
+                    ", the batch has " + std::to_string(batch.columns.size());
+            return false;
+        }
+        const Column &column = batch.columns[keys[k].column];
+        KeyLayout key = {&column, keyBytes, column.type == COLUMN_INT32 ? 4u : 8u, column.validity != nullptr,
+                         keys[k].descending, keys[k].nullsFirst};
+        layout.push_back(key);
+        keyBytes += key.nullable + key.valueBytes;
+    }
+
+    order.resize(rowCount);
+    if (keyBytes == 0)
+    {
+        for (size_t i = 0; i < rowCount; i++)
+            order[i] = static_cast<uint32_t>(i);
+        return true;
+    }
+
+    size_t width = keyBytes + ROW_BYTES;
+    bool parallel = rowCount > PARALLEL_ABOVE;
+
+    // Short keys: key bytes and row index packed into one 64-bit radix key
+    if (width <= 8)
+    {
+        uint64_t *packed = scratch.allocateArray<uint64_t>(rowCount);
+        auto encode = [&](long long first, long long last) {
+            uint8_t row[8] = {};
+            for (long long i = first; i < last; i++)
+            {
+                encodeRow(layout, keyBytes, i, row);
+                uint64_t value = 0;
+                for (int b = 0; b < 8; b++)
+                    value = value << 8 | row[b];
+                packed[i] = value;
+            }
+        };
+        if (parallel)
+            parallelFor(0, rowCount, ENCODE_GRAIN, encode);
+        else
+            encode(0, rowCount);
+
+        radixSortKeys64(packed, rowCount);
+        for (size_t i = 0; i < rowCount; i++)
+        {
+            order[i] = static_cast<uint32_t>(packed[i] >> (8 * (8 - width)));
+        }
+        return true;
+    }
+
+    uint8_t *rows = scratch.allocateArray<uint8_t>(rowCount * width);
+    uint8_t *buffer = scratch.allocateArray<uint8_t>(rowCount * width);
+    auto encode = [&](long long first, long long last) {
+        for (long long i = first; i < last; i++)
+        {
+            encodeRow(layout, keyBytes, i, rows + i * width);
+        }
+    };
+    if (parallel)
+        parallelFor(0, rowCount, ENCODE_GRAIN, encode);
+    else
+        encode(0, rowCount);
+
+    if (rowCount > 1)
+        msdRadixSortRows(rows, buffer, rowCount, width, 0, parallel);
+    for (size_t i = 0; i < rowCount; i++)
+    {
+        const uint8_t *row = rows + i * width + keyBytes;
+        order[i] = static_cast<uint32_t>(row[0]) << 24 | row[1] << 16 | row[2] << 8 | row[3];
+    }
+    return true;
+}
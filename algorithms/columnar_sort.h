@@ -0,0 +1,60 @@
+#pragma once
+#include "arena.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * ORDER BY over record batches stored column by column (Arrow style), without
+ * turning rows into objects
+ */
+enum ColumnType
+{
+    COLUMN_INT32,
+    COLUMN_INT64
+};
+
+/**
+ * One column: rowCount values of its type, plus an optional validity bitmap
+ * (bit i % 8 of byte i / 8 set if row i holds a value; nullptr: no nulls)
+ */
+struct Column
+{
+    ColumnType type;
+    const void *values;
+    const uint8_t *validity;
+};
+
+struct RecordBatch
+{
+    std::vector<Column> columns;
+    size_t rowCount;
+};
+
+struct SortKey
+{
+    int column; // Index into the batch's columns
+    bool descending;
+    bool nullsFirst; // Where nulls go, whatever the direction
+};
+
+/**
+ * Rows of batch in the order of keys (first key first), as row indices
+ *
+ * Every row is first encoded as one fixed-width byte string that compares, as
+ * plain bytes, in the order the keys ask for: per key a null byte (only for
+ * columns with a validity bitmap) and the value big-endian with its sign bit
+ * flipped, all inverted for descending keys; then the row index, so equal
+ * keys keep their input order. One sort over these strings handles every key
+ * at once: when the keys fit in 4 bytes they are packed into 64-bit integers
+ * for radixSortKeys64, otherwise an MSD radix sort moves the whole strings,
+ * skipping bytes every row shares and finishing small buckets by insertion.
+ * Large batches encode and sort the top-level buckets on the thread pool.
+ *
+ * @param scratch: Supplies the encoded rows (about rowCount * (key bytes + 4) * 2 bytes)
+ * @return: false, with error set, for a key naming a missing column or a batch
+ *          of more than 2^32 rows
+ */
+bool sortColumnar(const RecordBatch &batch, const SortKey keys[], int keyCount, std::vector<uint32_t> &order,
+                  Arena &scratch, std::string &error);
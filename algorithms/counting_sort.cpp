@@ -0,0 +1,205 @@
+#include "counting_sort.h"
+#include "algorithm_registry.h"
+#include "arena.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+// A count table may be up to this many times the element count...
+static const long long COUNTING_RANGE_FACTOR = 2;
+// ...and is always allowed this many entries (fits in L1/L2)
+static const long long COUNTING_MIN_TABLE = 1 << 12;
+
+// The step version's table: exact counting up to this many keys per element
+static const int STEP_TABLE_FACTOR = 4;
+
+bool countingSortFits(int size, long long range)
+{
+    return range + 1 <= std::max(COUNTING_MIN_TABLE, COUNTING_RANGE_FACTOR * size);
+}
+
+void countingSortRange(int array[], int size, int minValue, int maxValue, Arena &scratch)
+{
+    size_t entries = static_cast<size_t>(static_cast<long long>(maxValue) - minValue) + 1;
+    int *counts = scratch.allocateArray<int>(entries);
+    std::memset(counts, 0, entries * sizeof(int));
+
+    for (int i = 0; i < size; i++)
+    {
+        counts[static_cast<unsigned>(array[i]) - static_cast<unsigned>(minValue)]++;
+    }
+
+    int *out = array;
+    for (size_t key = 0; key < entries; key++)
+    {
+        int value = static_cast<int>(static_cast<unsigned>(minValue) + static_cast<unsigned>(key));
+        for (int c = counts[key]; c > 0; c--)
+        {
+            *out++ = value;
+        }
+    }
+}
+
+/**
+ * Counting/Bucket Sort (visualization)
+ *
+ * State (DistributionSortState, then the count table, then size ints of buffer):
+ * phase = 0=find min/max, 1=count, 2=copy back, 3=insertion pass, 4=done
+ * index = element being counted / copied, insertion: element being inserted
+ * insertPos = insertion: its current position
+ * buckets = keys in use; exact = key is value - min (no insertion pass needed)
+ * scale = 32.32 fixed-point factor from value - min to a bucket
+ */
+struct DistributionSortState
+{
+    int phase;
+    int index;
+    int insertPos;
+    int minValue;
+    int buckets;
+    int exact;
+    uint64_t scale;
+};
+
+static int stepTableSize(int size)
+{
+    return std::max(size, 1) * STEP_TABLE_FACTOR;
+}
+
+size_t distributionSortStateBytes(int size)
+{
+    return sizeof(DistributionSortState) + (static_cast<size_t>(stepTableSize(size)) + size) * sizeof(int);
+}
+
+static int distributionKey(const DistributionSortState &s, int value)
+{
+    uint64_t offset = static_cast<uint32_t>(static_cast<unsigned>(value) - static_cast<unsigned>(s.minValue));
+    return s.exact ? static_cast<int>(offset) : static_cast<int>((offset * s.scale) >> 32);
+}
+
+SwapResult distributionSortStep(int array[], int size, int *state, bool exactKeys)
+{
+    DistributionSortState &s = typedState<DistributionSortState>(state);
+    int *counts = reinterpret_cast<int *>(&s + 1);
+    int *buffer = counts + stepTableSize(size);
+
+    SwapResult result = {-1, -1, false, false};
+
+    switch (s.phase)
+    {
+    case 0: // Find the range and pick the keys
+        {
+            if (size < 2)
+            {
+                s.phase = 4;
+                result.isComplete = true;
+                return result;
+            }
+
+            int minValue = *std::min_element(array, array + size);
+            int maxValue = *std::max_element(array, array + size);
+            long long range = static_cast<long long>(maxValue) - minValue;
+
+            s.minValue = minValue;
+            s.exact = exactKeys && range < stepTableSize(size);
+            s.buckets = s.exact ? static_cast<int>(range + 1) : size;
+            s.scale = (static_cast<uint64_t>(s.buckets) << 32) / static_cast<uint64_t>(range + 1);
+            s.phase = 1;
+            return result;
+        }
+
+    case 1: // Count one element
+        if (s.index < size)
+        {
+            counts[distributionKey(s, array[s.index])]++;
+            result.index1 = s.index;
+            s.index++;
+            return result;
+        }
+
+        // All counted: turn counts into bucket starts and scatter, keeping arrival order
+        {
+            int offset = 0;
+            for (int b = 0; b < s.buckets; b++)
+            {
+                int count = counts[b];
+                counts[b] = offset;
+                offset += count;
+            }
+            for (int i = 0; i < size; i++)
+            {
+                buffer[counts[distributionKey(s, array[i])]++] = array[i];
+            }
+            s.index = 0;
+            s.phase = 2;
+        }
+        return result;
+
+    case 2: // Copy one element back
+        if (s.index < size)
+        {
+            array[s.index] = buffer[s.index];
+            result.index1 = s.index;
+            result.swapped = true;
+            s.index++;
+            return result;
+        }
+        s.phase = s.exact ? 4 : 3;
+        s.index = 1;
+        s.insertPos = 1;
+        return result;
+
+    case 3: // Insertion pass; elements only move within their bucket
+        if (s.index >= size)
+        {
+            s.phase = 4;
+            break;
+        }
+
+        if (s.insertPos > 0 && array[s.insertPos - 1] > array[s.insertPos])
+        {
+            std::swap(array[s.insertPos - 1], array[s.insertPos]);
+            result.index1 = s.insertPos - 1;
+            result.index2 = s.insertPos;
+            result.swapped = true;
+            s.insertPos--;
+        }
+        else
+        {
+            s.index++;
+            s.insertPos = s.index;
+        }
+        return result;
+    }
+
+    result.isComplete = true;
+    return result;
+}
+
+extern const StateType countingSortState = {distributionSortStateBytes, nullptr, nullptr};
+
+SwapResult countingSort(int array[], int size, int *state)
+{
+    return distributionSortStep(array, size, state, true);
+}
+
+extern void radixSortAll(int array[], int size, Arena &scratch);
+
+/**
+ * Counting Sort - whole array in one call
+ * Ranges too wide for a count table are left to Radix Sort
+ */
+void countingSortAll(int array[], int size, Arena &scratch)
+{
+    if (size < 2)
+        return;
+
+    auto bounds = std::minmax_element(array, array + size);
+    int minValue = *bounds.first;
+    int maxValue = *bounds.second;
+
+    if (countingSortFits(size, static_cast<long long>(maxValue) - minValue))
+        countingSortRange(array, size, minValue, maxValue, scratch);
+    else
+        radixSortAll(array, size, scratch);
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include "algorithm_interface.h"
+#include <cstddef>
+
+/**
+ * Counting sort over a small key range: one pass counts every value, one pass
+ * writes the values back out in order. Used by "Counting Sort" and by Radix
+ * Sort, which switches to it when max - min is small next to the size.
+ */
+
+/**
+ * Whether a count table for this range is worth it (and small enough) for
+ * this many elements; range is max - min
+ */
+bool countingSortFits(int size, long long range);
+
+/**
+ * Counting sort of values known to lie in [minValue, maxValue]
+ */
+void countingSortRange(int array[], int size, int minValue, int maxValue, Arena &scratch);
+
+/**
+ * Step version shared by Counting Sort and Bucket Sort
+ * The first step finds min and max. The elements are then counted one per
+ * step under their key, scattered into a buffer in one step and copied back
+ * one per step. With exactKeys and a range that fits the table the key is
+ * value - min and the array is sorted after the copy; otherwise the key is the
+ * value scaled down to one bucket per element, and an insertion pass finishes
+ * each bucket.
+ */
+size_t distributionSortStateBytes(int size);
+SwapResult distributionSortStep(int array[], int size, int *state, bool exactKeys);
@@ -0,0 +1,403 @@
+#include "external_sort.h"
+#include "arena.h"
+#include "loser_tree.h"
+#include "sort_runner.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <future>
+#include <memory>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace
+{
+const size_t MIN_MERGE_BUFFER = 16 * 1024; // Elements per merge buffer (64 KiB)
+const int SAMPLE_SIZE = 1 << 18;           // Elements timed when picking the engine
+
+double secondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * Reads a run sequentially into two buffers: one is merged from while the
+ * other is being filled in the background
+ */
+class RunReader
+{
+public:
+    RunReader(FILE *file, size_t bufferElements)
+        : file(file), front(bufferElements), back(bufferElements), position(0), available(0), failed(false)
+    {
+        startRead();
+        swapBuffers();
+    }
+
+    ~RunReader()
+    {
+        if (pending.valid())
+            pending.wait();
+    }
+
+    bool empty() const { return position == available; }
+    int value() const { return front[position]; }
+    bool hasFailed() const { return failed; }
+
+    void advance()
+    {
+        if (++position == available)
+            swapBuffers();
+    }
+
+private:
+    FILE *file;
+    std::vector<int> front;
+    std::vector<int> back;
+    size_t position;
+    size_t available;
+    bool failed;
+    std::future<size_t> pending;
+
+    void startRead()
+    {
+        FILE *source = file;
+        int *target = back.data();
+        size_t count = back.size();
+        pending = std::async(std::launch::async, [source, target, count]() {
+            return std::fread(target, sizeof(int), count, source);
+        });
+    }
+
+    void swapBuffers()
+    {
+        position = 0;
+        if (!pending.valid())
+        {
+            available = 0;
+            return;
+        }
+
+        available = pending.get();
+        std::swap(front, back);
+
+        if (available < front.size() && std::ferror(file))
+            failed = true;
+
+        // A short read means the run is exhausted, so there is nothing left to prefetch
+        if (available == front.size())
+            startRead();
+    }
+};
+
+/**
+ * Collects merged output in one buffer while the previous one is written
+ */
+class RunWriter
+{
+public:
+    RunWriter(FILE *file, size_t bufferElements)
+        : file(file), front(bufferElements), back(bufferElements), count(0), ok(true)
+    {
+    }
+
+    ~RunWriter() { waitForWrite(); }
+
+    void push(int value)
+    {
+        front[count++] = value;
+        if (count == front.size())
+            flush();
+    }
+
+    bool finish()
+    {
+        flush();
+        waitForWrite();
+        return ok;
+    }
+
+private:
+    FILE *file;
+    std::vector<int> front;
+    std::vector<int> back;
+    size_t count;
+    bool ok;
+    std::future<bool> pending;
+
+    void waitForWrite()
+    {
+        if (pending.valid() && !pending.get())
+            ok = false;
+    }
+
+    void flush()
+    {
+        if (count == 0)
+            return;
+
+        waitForWrite();
+        std::swap(front, back);
+
+        FILE *target = file;
+        const int *source = back.data();
+        size_t length = count;
+        pending = std::async(std::launch::async, [target, source, length]() {
+            return std::fwrite(source, sizeof(int), length, target) == length;
+        });
+        count = 0;
+    }
+};
+
+bool mergeRuns(const std::vector<std::string> &inputs, const std::string &outputPath,
+               size_t bufferElements, std::string &error)
+{
+    std::vector<FILE *> files;
+    for (const std::string &path : inputs)
+    {
+        FILE *file = std::fopen(path.c_str(), "rb");
+        if (!file)
+        {
+            error = "cannot open run " + path;
+            for (FILE *open : files)
+                std::fclose(open);
+            return false;
+        }
+        files.push_back(file);
+    }
+
+    FILE *output = std::fopen(outputPath.c_str(), "wb");
+    if (!output)
+    {
+        error = "cannot create " + outputPath;
+        for (FILE *open : files)
+            std::fclose(open);
+        return false;
+    }
+
+    bool ok = true;
+    {
+        std::vector<std::unique_ptr<RunReader>> readers;
+        std::vector<RunReader *> runs;
+        for (FILE *file : files)
+        {
+            readers.emplace_back(new RunReader(file, bufferElements));
+            runs.push_back(readers.back().get());
+        }
+
+        RunWriter writer(output, bufferElements);
+        LoserTree tree(static_cast<int>(runs.size()));
+        for (size_t i = 0; i < runs.size(); i++)
+        {
+            if (runs[i]->empty())
+                tree.setSourceEmpty(static_cast<int>(i));
+            else
+                tree.setSource(static_cast<int>(i), runs[i]->value());
+        }
+        tree.build();
+
+        while (!tree.empty())
+        {
+            writer.push(tree.topKey());
+
+            RunReader *run = runs[tree.topSource()];
+            run->advance();
+            if (run->empty())
+                tree.removeTop();
+            else
+                tree.replaceTop(run->value());
+        }
+
+        if (!writer.finish())
+        {
+            error = "write failed on " + outputPath;
+            ok = false;
+        }
+        for (RunReader *run : runs)
+        {
+            if (run->hasFailed())
+            {
+                error = "read failed while merging runs";
+                ok = false;
+            }
+        }
+    }
+
+    for (FILE *file : files)
+        std::fclose(file);
+    if (std::fclose(output) != 0 && ok)
+    {
+        error = "write failed on " + outputPath;
+        ok = false;
+    }
+    return ok;
+}
+
+void removeFiles(const std::vector<std::string> &paths)
+{
+    for (const std::string &path : paths)
+        std::remove(path.c_str());
+}
+}
+
+bool externalSort(const std::string &inputPath, const std::string &outputPath,
+                  const ExternalSortOptions &options, ExternalSortStats &stats, std::string &error)
+{
+    stats = ExternalSortStats{nullptr, 0, 0, 0, 0.0, 0.0};
+    if (options.engine && !isBulkSortEngine(*options.engine))
+    {
+        error = std::string(options.engine->name) + " cannot sort whole chunks";
+        return false;
+    }
+
+    // Two chunk buffers so the next read overlaps the sort, plus room for the engine's scratch
+    size_t chunkElements = options.memoryBytes / sizeof(int) / 3;
+    if (chunkElements < MIN_MERGE_BUFFER)
+    {
+        error = "memory budget too small";
+        return false;
+    }
+    chunkElements = std::min(chunkElements, static_cast<size_t>(0x7fffffff));
+
+    FILE *input = std::fopen(inputPath.c_str(), "rb");
+    if (!input)
+    {
+        error = "cannot open " + inputPath;
+        return false;
+    }
+
+    std::random_device rd;
+    std::string runPrefix = options.tempDirectory + "/sortrun-" + std::to_string(rd()) + "-";
+    std::vector<std::string> runs;
+
+    // Phase 1: sorted runs
+    auto runStart = std::chrono::steady_clock::now();
+    std::vector<int> current(chunkElements);
+    std::vector<int> next(chunkElements);
+    auto readChunk = [input](std::vector<int> &buffer) {
+        return std::fread(buffer.data(), 1, buffer.size() * sizeof(int), input);
+    };
+
+    size_t currentBytes = readChunk(current);
+    const AlgorithmInfo *engine = options.engine;
+    Arena scratch; // Sized by the first chunk, reused by the rest
+    bool ok = true;
+
+    while (currentBytes > 0)
+    {
+        if (currentBytes % sizeof(int) != 0)
+        {
+            error = inputPath + " is not a whole number of 32-bit ints";
+            ok = false;
+            break;
+        }
+
+        std::future<size_t> prefetch = std::async(std::launch::async, readChunk, std::ref(next));
+        int count = static_cast<int>(currentBytes / sizeof(int));
+
+        if (!engine)
+        {
+            engine = pickFastestAlgorithm(current.data(), std::min(count, SAMPLE_SIZE));
+            if (!engine)
+            {
+                error = "no registered algorithm has a bulk sort path";
+                ok = false;
+                prefetch.wait();
+                break;
+            }
+        }
+        scratch.reset();
+        runToCompletion(*engine, current.data(), count, scratch);
+
+        std::string runPath = runPrefix + std::to_string(runs.size()) + ".bin";
+        FILE *run = std::fopen(runPath.c_str(), "wb");
+        bool written = run && std::fwrite(current.data(), sizeof(int), count, run) == static_cast<size_t>(count);
+        if (run && std::fclose(run) != 0)
+            written = false;
+        runs.push_back(runPath);
+        stats.elements += count;
+
+        size_t nextBytes = prefetch.get();
+        if (!written)
+        {
+            error = "cannot write run " + runPath;
+            ok = false;
+            break;
+        }
+
+        std::swap(current, next);
+        currentBytes = nextBytes;
+    }
+
+    if (ok && std::ferror(input))
+    {
+        error = "read failed on " + inputPath;
+        ok = false;
+    }
+    std::fclose(input);
+    current = std::vector<int>();
+    next = std::vector<int>();
+
+    stats.engineName = engine ? engine->name : nullptr;
+    stats.runs = static_cast<int>(runs.size());
+    stats.runSeconds = secondsSince(runStart);
+
+    if (!ok)
+    {
+        removeFiles(runs);
+        return false;
+    }
+
+    // Phase 2: k-way merge, in several passes if the runs do not all fit the budget
+    auto mergeStart = std::chrono::steady_clock::now();
+    size_t budgetElements = options.memoryBytes / sizeof(int);
+    size_t maxFanIn = std::max<size_t>(2, budgetElements / (2 * MIN_MERGE_BUFFER) - 1);
+
+    while (ok && runs.size() > maxFanIn)
+    {
+        std::vector<std::string> merged;
+        size_t bufferElements = budgetElements / (2 * maxFanIn + 2);
+
+        for (size_t first = 0; ok && first < runs.size(); first += maxFanIn)
+        {
+            std::vector<std::string> group(runs.begin() + first,
+                                           runs.begin() + std::min(first + maxFanIn, runs.size()));
+            std::string mergedPath = runPrefix + "p" + std::to_string(stats.mergePasses) + "-" +
+                                     std::to_string(merged.size()) + ".bin";
+            merged.push_back(mergedPath);
+            ok = mergeRuns(group, mergedPath, bufferElements, error);
+            removeFiles(group);
+        }
+
+        if (!ok)
+        {
+            removeFiles(runs);
+            removeFiles(merged);
+            return false;
+        }
+        runs = merged;
+        stats.mergePasses++;
+    }
+
+    if (runs.empty())
+    {
+        // Empty input still produces an (empty) output file
+        FILE *output = std::fopen(outputPath.c_str(), "wb");
+        if (!output)
+        {
+            error = "cannot create " + outputPath;
+            return false;
+        }
+        std::fclose(output);
+        return true;
+    }
+
+    size_t bufferElements = budgetElements / (2 * runs.size() + 2);
+    ok = mergeRuns(runs, outputPath, bufferElements, error);
+    removeFiles(runs);
+    stats.mergePasses++;
+    stats.mergeSeconds = secondsSince(mergeStart);
+
+    return ok;
+}
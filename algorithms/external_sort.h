@@ -0,0 +1,40 @@
+#pragma once
+#include "algorithm_interface.h"
+#include <cstddef>
+#include <string>
+
+/**
+ * External-memory sort for files of raw native-endian 32-bit ints that do not
+ * fit in RAM
+ *
+ * Phase 1 streams the input in memory-sized chunks, sorts each chunk with an
+ * in-memory engine and writes it out as a sorted run. Reading the next chunk
+ * overlaps with sorting and writing the current one.
+ * Phase 2 merges the runs with a loser tree. Every run and the output are
+ * double-buffered, so disk reads and writes overlap with merging. If there are
+ * too many runs for the memory budget, groups of runs are merged first.
+ */
+
+struct ExternalSortOptions
+{
+    size_t memoryBytes;        // RAM budget for chunks and merge buffers
+    std::string tempDirectory; // Where the sorted runs are written
+    const AlgorithmInfo *engine; // In-memory engine (isBulkSortEngine); nullptr picks the fastest registered one
+};
+
+struct ExternalSortStats
+{
+    const char *engineName; // Engine that sorted the chunks
+    long long elements;     // Number of ints sorted
+    int runs;               // Sorted runs written in phase 1
+    int mergePasses;        // Merge passes in phase 2 (1 unless the fan-in was limited)
+    double runSeconds;      // Time spent generating runs
+    double mergeSeconds;    // Time spent merging
+};
+
+/**
+ * Sort inputPath into outputPath
+ * @return: false on failure, with a description in error
+ */
+bool externalSort(const std::string &inputPath, const std::string &outputPath,
+                  const ExternalSortOptions &options, ExternalSortStats &stats, std::string &error);
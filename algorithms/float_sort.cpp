@@ -0,0 +1,138 @@
+#include "float_sort.h"
+#include "radix_keys.h"
+#include "sort_runner.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+// Elements per pool task when mapping values to keys and back
+static const long long CONVERT_GRAIN = 1 << 16;
+
+namespace
+{
+template <typename Float>
+struct FloatTraits;
+
+template <>
+struct FloatTraits<float>
+{
+    typedef uint32_t Bits;
+    static const Bits SIGN_BIT = 0x80000000u;
+    static Bits toKey(Bits bits) { return floatBitsToKey(bits); }
+    static Bits fromKey(Bits key) { return keyToFloatBits(key); }
+};
+
+template <>
+struct FloatTraits<double>
+{
+    typedef uint64_t Bits;
+    static const Bits SIGN_BIT = 0x8000000000000000ULL;
+    static Bits toKey(Bits bits) { return doubleBitsToKey(bits); }
+    static Bits fromKey(Bits key) { return keyToDoubleBits(key); }
+};
+
+/**
+ * Move the NaNs to the end or the start, as order asks
+ * @return: The range [begin, end) left to sort
+ */
+template <typename Float>
+void setAsideNans(Float values[], size_t size, NanPlacement nans, size_t &begin, size_t &end)
+{
+    begin = 0;
+    end = size;
+    if (nans == NANS_LAST)
+        end = std::partition(values, values + size, [](Float value) { return !std::isnan(value); }) - values;
+    else if (nans == NANS_FIRST)
+        begin = std::partition(values, values + size, [](Float value) { return std::isnan(value); }) - values;
+}
+
+/**
+ * Rewrite values[begin, end) as keys (flip is XORed in on top), in place
+ */
+template <typename Float>
+void valuesToKeys(Float values[], size_t begin, size_t end, bool zeroAsPositive,
+                  typename FloatTraits<Float>::Bits flip)
+{
+    typedef FloatTraits<Float> Traits;
+    parallelFor(begin, end, CONVERT_GRAIN, [=](long long first, long long last) {
+        for (long long i = first; i < last; i++)
+        {
+            typename Traits::Bits bits;
+            std::memcpy(&bits, &values[i], sizeof(bits));
+            if (zeroAsPositive && bits == Traits::SIGN_BIT)
+                bits = 0;
+            bits = Traits::toKey(bits) ^ flip;
+            std::memcpy(&values[i], &bits, sizeof(bits));
+        }
+    });
+}
+
+template <typename Float>
+void keysToValues(Float values[], size_t begin, size_t end, typename FloatTraits<Float>::Bits flip)
+{
+    typedef FloatTraits<Float> Traits;
+    parallelFor(begin, end, CONVERT_GRAIN, [=](long long first, long long last) {
+        for (long long i = first; i < last; i++)
+        {
+            typename Traits::Bits key;
+            std::memcpy(&key, &values[i], sizeof(key));
+            key = Traits::fromKey(key ^ flip);
+            std::memcpy(&values[i], &key, sizeof(key));
+        }
+    });
+}
+} // namespace
+
+bool sortFloats(float values[], size_t size, const FloatOrder &order, const AlgorithmInfo *engine,
+                std::string &error)
+{
+    if (engine && !isBulkSortEngine(*engine))
+    {
+        error = std::string(engine->name) + " has no whole-array sort to run on float keys";
+        return false;
+    }
+    if (engine && size > static_cast<size_t>(INT_MAX))
+    {
+        error = std::string(engine->name) + " sorts at most INT_MAX values; use the radix passes";
+        return false;
+    }
+
+    size_t begin, end;
+    setAsideNans(values, size, order.nans, begin, end);
+
+    // The int engines see the keys with the top bit flipped: signed order
+    uint32_t flip = engine ? FloatTraits<float>::SIGN_BIT : 0;
+    valuesToKeys(values, begin, end, order.zeroAsPositive, flip);
+    if (engine)
+        runToCompletion(*engine, reinterpret_cast<int *>(values + begin), static_cast<int>(end - begin));
+    else
+        radixSortKeys32(reinterpret_cast<uint32_t *>(values + begin), end - begin);
+    keysToValues(values, begin, end, flip);
+    return true;
+}
+
+void sortDoubles(double values[], size_t size, const FloatOrder &order)
+{
+    size_t begin, end;
+    setAsideNans(values, size, order.nans, begin, end);
+    valuesToKeys(values, begin, end, order.zeroAsPositive, 0);
+    radixSortKeys64(reinterpret_cast<uint64_t *>(values + begin), end - begin);
+    keysToValues(values, begin, end, 0);
+}
+
+bool parseNanPlacement(const char *name, NanPlacement &placement)
+{
+    const char *const names[] = {"last", "first", "sign"};
+    for (int candidate = 0; candidate < 3; candidate++)
+    {
+        if (std::strcmp(name, names[candidate]) == 0)
+        {
+            placement = static_cast<NanPlacement>(candidate);
+            return true;
+        }
+    }
+    return false;
+}
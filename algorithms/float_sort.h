@@ -0,0 +1,48 @@
+#pragma once
+#include "algorithm_interface.h"
+#include <cstddef>
+#include <string>
+
+/**
+ * Sorting IEEE-754 floats and doubles through order-preserving integer keys
+ *
+ * Each value's bits are mapped in place to an unsigned key that sorts in the
+ * value's numeric order (see floatBitsToKey in radix_keys.h), the keys are
+ * sorted as integers, and the bits are mapped back. No comparator runs, so
+ * NaNs cannot break the sort and need no special case in the inner loops.
+ */
+enum NanPlacement
+{
+    NANS_LAST,   // After +inf, whatever their sign (as SQL ORDER BY does)
+    NANS_FIRST,  // Before -inf
+    NANS_BY_SIGN // IEEE 754 totalOrder: negative NaNs first, positive NaNs last
+};
+
+struct FloatOrder
+{
+    NanPlacement nans;
+    bool zeroAsPositive; // Write -0.0 back as +0.0; otherwise it sorts just before +0.0
+};
+
+/**
+ * Sort floats: with the radix passes of radixSortKeys32, or with any
+ * registered whole-array engine run on the keys as ints (Merge Sort, Quick
+ * Sort, ...), since the keys with their top bit flipped order as int32 does
+ * @param engine: nullptr for the radix passes
+ * @return: false, with error set, for an engine without a whole-array path,
+ *          a selection engine, or more than INT_MAX values for an engine
+ */
+bool sortFloats(float values[], size_t size, const FloatOrder &order, const AlgorithmInfo *engine,
+                std::string &error);
+
+/**
+ * Sort doubles with the radix passes of radixSortKeys64 (the registered
+ * engines hold 32-bit ints, too narrow for the keys)
+ */
+void sortDoubles(double values[], size_t size, const FloatOrder &order);
+
+/**
+ * "last", "first" or "sign" to a placement
+ * @return: false for any other name
+ */
+bool parseNanPlacement(const char *name, NanPlacement &placement);
@@ -0,0 +1,330 @@
+#include "heap_sort.h"
+#include "algorithm_interface.h"
+#include "algorithm_registry.h"
+#include <algorithm>
+#include <utility>
+
+#if defined(__GNUC__) || defined(__clang__)
+#define HEAP_PREFETCH(address) __builtin_prefetch(address)
+#else
+#define HEAP_PREFETCH(address) ((void)(address))
+#endif
+
+namespace
+{
+const int INTS_PER_LINE = 16;
+const int SPECULATE_ABOVE = 1 << 20; // Binary heaps bigger than typical L2 + L3 slices
+
+/**
+ * Levels to look ahead so that the prefetched descendants fill at least one
+ * cache line: 4 levels of a binary heap, 2 of a 4-ary or 8-ary heap
+ */
+template <int D>
+struct Lookahead
+{
+    static const int levels = D >= 4 ? 2 : 4;
+    static const int width = D >= 4 ? D * D : 16;             // D^levels
+    static const int offset = D >= 4 ? D + 1 : 15;            // (D^levels - 1) / (D - 1)
+
+    // Slots the heap is shifted by in its buffer so that the prefetched block
+    // (and with it every group of D siblings) starts on a cache line
+    static const int shift = (INTS_PER_LINE - offset % INTS_PER_LINE) % INTS_PER_LINE;
+};
+
+template <int D>
+inline void prefetchDescendants(const int heap[], int size, int node)
+{
+    long long first = static_cast<long long>(node) * Lookahead<D>::width + Lookahead<D>::offset;
+    long long last = std::min<long long>(first + Lookahead<D>::width, size);
+    for (long long i = first; i < last; i += INTS_PER_LINE)
+    {
+        HEAP_PREFETCH(heap + i);
+    }
+}
+
+/**
+ * Floyd's sift: move the hole at node down to a leaf along the larger
+ * children, then let value rise from there (never above node)
+ *
+ * Speculate picks the larger child with a branch instead of a branch-free
+ * select. Half of those branches mispredict, but the CPU runs ahead into the
+ * next level meanwhile - in the bottom levels of a heap far larger than the
+ * cache, where there is nothing left below to prefetch, that beats waiting
+ * for each level's miss in turn.
+ */
+template <int D, bool Speculate>
+void floydSift(int heap[], int size, int node, int value)
+{
+    int hole = node;
+
+    // Nodes up to lastFull have all D children
+    int lastFull = size > D ? (size - 1 - D) / D : -1;
+    while (hole <= lastFull)
+    {
+        prefetchDescendants<D>(heap, size, hole);
+
+        int first = hole * D + 1;
+        int best = first;
+        int bestValue = heap[first];
+        for (int child = first + 1; child < first + D; child++)
+        {
+            int childValue = heap[child];
+            if (Speculate)
+            {
+                if (childValue > bestValue)
+                {
+                    best = child;
+                    bestValue = childValue;
+                }
+            }
+            else
+            {
+                // Masks rather than ?: so the compiler cannot turn it back into branches
+                int mask = -static_cast<int>(childValue > bestValue);
+                best ^= (best ^ child) & mask;
+                bestValue ^= (bestValue ^ childValue) & mask;
+            }
+        }
+        heap[hole] = bestValue;
+        hole = best;
+    }
+
+    // At most one node has only some of its children
+    if (static_cast<long long>(hole) * D + 1 < size)
+    {
+        int first = hole * D + 1;
+        int best = first;
+        for (int child = first + 1; child < size; child++)
+        {
+            best = heap[child] > heap[best] ? child : best;
+        }
+        heap[hole] = heap[best];
+        hole = best;
+    }
+
+    while (hole > node)
+    {
+        int parent = (hole - 1) / D;
+        if (heap[parent] >= value)
+            break;
+        heap[hole] = heap[parent];
+        hole = parent;
+    }
+    heap[hole] = value;
+}
+
+template <int D, bool Speculate>
+void heapSortAligned(int array[], int size, Arena &scratch)
+{
+    int *heap = scratch.allocateArray<int>(static_cast<size_t>(size) + Lookahead<D>::shift) + Lookahead<D>::shift;
+    std::copy(array, array + size, heap);
+
+    for (int node = (size - 2) / D; node >= 0; node--)
+    {
+        floydSift<D, Speculate>(heap, size, node, heap[node]);
+    }
+
+    for (int end = size - 1; end > 0; end--)
+    {
+        int value = heap[end];
+        heap[end] = heap[0];
+        floydSift<D, Speculate>(heap, end, 0, value);
+    }
+
+    std::copy(heap, heap + size, array);
+}
+}
+
+void heapSort(int array[], int size, int arity, Arena &scratch)
+{
+    if (size < 2)
+        return;
+
+    switch (arity)
+    {
+    case 8:
+        heapSortAligned<8, false>(array, size, scratch);
+        break;
+    case 4:
+        heapSortAligned<4, false>(array, size, scratch);
+        break;
+    default:
+        // Only the binary heap is deep enough for speculation to pay off
+        if (size > SPECULATE_ABOVE)
+            heapSortAligned<2, true>(array, size, scratch);
+        else
+            heapSortAligned<2, false>(array, size, scratch);
+        break;
+    }
+}
+
+static void textbookSiftDown(int array[], int size, int node)
+{
+    for (;;)
+    {
+        int largest = node;
+        int left = 2 * node + 1;
+        int right = left + 1;
+        if (left < size && array[left] > array[largest])
+            largest = left;
+        if (right < size && array[right] > array[largest])
+            largest = right;
+        if (largest == node)
+            return;
+        std::swap(array[node], array[largest]);
+        node = largest;
+    }
+}
+
+void heapSortTextbook(int array[], int size)
+{
+    for (int node = size / 2 - 1; node >= 0; node--)
+    {
+        textbookSiftDown(array, size, node);
+    }
+    for (int end = size - 1; end > 0; end--)
+    {
+        std::swap(array[0], array[end]);
+        textbookSiftDown(array, end, 0);
+    }
+}
+
+/**
+ * Heap Sort (visualization)
+ * Builds a max-heap with `arity` children per node, then repeatedly swaps the
+ * top to the end of the shrinking heap and sifts the new top down. Sifting
+ * shows one swap per step (the classic top-down sift, which is easier to
+ * follow than Floyd's)
+ *
+ * State:
+ * phase = 0=build, 1=extract, 2=done
+ * arity = children per node (2, 4 or 8)
+ * next = build: next node to sift down; extract: heap size
+ * sift = node being sifted down (-1 when not sifting)
+ */
+struct HeapSortState
+{
+    int phase;
+    int arity;
+    int next;
+    int sift;
+};
+
+static size_t heapSortStateBytes(int)
+{
+    return sizeof(HeapSortState);
+}
+
+static void heapSortInit(HeapSortState &s, int size, int arity)
+{
+    s.arity = arity;
+    s.next = (size - 2) / arity;
+    s.sift = -1;
+}
+
+static void binaryHeapSortInit(void *state, int size)
+{
+    heapSortInit(*static_cast<HeapSortState *>(state), size, 2);
+}
+
+static void quaternaryHeapSortInit(void *state, int size)
+{
+    heapSortInit(*static_cast<HeapSortState *>(state), size, 4);
+}
+
+static void octonaryHeapSortInit(void *state, int size)
+{
+    heapSortInit(*static_cast<HeapSortState *>(state), size, 8);
+}
+
+extern const StateType binaryHeapSortState = {heapSortStateBytes, binaryHeapSortInit, nullptr};
+extern const StateType quaternaryHeapSortState = {heapSortStateBytes, quaternaryHeapSortInit, nullptr};
+extern const StateType octonaryHeapSortState = {heapSortStateBytes, octonaryHeapSortInit, nullptr};
+
+static SwapResult heapSiftStep(int array[], int heapSize, int arity, int &sift)
+{
+    SwapResult result = {sift, -1, false, false};
+
+    int largest = sift;
+    int first = arity * sift + 1;
+    int last = std::min(first + arity, heapSize);
+    for (int child = first; child < last; child++)
+    {
+        if (array[child] > array[largest])
+            largest = child;
+    }
+
+    if (largest == sift)
+    {
+        sift = -1;
+        return result;
+    }
+
+    std::swap(array[sift], array[largest]);
+    result.index2 = largest;
+    result.swapped = true;
+    sift = largest;
+    return result;
+}
+
+SwapResult heapSortStep(int array[], int size, int *state)
+{
+    HeapSortState &s = typedState<HeapSortState>(state);
+    SwapResult result = {-1, -1, false, false};
+
+    if (size < 2)
+        s.phase = 2;
+
+    switch (s.phase)
+    {
+    case 0: // Build: sift every internal node, last one first
+        if (s.sift >= 0)
+            return heapSiftStep(array, size, s.arity, s.sift);
+        if (s.next < 0)
+        {
+            s.phase = 1;
+            s.next = size;
+            return result;
+        }
+        s.sift = s.next--;
+        return heapSiftStep(array, size, s.arity, s.sift);
+
+    case 1: // Extract: top to the end, then restore the heap
+        if (s.sift >= 0)
+            return heapSiftStep(array, s.next, s.arity, s.sift);
+        if (s.next <= 1)
+        {
+            s.phase = 2;
+            break;
+        }
+
+        s.next--;
+        std::swap(array[0], array[s.next]);
+        result.index1 = 0;
+        result.index2 = s.next;
+        result.swapped = true;
+        s.sift = 0;
+        return result;
+    }
+
+    result.isComplete = true;
+    return result;
+}
+
+/**
+ * Heap Sort - whole array in one call
+ */
+void binaryHeapSortAll(int array[], int size, Arena &scratch)
+{
+    heapSort(array, size, 2, scratch);
+}
+
+void quaternaryHeapSortAll(int array[], int size, Arena &scratch)
+{
+    heapSort(array, size, 4, scratch);
+}
+
+void octonaryHeapSortAll(int array[], int size, Arena &scratch)
+{
+    heapSort(array, size, 8, scratch);
+}
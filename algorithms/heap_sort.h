@@ -0,0 +1,28 @@
+#pragma once
+#include "arena.h"
+
+/**
+ * Heap sort over a d-ary heap, behind the "Heap Sort" engines
+ *
+ * The heap is laid out breadth-first (the Eytzinger order), shifted in a
+ * cache-line aligned copy so that every node's children share one aligned
+ * block. Sifting is Floyd's bottom-up variant: walk down to a leaf along the
+ * larger children, then move the element up from there, which saves the
+ * comparison against it at every level. Descendants a few levels down are
+ * prefetched while the current level is compared, so arrays larger than the
+ * last-level cache do not stall on a miss per level. Large binary heaps pick
+ * the larger child with a branch rather than a branch-free select, letting the
+ * CPU speculate into the bottom levels where there is nothing to prefetch.
+ *
+ * @param arity: 2, 4 or 8 children per node
+ * @param scratch: Holds the aligned copy (size ints), which is why the Heap
+ *                 Sort engines are not registered ALGO_IN_PLACE
+ */
+void heapSort(int array[], int size, int arity, Arena &scratch);
+
+/**
+ * Classic in-place binary heap sort (swap-based sift-down, no prefetching),
+ * kept as the baseline for sortbench --heap and as Quick Sort's fallback on
+ * ranges that used up their bad split budget
+ */
+void heapSortTextbook(int array[], int size);
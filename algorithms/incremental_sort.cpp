@@ -0,0 +1,140 @@
+#include "incremental_sort.h"
+#include "auto_sort.h"
+#include <algorithm>
+
+/**
+ * First position in [from, end) not less than value, searching forward from
+ * from in doubling steps, then binary searching the last step: O(log distance)
+ */
+static int gallopLowerBound(const int array[], int from, int end, int value)
+{
+    long long bound = from;
+    long long step = 1;
+    while (bound < end && array[bound] < value)
+    {
+        from = static_cast<int>(bound) + 1;
+        bound += step;
+        step <<= 1;
+    }
+    return static_cast<int>(std::lower_bound(array + from, array + std::min<long long>(bound, end), value) - array);
+}
+
+/**
+ * First position in [begin, end) greater than value, searching backward from
+ * end in doubling steps (everything from end on is already known to be greater)
+ */
+static int gallopUpperBoundFromRight(const int array[], int begin, int end, int value)
+{
+    long long bound = static_cast<long long>(end) - 1;
+    long long step = 1;
+    while (bound >= begin && array[bound] > value)
+    {
+        end = static_cast<int>(bound);
+        bound -= step;
+        step <<= 1;
+    }
+    return static_cast<int>(std::upper_bound(array + std::max<long long>(bound + 1, begin), array + end, value) - array);
+}
+
+void IncrementalSort::assign(std::vector<int> values)
+{
+    sorted = std::move(values);
+    scratch.reset();
+    autoSortAll(sorted.data(), size(), scratch);
+}
+
+bool IncrementalSort::apply(const SortedChange changes[], int count, std::string &error)
+{
+    scratch.reset();
+
+    int removeCount = 0;
+    int addCount = 0;
+    for (int i = 0; i < count; i++)
+    {
+        removeCount += changes[i].type != CHANGE_INSERT;
+        addCount += changes[i].type != CHANGE_DELETE;
+    }
+
+    // Only the batch is sorted
+    int *removed = scratch.allocateArray<int>(removeCount);
+    int *added = scratch.allocateArray<int>(addCount);
+    int r = 0;
+    int a = 0;
+    for (int i = 0; i < count; i++)
+    {
+        if (changes[i].type != CHANGE_INSERT)
+            removed[r++] = changes[i].oldValue;
+        if (changes[i].type != CHANGE_DELETE)
+            added[a++] = changes[i].newValue;
+    }
+    autoSortAll(removed, removeCount, scratch);
+    autoSortAll(added, addCount, scratch);
+
+    // A value both added and removed cancels out (an update that keeps its
+    // value, or a later change to something added earlier in the batch)
+    int keptRemoved = 0;
+    int keptAdded = 0;
+    for (r = 0, a = 0; r < removeCount || a < addCount;)
+    {
+        if (a == addCount || (r < removeCount && removed[r] < added[a]))
+            removed[keptRemoved++] = removed[r++];
+        else if (r == removeCount || added[a] < removed[r])
+            added[keptAdded++] = added[a++];
+        else
+        {
+            r++;
+            a++;
+        }
+    }
+    removeCount = keptRemoved;
+    addCount = keptAdded;
+
+    int *data = sorted.data();
+    int live = size();
+
+    // Find every removal before touching the array; equal removals take successive copies
+    int *positions = scratch.allocateArray<int>(removeCount);
+    int from = 0;
+    for (int i = 0; i < removeCount; i++)
+    {
+        int position = gallopLowerBound(data, from, live, removed[i]);
+        if (position == live || data[position] != removed[i])
+        {
+            error = "no element " + std::to_string(removed[i]) + " to remove";
+            return false;
+        }
+        positions[i] = position;
+        from = position + 1;
+    }
+
+    // Close the gaps left to right, a block at a time
+    if (removeCount > 0)
+    {
+        int write = positions[0];
+        for (int i = 0; i < removeCount; i++)
+        {
+            int blockBegin = positions[i] + 1;
+            int blockEnd = i + 1 < removeCount ? positions[i + 1] : live;
+            std::copy(data + blockBegin, data + blockEnd, data + write);
+            write += blockEnd - blockBegin;
+        }
+        live -= removeCount;
+    }
+
+    // Merge the additions in from the right: the largest goes last, and each
+    // block of larger elements moves right by the number still to place
+    sorted.resize(static_cast<size_t>(live) + addCount);
+    data = sorted.data();
+    int end = live;
+    int write = live + addCount;
+    for (int i = addCount - 1; i >= 0; i--)
+    {
+        int position = gallopUpperBoundFromRight(data, 0, end, added[i]);
+        std::copy_backward(data + position, data + end, data + write);
+        write -= end - position;
+        data[--write] = added[i];
+        end = position;
+    }
+
+    return true;
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include "arena.h"
+#include <string>
+#include <vector>
+
+/**
+ * Keeping an array sorted under batches of changes, without re-sorting it
+ *
+ * Elements carry no identity beyond their value, so a delete or an update
+ * names the value it takes away (one element equal to it is removed).
+ */
+enum ChangeType
+{
+    CHANGE_INSERT, // Add newValue
+    CHANGE_DELETE, // Remove one oldValue
+    CHANGE_UPDATE  // Remove one oldValue, add newValue
+};
+
+struct SortedChange
+{
+    ChangeType type;
+    int oldValue;
+    int newValue;
+};
+
+/**
+ * A sorted array plus the scratch memory to change it
+ *
+ * apply() sorts only the batch: the values it removes and the values it adds.
+ * The removals are found by galloping forward through the array and closed up
+ * left to right; the additions are then merged in from the right end, again
+ * by galloping, so the untouched stretches between changes move as whole
+ * blocks (memmove) and are never compared element by element. A batch of a
+ * few changes costs a few binary searches and one pass over the array's tail;
+ * a batch as large as the array is a plain linear merge.
+ */
+class IncrementalSort
+{
+public:
+    IncrementalSort() = default;
+
+    /**
+     * Replace the contents with values, sorted from scratch
+     */
+    void assign(std::vector<int> values);
+
+    /**
+     * Apply a batch of changes, in any order: a change may take away a value
+     * added by another one in the same batch. Fails, leaving the array
+     * unchanged, if the batch removes a value that neither the array nor the
+     * batch holds (counting duplicates: two deletes of 5 need two 5s)
+     */
+    bool apply(const SortedChange changes[], int count, std::string &error);
+
+    const std::vector<int> &values() const { return sorted; }
+    int size() const { return static_cast<int>(sorted.size()); }
+
+private:
+    std::vector<int> sorted;
+    Arena scratch;
+};
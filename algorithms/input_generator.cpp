@@ -0,0 +1,391 @@
+#include "input_generator.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <iterator>
+#include <set>
+#include <vector>
+
+static const long long GENERATE_GRAIN = 1 << 16;
+static const int SHUFFLE_BUCKET_SIZE = 1 << 16; // Values per bucket of the parallel shuffle, on average
+static const long long SHUFFLE_CHUNKS = 256;
+
+namespace
+{
+const char *const DISTRIBUTION_NAMES[DIST_COUNT] = {
+    "shuffled", "uniform", "zipf", "sorted-swaps", "reversed-runs", "duplicates", "median3-killer"};
+
+template <typename Fill>
+void fillParallel(int size, Fill fill)
+{
+    parallelFor(0, size, GENERATE_GRAIN, [&fill](long long begin, long long end) {
+        for (long long i = begin; i < end; i++)
+            fill(static_cast<int>(i));
+    });
+}
+
+/**
+ * Uniform random permutation of 1..size in parallel (Rao-Sandelius): every
+ * value picks one of size / SHUFFLE_BUCKET_SIZE buckets at random, the
+ * buckets are laid out back to back, and each bucket is then Fisher-Yates
+ * shuffled on its own, in cache. Chunk boundaries depend only on size, so the
+ * result does not depend on the number of threads.
+ */
+void shuffleParallel(const SeededRandom &random, int array[], int size)
+{
+    const int bucketCount = std::max(1, size / SHUFFLE_BUCKET_SIZE);
+    const int chunkCount = static_cast<int>(std::min<long long>(SHUFFLE_CHUNKS, (size + GENERATE_GRAIN - 1) / GENERATE_GRAIN));
+    auto chunkBegin = [size, chunkCount](long long chunk) {
+        return static_cast<int>(static_cast<long long>(size) * chunk / chunkCount);
+    };
+    auto bucketOf = [&random, bucketCount](int i) {
+        return static_cast<int>(((random.at(static_cast<uint64_t>(i)) >> 32) * static_cast<uint64_t>(bucketCount)) >> 32);
+    };
+
+    // Count per chunk and bucket, then turn the counts into write positions:
+    // bucket by bucket, and within a bucket chunk by chunk
+    std::vector<int> next(static_cast<size_t>(chunkCount) * bucketCount, 0); // Row c belongs to chunk c
+    parallelFor(0, chunkCount, 1, [&](long long first, long long last) {
+        for (long long chunk = first; chunk < last; chunk++)
+        {
+            int *count = next.data() + chunk * bucketCount;
+            for (int i = chunkBegin(chunk), end = chunkBegin(chunk + 1); i < end; i++)
+                count[bucketOf(i)]++;
+        }
+    });
+
+    std::vector<int> bucketStart(bucketCount + 1);
+    int offset = 0;
+    for (int b = 0; b < bucketCount; b++)
+    {
+        bucketStart[b] = offset;
+        for (int chunk = 0; chunk < chunkCount; chunk++)
+        {
+            int count = next[static_cast<size_t>(chunk) * bucketCount + b];
+            next[static_cast<size_t>(chunk) * bucketCount + b] = offset;
+            offset += count;
+        }
+    }
+    bucketStart[bucketCount] = size;
+
+    parallelFor(0, chunkCount, 1, [&](long long first, long long last) {
+        for (long long chunk = first; chunk < last; chunk++)
+        {
+            int *position = next.data() + chunk * bucketCount;
+            for (int i = chunkBegin(chunk), end = chunkBegin(chunk + 1); i < end; i++)
+                array[position[bucketOf(i)]++] = i + 1;
+        }
+    });
+
+    // Counters 0..size-1 picked the buckets; each bucket's shuffle gets a stream after them
+    parallelFor(0, bucketCount, 1, [&](long long first, long long last) {
+        for (long long b = first; b < last; b++)
+        {
+            SeededRandom stream(random.at(static_cast<uint64_t>(size) + static_cast<uint64_t>(b)));
+            int *bucket = array + bucketStart[b];
+            for (int i = bucketStart[b + 1] - bucketStart[b] - 1; i > 0; i--)
+                std::swap(bucket[i], bucket[stream.below(static_cast<uint64_t>(i) + 1)]);
+        }
+    });
+}
+
+/**
+ * Zipf ranks by rejection-inversion (Hormann and Derflinger): constant
+ * expected time per sample for any range and any exponent > 0
+ */
+class ZipfSampler
+{
+public:
+    ZipfSampler(long long range, double exponent) : range(range), exponent(exponent)
+    {
+        integralX1 = integral(1.5) - 1.0;
+        integralN = integral(range + 0.5);
+        squeeze = 2.0 - integralInverse(integral(2.5) - density(2.0));
+    }
+
+    long long sample(SeededRandom &random) const
+    {
+        for (;;)
+        {
+            double u = integralN + random.unit() * (integralX1 - integralN);
+            double x = integralInverse(u);
+            long long k = std::max(1LL, std::min(range, static_cast<long long>(x + 0.5)));
+            if (k - x <= squeeze || u >= integral(k + 0.5) - density(static_cast<double>(k)))
+                return k;
+        }
+    }
+
+private:
+    long long range;
+    double exponent;
+    double integralX1;
+    double integralN;
+    double squeeze;
+
+    // log1p(x) / x and expm1(x) / x, continuous at 0
+    static double log1pOver(double x) { return std::fabs(x) > 1e-8 ? std::log1p(x) / x : 1.0 - x / 2.0; }
+    static double expm1Over(double x) { return std::fabs(x) > 1e-8 ? std::expm1(x) / x : 1.0 + x / 2.0; }
+
+    double density(double x) const { return std::exp(-exponent * std::log(x)); }
+    double integral(double x) const
+    {
+        double logX = std::log(x);
+        return expm1Over((1.0 - exponent) * logX) * logX;
+    }
+    double integralInverse(double x) const
+    {
+        double t = std::max(-1.0, x * (1.0 - exponent));
+        return std::exp(log1pOver(t) * x);
+    }
+};
+
+/**
+ * McIlroy's adversary ("A Killer Adversary for Quicksort") against the
+ * partitioning of quickSortAll(): median of low/mid/high, Hoare partition,
+ * insertion sort at 16 elements or fewer. Replays that loop on items whose
+ * values are left undecided ("gas", above every decided value) until a
+ * comparison between two undecided items forces one of them, and then gives it
+ * the next smallest value. The pivot ends up second smallest each time. The
+ * replay leaves out Quick Sort's bad split guard, so this is the input the
+ * guard has to catch.
+ *
+ * A killer costs the replay as many comparisons as it costs the sort, so the
+ * long runs of undecided items the scans sweep over are skipped in one step,
+ * found from the ordered set of positions holding decided values.
+ */
+class Median3Adversary
+{
+public:
+    explicit Median3Adversary(int size)
+        : value(size, GAS), items(size), positionOf(size), nextValue(0), candidate(-1)
+    {
+        for (int i = 0; i < size; i++)
+            items[i] = positionOf[i] = i;
+    }
+
+    void run(int array[], int size)
+    {
+        if (size > 0)
+            sortRange(0, size - 1);
+        for (int item = 0; item < size; item++)
+        {
+            if (value[item] == GAS)
+                value[item] = nextValue++;
+            array[item] = value[item] + 1;
+        }
+    }
+
+private:
+    static constexpr int GAS = INT_MAX;
+    static constexpr int INSERTION_THRESHOLD = 16; // As in quickSortRange()
+
+    std::vector<int> value;      // By item (its position in the generated input)
+    std::vector<int> items;      // By position in the array being sorted
+    std::vector<int> positionOf; // By item
+    std::set<int> decided;       // Positions of items with a value, in ranges still being sorted
+    int nextValue;
+    int candidate;
+
+    bool isGas(int item) const { return value[item] == GAS; }
+
+    bool less(int x, int y)
+    {
+        if (isGas(x) && isGas(y))
+        {
+            int frozen = x == candidate ? x : y;
+            value[frozen] = nextValue++;
+            decided.insert(positionOf[frozen]);
+        }
+        if (isGas(x))
+            candidate = x;
+        else if (isGas(y))
+            candidate = y;
+        return value[x] < value[y];
+    }
+
+    void swapPositions(int i, int j)
+    {
+        bool iDecided = !isGas(items[i]);
+        bool jDecided = !isGas(items[j]);
+        std::swap(items[i], items[j]);
+        positionOf[items[i]] = i;
+        positionOf[items[j]] = j;
+        if (iDecided != jDecided)
+        {
+            decided.erase(iDecided ? i : j);
+            decided.insert(iDecided ? j : i);
+        }
+    }
+
+    // while (array[left] < pivot) left++;
+    int scanLeft(int left, int pivot)
+    {
+        while (less(items[left], pivot))
+            left++;
+        return left;
+    }
+
+    // while (array[right] > pivot) right--;
+    int scanRight(int right, int pivot)
+    {
+        for (;;)
+        {
+            if (!isGas(pivot) && isGas(items[right]))
+            {
+                // Every comparison down to the next decided item is true
+                auto next = decided.upper_bound(right);
+                int stop = next == decided.begin() ? -1 : *std::prev(next);
+                candidate = items[stop + 1];
+                right = stop;
+                if (right < 0)
+                    return right;
+            }
+            if (!less(pivot, items[right]))
+                return right;
+            right--;
+        }
+    }
+
+    void sortRange(int low, int high)
+    {
+        int first = low;
+        int last = high;
+        while (high - low > INSERTION_THRESHOLD)
+        {
+            int mid = low + (high - low) / 2;
+            if (less(items[mid], items[low]))
+                swapPositions(mid, low);
+            if (less(items[high], items[low]))
+                swapPositions(high, low);
+            if (less(items[high], items[mid]))
+                swapPositions(high, mid);
+            int pivot = items[mid];
+
+            int left = low;
+            int right = high;
+            while (left <= right)
+            {
+                left = scanLeft(left, pivot);
+                right = scanRight(right, pivot);
+                if (left <= right)
+                {
+                    swapPositions(left, right);
+                    left++;
+                    right--;
+                }
+            }
+
+            int smallLow = low;
+            int smallHigh = right;
+            if (right - low < high - left)
+            {
+                low = left;
+            }
+            else
+            {
+                smallLow = left;
+                smallHigh = high;
+                high = right;
+            }
+            sortRange(smallLow, smallHigh);
+        }
+
+        // Done with this range: its decided positions never take part in a scan again
+        decided.erase(decided.lower_bound(first), decided.upper_bound(last));
+    }
+};
+} // namespace
+
+void generateInput(const InputSpec &spec, int array[], int size)
+{
+    if (size <= 0)
+        return;
+
+    SeededRandom random(spec.seed);
+    long long range = spec.range > 0 ? std::min<long long>(spec.range, INT_MAX) : size;
+
+    switch (spec.distribution)
+    {
+    case DIST_SHUFFLED:
+        shuffleParallel(random, array, size);
+        break;
+
+    case DIST_UNIFORM:
+        fillParallel(size, [&](int i) {
+            array[i] = static_cast<int>(((random.at(static_cast<uint64_t>(i)) >> 32) * static_cast<uint64_t>(range)) >> 32) + 1;
+        });
+        break;
+
+    case DIST_ZIPF:
+    {
+        ZipfSampler zipf(range, spec.zipfExponent > 0 ? spec.zipfExponent : 1.0);
+        fillParallel(size, [&](int i) {
+            // Rejection takes a varying number of draws: each element gets a stream of its own
+            SeededRandom stream(random.at(static_cast<uint64_t>(i)));
+            array[i] = static_cast<int>(zipf.sample(stream));
+        });
+        break;
+    }
+
+    case DIST_SORTED_SWAPS:
+    {
+        fillParallel(size, [&](int i) { array[i] = i + 1; });
+        long long swaps = spec.swaps >= 0 ? spec.swaps : size / 100 + 1;
+        for (long long s = 0; s < swaps; s++)
+        {
+            uint64_t i = random.below(static_cast<uint64_t>(size));
+            uint64_t j = random.below(static_cast<uint64_t>(size));
+            std::swap(array[i], array[j]);
+        }
+        break;
+    }
+
+    case DIST_REVERSED_RUNS:
+    {
+        int runLength = spec.runLength > 0 ? spec.runLength : std::max(2, static_cast<int>(std::sqrt(static_cast<double>(size))));
+        fillParallel(size, [&](int i) {
+            int runStart = i - i % runLength;
+            int runEnd = std::min(size, runStart + runLength);
+            array[i] = runStart + runEnd - i; // runEnd down to runStart + 1
+        });
+        break;
+    }
+
+    case DIST_DUPLICATE_HEAVY:
+    {
+        uint64_t distinct = static_cast<uint64_t>(std::max(1, spec.distinct));
+        int spacing = static_cast<int>(INT_MAX / distinct);
+        fillParallel(size, [&](int i) {
+            array[i] = static_cast<int>(((random.at(static_cast<uint64_t>(i)) >> 32) * distinct) >> 32) * spacing + 1;
+        });
+        break;
+    }
+
+    case DIST_MEDIAN3_KILLER:
+        Median3Adversary(size).run(array, size);
+        break;
+
+    default:
+        break;
+    }
+}
+
+const char *inputDistributionName(InputDistribution distribution)
+{
+    return distribution >= 0 && distribution < DIST_COUNT ? DISTRIBUTION_NAMES[distribution] : "?";
+}
+
+bool findInputDistribution(const char *name, InputDistribution &distribution)
+{
+    for (int d = 0; d < DIST_COUNT; d++)
+    {
+        if (std::strcmp(name, DISTRIBUTION_NAMES[d]) == 0)
+        {
+            distribution = static_cast<InputDistribution>(d);
+            return true;
+        }
+    }
+    return false;
+}
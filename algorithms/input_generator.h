@@ -0,0 +1,95 @@
+#pragma once
+#include <cstdint>
+#include <limits>
+
+/**
+ * Reproducible test inputs from an explicit seed
+ *
+ * Every random value comes from SplitMix64 evaluated at a counter: the i-th
+ * output of a seed is a pure function of (seed, i), with no state carried from
+ * one element to the next. So large inputs are filled in parallel chunks, and
+ * the same seed gives the same array at any size of thread pool.
+ */
+
+/**
+ * SplitMix64 stream with random access
+ * Meets UniformRandomBitGenerator, so it also drives the std distributions
+ */
+class SeededRandom
+{
+public:
+    using result_type = uint64_t;
+
+    explicit SeededRandom(uint64_t seed) : key(seed), position(0)
+    {
+    }
+
+    /**
+     * Output number counter of this seed's stream, without running the stream
+     */
+    uint64_t at(uint64_t counter) const
+    {
+        uint64_t z = key + (counter + 1) * 0x9E3779B97F4A7C15ULL;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    uint64_t operator()() { return at(position++); }
+
+    /**
+     * Next output scaled to 0..bound-1 (bound at most 2^32)
+     */
+    uint64_t below(uint64_t bound) { return ((at(position++) >> 32) * bound) >> 32; }
+
+    /**
+     * Next output as a double in [0, 1)
+     */
+    double unit() { return (at(position++) >> 11) * (1.0 / 9007199254740992.0); }
+
+    static constexpr uint64_t min() { return 0; }
+    static constexpr uint64_t max() { return std::numeric_limits<uint64_t>::max(); }
+
+private:
+    uint64_t key;
+    uint64_t position;
+};
+
+enum InputDistribution
+{
+    DIST_SHUFFLED,        // Permutation of 1..size
+    DIST_UNIFORM,         // Independent values in 1..range
+    DIST_ZIPF,            // Rank k of 1..range with probability proportional to 1 / k^zipfExponent
+    DIST_SORTED_SWAPS,    // 1..size in order, then swaps random pairs exchanged
+    DIST_REVERSED_RUNS,   // 1..size as ascending blocks of runLength, each block descending
+    DIST_DUPLICATE_HEAVY, // distinct values spread over 1..INT_MAX
+    DIST_MEDIAN3_KILLER,  // Permutation of 1..size that makes median-of-3 Hoare partitioning pick
+                          // the second smallest element every time (quadratic without Quick
+                          // Sort's bad split guard)
+    DIST_COUNT
+};
+
+struct InputSpec
+{
+    InputDistribution distribution = DIST_SHUFFLED;
+    uint64_t seed = 1;
+    long long range = 0;       // Uniform, Zipf (0: size)
+    double zipfExponent = 1.0; // Zipf
+    long long swaps = -1;      // Sorted-with-swaps (-1: size / 100 + 1)
+    int runLength = 0;         // Reversed runs (0: sqrt(size))
+    int distinct = 16;         // Duplicate-heavy
+};
+
+/**
+ * Fill array[0..size) as spec describes
+ * Chunks are generated in parallel on the shared thread pool, except for the
+ * swaps of sorted-swaps and the median-of-3 killer, which is built by
+ * replaying Quick Sort's partitioning against it.
+ */
+void generateInput(const InputSpec &spec, int array[], int size);
+
+/**
+ * e.g. "shuffled", "zipf", "median3-killer"
+ */
+const char *inputDistributionName(InputDistribution distribution);
+bool findInputDistribution(const char *name, InputDistribution &distribution);
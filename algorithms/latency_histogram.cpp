@@ -0,0 +1,104 @@
+#include "latency_histogram.h"
+#include <cmath>
+
+namespace
+{
+int highestBit(uint64_t value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return 63 - __builtin_clzll(value);
+#else
+    int bit = 0;
+    while (value >>= 1)
+        bit++;
+    return bit;
+#endif
+}
+}
+
+LatencyHistogram::LatencyHistogram()
+{
+    clear();
+}
+
+/**
+ * Values below 2 * SUB_BUCKETS get a bucket each; above that, the top
+ * SUB_BUCKET_BITS + 1 bits of the value pick the bucket within its octave
+ */
+int LatencyHistogram::bucketOf(uint64_t value)
+{
+    if (value < static_cast<uint64_t>(2 * SUB_BUCKETS))
+        return static_cast<int>(value);
+
+    int shift = highestBit(value) - SUB_BUCKET_BITS;
+    int sub = static_cast<int>(value >> shift); // In [SUB_BUCKETS, 2 * SUB_BUCKETS)
+    return 2 * SUB_BUCKETS + (shift - 1) * SUB_BUCKETS + (sub - SUB_BUCKETS);
+}
+
+uint64_t LatencyHistogram::bucketUpperEdge(int bucket)
+{
+    if (bucket < 2 * SUB_BUCKETS)
+        return static_cast<uint64_t>(bucket);
+
+    int offset = bucket - 2 * SUB_BUCKETS;
+    int shift = offset / SUB_BUCKETS + 1;
+    uint64_t sub = static_cast<uint64_t>(offset % SUB_BUCKETS + SUB_BUCKETS);
+    return ((sub + 1) << shift) - 1; // Wraps to the largest uint64_t for the last bucket
+}
+
+void LatencyHistogram::record(uint64_t value)
+{
+    counts[bucketOf(value)].fetch_add(1, std::memory_order_relaxed);
+    total.fetch_add(1, std::memory_order_relaxed);
+    sum.fetch_add(value, std::memory_order_relaxed);
+
+    uint64_t seen = maximum.load(std::memory_order_relaxed);
+    while (value > seen && !maximum.compare_exchange_weak(seen, value, std::memory_order_relaxed))
+    {
+    }
+}
+
+void LatencyHistogram::clear()
+{
+    for (std::atomic<uint64_t> &bucket : counts)
+    {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    total.store(0, std::memory_order_relaxed);
+    sum.store(0, std::memory_order_relaxed);
+    maximum.store(0, std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::count() const
+{
+    return total.load(std::memory_order_relaxed);
+}
+
+double LatencyHistogram::mean() const
+{
+    uint64_t samples = count();
+    return samples ? static_cast<double>(sum.load(std::memory_order_relaxed)) / samples : 0.0;
+}
+
+uint64_t LatencyHistogram::percentile(double percent) const
+{
+    uint64_t samples = count();
+    if (samples == 0)
+        return 0;
+
+    uint64_t target = static_cast<uint64_t>(std::ceil(percent / 100.0 * samples));
+    if (target == 0)
+        target = 1;
+
+    uint64_t seen = 0;
+    for (int bucket = 0; bucket < BUCKET_COUNT; bucket++)
+    {
+        seen += counts[bucket].load(std::memory_order_relaxed);
+        if (seen >= target)
+        {
+            uint64_t edge = bucketUpperEdge(bucket);
+            return edge < maxValue() ? edge : maxValue();
+        }
+    }
+    return maxValue();
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+/**
+ * Log-linear histogram of latencies (or any non-negative integer samples)
+ *
+ * Like an HDR histogram: every power-of-two range is split into 64 equal
+ * buckets, so a reported percentile is within 1/64 (~1.6%) of the true value
+ * whatever the magnitude, from nanoseconds to hours, in a fixed 30 KB table.
+ * record() is a couple of shifts and one relaxed atomic add, so any number of
+ * threads can record into the same histogram without locking.
+ */
+class LatencyHistogram
+{
+public:
+    LatencyHistogram();
+
+    void record(uint64_t value);
+    void clear();
+
+    uint64_t count() const;
+    uint64_t maxValue() const { return maximum.load(std::memory_order_relaxed); }
+    double mean() const;
+
+    /**
+     * Smallest value that at least percent% of the samples are not above
+     * (upper edge of its bucket, capped at the largest sample; 0 if empty)
+     */
+    uint64_t percentile(double percent) const;
+
+private:
+    static const int SUB_BUCKET_BITS = 6;
+    static const int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;           // Per power of two
+    static const int BUCKET_COUNT = 2 * SUB_BUCKETS + 57 * SUB_BUCKETS; // Covers all of uint64_t
+
+    std::atomic<uint64_t> counts[BUCKET_COUNT];
+    std::atomic<uint64_t> total;
+    std::atomic<uint64_t> sum;
+    std::atomic<uint64_t> maximum;
+
+    static int bucketOf(uint64_t value);
+    static uint64_t bucketUpperEdge(int bucket);
+
+    LatencyHistogram(const LatencyHistogram &) = delete;
+    LatencyHistogram &operator=(const LatencyHistogram &) = delete;
+};
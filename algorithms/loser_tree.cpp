@@ -0,0 +1,59 @@
+#include "loser_tree.h"
+
+LoserTree::LoserTree(int sources)
+    : leafCount(1), losers(nullptr), leaves(), winner(SENTINEL)
+{
+    while (leafCount < sources)
+    {
+        leafCount *= 2;
+    }
+
+    lines.resize((leafCount + 7) / 8);
+    losers = lines[0].nodes;
+    leaves.assign(leafCount, SENTINEL);
+}
+
+void LoserTree::build()
+{
+    // Play the matches bottom-up: winners[node] is the winner of that subtree
+    std::vector<uint64_t> winners(2 * leafCount);
+    for (int i = 0; i < leafCount; i++)
+    {
+        winners[leafCount + i] = leaves[i];
+    }
+
+    for (int node = leafCount - 1; node > 0; node--)
+    {
+        uint64_t left = winners[2 * node];
+        uint64_t right = winners[2 * node + 1];
+        winners[node] = left < right ? left : right;
+        losers[node] = left < right ? right : left;
+    }
+    winner = winners[1];
+}
+
+void multiwayMerge(const int *const runBegins[], const int *const runEnds[], int runs, int output[])
+{
+    std::vector<const int *> cursors(runBegins, runBegins + runs);
+    LoserTree tree(runs);
+
+    for (int run = 0; run < runs; run++)
+    {
+        if (cursors[run] != runEnds[run])
+            tree.setSource(run, *cursors[run]);
+        else
+            tree.setSourceEmpty(run);
+    }
+    tree.build();
+
+    while (!tree.empty())
+    {
+        *output++ = tree.topKey();
+
+        int source = tree.topSource();
+        if (++cursors[source] != runEnds[source])
+            tree.replaceTop(*cursors[source]);
+        else
+            tree.removeTop();
+    }
+}
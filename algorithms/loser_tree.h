@@ -0,0 +1,76 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+/**
+ * Loser tree (tournament tree) for merging k sorted int runs
+ *
+ * Inner nodes keep the loser of their match, so replacing the winner only
+ * replays the log2(k) matches on its path to the root. Each node is a single
+ * 64-bit word holding the key (sign-flipped, in the high half) and its source
+ * index (low half): one unsigned compare orders by key and breaks ties by the
+ * lower source, which keeps merges stable. An exhausted source is represented
+ * by an all-ones sentinel that loses every match, so no bounds checks are
+ * needed while merging. Nodes are packed eight to a 64-byte cache line.
+ *
+ * Usage: setSource()/setSourceEmpty() for every source, build(), then loop
+ * while !empty(): consume topKey(), and call replaceTop() with the next key
+ * from topSource() or removeTop() if that source has run out.
+ */
+class LoserTree
+{
+public:
+    explicit LoserTree(int sources);
+
+    void setSource(int source, int key) { leaves[source] = encode(key, source); }
+    void setSourceEmpty(int source) { leaves[source] = SENTINEL; }
+    void build();
+
+    bool empty() const { return winner == SENTINEL; }
+    int topKey() const { return static_cast<int>(static_cast<uint32_t>(winner >> 32) ^ 0x80000000u); }
+    int topSource() const { return static_cast<int>(static_cast<uint32_t>(winner)); }
+
+    void replaceTop(int key) { replay(encode(key, topSource())); }
+    void removeTop() { replay(SENTINEL); }
+
+private:
+    static constexpr uint64_t SENTINEL = ~0ULL;
+
+    struct alignas(64) CacheLine
+    {
+        uint64_t nodes[8];
+    };
+
+    int leafCount;                // Sources rounded up to a power of two
+    std::vector<CacheLine> lines; // Inner nodes 1..leafCount-1
+    uint64_t *losers;
+    std::vector<uint64_t> leaves; // Initial key of each source, only used by build()
+    uint64_t winner;
+
+    static uint64_t encode(int key, int source)
+    {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(key) ^ 0x80000000u) << 32) |
+               static_cast<uint32_t>(source);
+    }
+
+    void replay(uint64_t candidate)
+    {
+        // The path is fixed by the source that just won; padding sources never win
+        for (int node = (leafCount + topSource()) >> 1; node > 0; node >>= 1)
+        {
+            uint64_t loser = losers[node];
+            losers[node] = loser > candidate ? loser : candidate;
+            candidate = loser > candidate ? candidate : loser;
+        }
+        winner = candidate;
+    }
+};
+
+/**
+ * Merge k sorted runs into output with a loser tree
+ * Equal keys are taken from the lower-numbered run first (stable)
+ * @param runBegins / runEnds: Bounds of each run
+ * @param runs: Number of runs
+ * @param output: Must have room for the total length of all runs
+ */
+void multiwayMerge(const int *const runBegins[], const int *const runEnds[], int runs, int output[]);
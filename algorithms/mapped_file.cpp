@@ -0,0 +1,153 @@
+#include "mapped_file.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cstring>
+#include <cerrno>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile()
+    : mapping(nullptr), length(0), fileHandle(INVALID_HANDLE_VALUE), mappingHandle(nullptr)
+{
+}
+
+bool MappedFile::open(const std::string &path, std::string &error)
+{
+    close();
+
+    fileHandle = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, OPEN_EXISTING,
+                             FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (fileHandle == INVALID_HANDLE_VALUE)
+    {
+        error = "cannot open " + path;
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(fileHandle, &fileSize))
+    {
+        error = "cannot stat " + path;
+        close();
+        return false;
+    }
+    length = static_cast<size_t>(fileSize.QuadPart);
+    if (length == 0)
+        return true;
+
+    mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READWRITE, 0, 0, nullptr);
+    if (mappingHandle)
+        mapping = MapViewOfFile(mappingHandle, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+    if (!mapping)
+    {
+        error = "cannot map " + path;
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool MappedFile::close()
+{
+    bool ok = true;
+    if (mapping)
+    {
+        ok = FlushViewOfFile(mapping, 0) != 0;
+        UnmapViewOfFile(mapping);
+        mapping = nullptr;
+    }
+    if (mappingHandle)
+    {
+        CloseHandle(mappingHandle);
+        mappingHandle = nullptr;
+    }
+    if (fileHandle != INVALID_HANDLE_VALUE)
+    {
+        ok = FlushFileBuffers(fileHandle) != 0 && ok;
+        CloseHandle(fileHandle);
+        fileHandle = INVALID_HANDLE_VALUE;
+    }
+    length = 0;
+    return ok;
+}
+
+#else
+
+MappedFile::MappedFile()
+    : mapping(nullptr), length(0), fileDescriptor(-1)
+{
+}
+
+bool MappedFile::open(const std::string &path, std::string &error)
+{
+    close();
+
+    fileDescriptor = ::open(path.c_str(), O_RDWR);
+    if (fileDescriptor < 0)
+    {
+        error = "cannot open " + path + ": " + std::strerror(errno);
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fileDescriptor, &info) != 0)
+    {
+        error = "cannot stat " + path + ": " + std::strerror(errno);
+        close();
+        return false;
+    }
+    length = static_cast<size_t>(info.st_size);
+    if (length == 0)
+        return true;
+
+    int flags = MAP_SHARED;
+#ifdef MAP_POPULATE
+    flags |= MAP_POPULATE; // Fault every page in now rather than one at a time during the sort
+#endif
+    void *address = mmap(nullptr, length, PROT_READ | PROT_WRITE, flags, fileDescriptor, 0);
+    if (address == MAP_FAILED)
+    {
+        error = "cannot map " + path + ": " + std::strerror(errno);
+        close();
+        return false;
+    }
+    mapping = address;
+
+    // Both are hints; failure only costs performance
+    madvise(mapping, length, MADV_SEQUENTIAL);
+#ifdef MADV_HUGEPAGE
+    madvise(mapping, length, MADV_HUGEPAGE);
+#endif
+    return true;
+}
+
+bool MappedFile::close()
+{
+    bool ok = true;
+    if (mapping)
+    {
+        ok = msync(mapping, length, MS_SYNC) == 0;
+        munmap(mapping, length);
+        mapping = nullptr;
+    }
+    if (fileDescriptor >= 0)
+    {
+        ok = ::close(fileDescriptor) == 0 && ok;
+        fileDescriptor = -1;
+    }
+    length = 0;
+    return ok;
+}
+
+#endif
+
+MappedFile::~MappedFile()
+{
+    close();
+}
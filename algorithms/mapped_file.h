@@ -0,0 +1,45 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+/**
+ * Read-write memory mapping of a whole file
+ * Sorting through the mapping writes the result straight back to the file,
+ * without reading it into a buffer and writing it out again
+ */
+class MappedFile
+{
+public:
+    MappedFile();
+    ~MappedFile();
+
+    /**
+     * Map path for reading and writing
+     * Pages are populated up front and the kernel is told access is sequential;
+     * transparent hugepages are requested where the platform supports them
+     * @return: false on failure, with a description in error
+     */
+    bool open(const std::string &path, std::string &error);
+
+    /**
+     * Write dirty pages back to the file and unmap it
+     * @return: false if the data could not be flushed
+     */
+    bool close();
+
+    void *data() const { return mapping; }
+    size_t size() const { return length; }
+
+private:
+    void *mapping;
+    size_t length;
+#ifdef _WIN32
+    void *fileHandle;
+    void *mappingHandle;
+#else
+    int fileDescriptor;
+#endif
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+};
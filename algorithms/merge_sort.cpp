@@ -1,5 +1,9 @@
 #include "algorithm_interface.h"
 #include "algorithm_registry.h"
+#include "arena.h"
+#include "loser_tree.h"
+#include "thread_pool.h"
+#include "trace.h"
 #include <algorithm>
 
 /**
@@ -112,4 +116,78 @@ SwapResult mergeSort(int array[], int size, int *state)
     }
 
     return result;
-}
\ No newline at end of file
+}
+
+/**
+ * Merge Sort - whole array in one call
+ * Insertion-sorts short runs, then merges MERGE_FAN_IN runs at a time with a
+ * loser tree, bouncing between the array and one scratch buffer. Compared to
+ * pairwise merging this makes log_k instead of log_2 passes over memory.
+ * Runs and independent merge groups are spread over the shared thread pool.
+ * Stable: ties are taken from the leftmost run.
+ */
+void mergeSortAll(int array[], int size, Arena &scratch)
+{
+    const int RUN_LENGTH = 32;
+    const int MERGE_FAN_IN = 8;
+    const long long PARALLEL_GRAIN = 1 << 16; // Elements per pool task
+
+    if (size < 2)
+        return;
+
+    TRACE_SCOPE("merge sort");
+    long long runCount = (size + RUN_LENGTH - 1) / RUN_LENGTH;
+    parallelFor(0, runCount, PARALLEL_GRAIN / RUN_LENGTH, [array, size](long long firstRun, long long lastRun) {
+        TRACE_SCOPE("merge sort runs");
+        for (long long run = firstRun; run < lastRun; run++)
+        {
+            int start = static_cast<int>(run * RUN_LENGTH);
+            int end = std::min(start + RUN_LENGTH, size);
+            for (int i = start + 1; i < end; i++)
+            {
+                int temp = array[i];
+                int j = i;
+                while (j > start && array[j - 1] > temp)
+                {
+                    array[j] = array[j - 1];
+                    j--;
+                }
+                array[j] = temp;
+            }
+        }
+    });
+
+    int *from = array;
+    int *to = scratch.allocateArray<int>(size);
+
+    for (long long width = RUN_LENGTH; width < size; width *= MERGE_FAN_IN)
+    {
+        // Groups of MERGE_FAN_IN runs merge independently
+        long long groupWidth = width * MERGE_FAN_IN;
+        long long groups = (size + groupWidth - 1) / groupWidth;
+        TRACE_SCOPE("merge sort pass");
+        parallelFor(0, groups, PARALLEL_GRAIN / groupWidth, [=](long long firstGroup, long long lastGroup) {
+            TRACE_SCOPE("merge sort merge");
+            const int *runBegins[MERGE_FAN_IN];
+            const int *runEnds[MERGE_FAN_IN];
+            for (long long group = firstGroup; group < lastGroup; group++)
+            {
+                long long left = group * groupWidth;
+                int runs = 0;
+                for (long long start = left; start < size && runs < MERGE_FAN_IN; start += width)
+                {
+                    runBegins[runs] = from + start;
+                    runEnds[runs] = from + std::min(start + width, static_cast<long long>(size));
+                    runs++;
+                }
+                multiwayMerge(runBegins, runEnds, runs, to + left);
+            }
+        });
+        std::swap(from, to);
+    }
+
+    if (from != array)
+    {
+        std::copy(from, from + size, array);
+    }
+}
@@ -1,129 +1,416 @@
 #include "algorithm_interface.h"
 #include "algorithm_registry.h"
+#include "heap_sort.h"
+#include "input_generator.h"
+#include "quick_sort.h"
+#include "thread_pool.h"
+#include "trace.h"
+#include <atomic>
+#include <utility>
 
 /**
- * Quick Sort Algorithm - Working Implementation
- * Uses divide-and-conquer strategy with pivot selection and partitioning
+ * Guard against adversarial input (both paths)
+ * A partition whose smaller side holds less than an eighth of the range is a
+ * bad split. The range after a bad split takes its pivot from a random place,
+ * which gets sorted input, organ pipes and median-of-3 killers out of the
+ * worst case at once. More than log2(size) bad splits on one path means the
+ * O(n log n) budget is spent, and that range is heap sorted instead. Each
+ * intervention bumps a running total (quickSortGuardCounts()), which is also
+ * sampled to the trace as a counter.
+ */
+static std::atomic<long long> pivotShuffles(0);
+static std::atomic<long long> heapFallbacks(0);
+
+static void countGuard(std::atomic<long long> &total, const char *counterName)
+{
+    long long count = total.fetch_add(1, std::memory_order_relaxed) + 1;
+    TRACE_COUNTER(counterName, count);
+}
+
+QuickSortGuardCounts quickSortGuardCounts()
+{
+    return {pivotShuffles.load(std::memory_order_relaxed), heapFallbacks.load(std::memory_order_relaxed)};
+}
+
+static int badSplitLimit(int size)
+{
+    int limit = 0;
+    while (size > 1)
+    {
+        size /= 2;
+        limit++;
+    }
+    return limit;
+}
+
+static bool isBadSplit(int smaller, int rangeSize)
+{
+    return smaller < rangeSize / 8;
+}
+
+/**
+ * Random index in low..high, the same every time for the same range
+ */
+static int randomIndex(int low, int high, uint64_t draw)
+{
+    SeededRandom random((static_cast<uint64_t>(low) << 32) | static_cast<uint32_t>(high));
+    return low + static_cast<int>(random.at(draw) % static_cast<uint64_t>(high - low + 1));
+}
+
+/**
+ * Quick Sort Algorithm
+ * Uses divide-and-conquer strategy with pivot selection and partitioning.
+ * Recursion is emulated with an explicit stack of ranges still to sort; the
+ * smaller side is always sorted first, so the stack never holds more than
+ * log2(size) + 2 ranges. After a bad split the pivot is first swapped in
+ * from a random place; a range past the bad split limit is heap sorted in
+ * place, one sift swap per step.
  *
- * State variables:
- * state[0] = current partition start
- * state[1] = current partition end
- * state[2] = pivot index
- * state[3] = left pointer
- * state[4] = right pointer
- * state[5] = phase (0=select pivot, 1=partition, 2=place pivot)
- * state[6] = step counter
- * state[7] = max steps
+ * State (QuickSortState, followed by the range stack):
+ * start/end = partition being worked on
+ * pivotIdx = pivot index
+ * left/right = partition pointers
+ * phase = 0=take next range, 1=partition, 2=push the two sides, 3=heap sort the range
+ * stackTop = number of ranges on the stack
+ * badSplits = bad splits on the way down to this range
+ * heapSize/heapNext/sift = heap fallback: heap size, next node to build (-1 when
+ *                          built), node being sifted down (-1 when not sifting)
  */
-SwapResult quickSort(int array[], int size, int *state)
+struct QuickSortRange
+{
+    int low;
+    int high;
+    int badSplits;
+    bool shufflePivot; // Made by a bad split
+};
+
+struct QuickSortState
+{
+    int start;
+    int end;
+    int pivotIdx;
+    int left;
+    int right;
+    int phase;
+    int stackTop;
+    int badSplits;
+    int heapSize;
+    int heapNext;
+    int sift;
+};
+
+static int quickSortStackCapacity(int size)
+{
+    return badSplitLimit(size) + 2;
+}
+
+static QuickSortRange *quickSortStack(QuickSortState &s)
+{
+    return reinterpret_cast<QuickSortRange *>(&s + 1);
+}
+
+static size_t quickSortStateBytes(int size)
 {
-    int &start = state[0];
-    int &end = state[1];
-    int &pivotIdx = state[2];
-    int &left = state[3];
-    int &right = state[4];
-    int &phase = state[5];
-    int &step = state[6];
-    int &maxSteps = state[7];
+    return sizeof(QuickSortState) + quickSortStackCapacity(size) * sizeof(QuickSortRange);
+}
 
+static void quickSortStateInit(void *state, int size)
+{
+    QuickSortState &s = *static_cast<QuickSortState *>(state);
+    if (size > 1)
+    {
+        quickSortStack(s)[0] = {0, size - 1, 0, false};
+        s.stackTop = 1;
+    }
+}
+
+extern const StateType quickSortState = {quickSortStateBytes, quickSortStateInit, nullptr};
+
+/**
+ * One step of the heap fallback on array[start..end]: at most one swap
+ */
+static SwapResult quickSortHeapStep(int array[], QuickSortState &s)
+{
+    int *heap = array + s.start;
     SwapResult result = {-1, -1, false, false};
 
-    // Initialize on first call
-    if (step == 0 && phase == 0)
+    if (s.sift < 0)
     {
-        start = 0;
-        end = size - 1;
-        step = 1;
-        maxSteps = size * 4; // Conservative limit
+        if (s.heapNext >= 0)
+        {
+            s.sift = s.heapNext--;
+        }
+        else if (s.heapSize > 1)
+        {
+            s.heapSize--;
+            std::swap(heap[0], heap[s.heapSize]);
+            result.index1 = s.start;
+            result.index2 = s.start + s.heapSize;
+            result.swapped = true;
+            s.sift = 0;
+            return result;
+        }
+        else
+        {
+            s.phase = 0;
+            return result;
+        }
     }
 
-    // Check if sorting is complete
-    if (step > maxSteps)
+    int largest = s.sift;
+    int child = 2 * s.sift + 1;
+    if (child < s.heapSize && heap[child] > heap[largest])
+        largest = child;
+    if (child + 1 < s.heapSize && heap[child + 1] > heap[largest])
+        largest = child + 1;
+
+    if (largest == s.sift)
     {
-        result.isComplete = true;
+        s.sift = -1;
         return result;
     }
 
+    std::swap(heap[s.sift], heap[largest]);
+    result.index1 = s.start + s.sift;
+    result.index2 = s.start + largest;
+    result.swapped = true;
+    s.sift = largest;
+    return result;
+}
+
+SwapResult quickSort(int array[], int size, int *state)
+{
+    QuickSortState &s = typedState<QuickSortState>(state);
+    QuickSortRange *stack = quickSortStack(s);
+
+    SwapResult result = {-1, -1, false, false};
+
     // Handle different phases
-    switch (phase)
+    switch (s.phase)
     {
-    case 0: // Select pivot (first element)
-        pivotIdx = start;
-        left = start + 1;
-        right = end;
-        phase = 1;
+    case 0: // Take the next range; its first element is the pivot
+        {
+            if (s.stackTop == 0)
+            {
+                result.isComplete = true;
+                return result;
+            }
+            s.stackTop--;
+            QuickSortRange range = stack[s.stackTop];
+            s.start = range.low;
+            s.end = range.high;
+            s.badSplits = range.badSplits;
+
+            if (s.badSplits > badSplitLimit(size))
+            {
+                countGuard(heapFallbacks, "quick sort heap fallbacks");
+                s.heapSize = s.end - s.start + 1;
+                s.heapNext = s.heapSize / 2 - 1;
+                s.sift = -1;
+                s.phase = 3;
+                break;
+            }
+
+            s.pivotIdx = s.start;
+            s.left = s.start + 1;
+            s.right = s.end;
+            s.phase = 1;
+
+            if (range.shufflePivot)
+            {
+                countGuard(pivotShuffles, "quick sort pivot shuffles");
+                int pick = randomIndex(s.start, s.end, 0);
+                if (pick != s.start)
+                {
+                    std::swap(array[s.start], array[pick]);
+                    result.index1 = s.start;
+                    result.index2 = pick;
+                    result.swapped = true;
+                }
+            }
+        }
         break;
 
     case 1: // Partition phase
-        if (left > right)
+        if (s.left > s.right)
         {
             // Partition complete, place pivot
-            if (right != pivotIdx)
+            if (s.right != s.pivotIdx)
             {
-                int temp = array[pivotIdx];
-                array[pivotIdx] = array[right];
-                array[right] = temp;
-                result.index1 = pivotIdx;
-                result.index2 = right;
+                int temp = array[s.pivotIdx];
+                array[s.pivotIdx] = array[s.right];
+                array[s.right] = temp;
+                result.index1 = s.pivotIdx;
+                result.index2 = s.right;
                 result.swapped = true;
             }
-            pivotIdx = right;
-            phase = 2;
+            s.pivotIdx = s.right;
+            s.phase = 2;
         }
-        else if (array[left] <= array[pivotIdx] && array[right] > array[pivotIdx])
+        else if (array[s.left] <= array[s.pivotIdx] && array[s.right] > array[s.pivotIdx])
         {
-            left++;
-            right--;
+            s.left++;
+            s.right--;
         }
-        else if (array[left] > array[pivotIdx] && array[right] <= array[pivotIdx])
+        else if (array[s.left] > array[s.pivotIdx] && array[s.right] <= array[s.pivotIdx])
         {
             // Swap left and right
-            int temp = array[left];
-            array[left] = array[right];
-            array[right] = temp;
-            result.index1 = left;
-            result.index2 = right;
+            int temp = array[s.left];
+            array[s.left] = array[s.right];
+            array[s.right] = temp;
+            result.index1 = s.left;
+            result.index2 = s.right;
             result.swapped = true;
-            left++;
-            right--;
+            s.left++;
+            s.right--;
         }
-        else if (array[left] <= array[pivotIdx])
+        else if (array[s.left] <= array[s.pivotIdx])
         {
-            left++;
+            s.left++;
         }
         else
         {
-            right--;
+            s.right--;
+        }
+        break;
+
+    case 2: // Push both sides, the larger first so the smaller is sorted next
+        {
+            QuickSortRange leftSide = {s.start, s.pivotIdx - 1, s.badSplits, false};
+            QuickSortRange rightSide = {s.pivotIdx + 1, s.end, s.badSplits, false};
+            if (leftSide.high - leftSide.low > rightSide.high - rightSide.low)
+                std::swap(leftSide, rightSide);
+
+            if (isBadSplit(leftSide.high - leftSide.low + 1, s.end - s.start + 1))
+            {
+                leftSide.badSplits = rightSide.badSplits = s.badSplits + 1;
+                leftSide.shufflePivot = rightSide.shufflePivot = true;
+            }
+
+            if (rightSide.low < rightSide.high)
+                stack[s.stackTop++] = rightSide;
+            if (leftSide.low < leftSide.high)
+                stack[s.stackTop++] = leftSide;
+            s.phase = 0;
         }
         break;
 
-    case 2: // Handle sub-partitions
-        // For step-by-step visualization, we'll just continue with the next partition
-        // This is a simplified approach that ensures the algorithm completes
-        if (start < pivotIdx - 1)
+    case 3: // Heap fallback
+        return quickSortHeapStep(array, s);
+    }
+
+    return result;
+}
+
+/**
+ * Sort array[low..high] (inclusive) with insertion sort
+ */
+static void insertionSortRange(int array[], int low, int high)
+{
+    for (int i = low + 1; i <= high; i++)
+    {
+        int temp = array[i];
+        int j = i;
+        while (j > low && array[j - 1] > temp)
+        {
+            array[j] = array[j - 1];
+            j--;
+        }
+        array[j] = temp;
+    }
+}
+
+/**
+ * Quick sort array[low..high] (inclusive)
+ * Median-of-three pivot, Hoare partition, recursion only into the smaller side
+ * With a task group, smaller sides that are big enough become pool tasks
+ * @param badSplitsLeft: Bad splits allowed before the range is heap sorted
+ * @param shufflePivot: The range came from a bad split; draw the median-of-three
+ *                      candidates from random places
+ */
+static void quickSortRange(int array[], int low, int high, int badSplitsLeft, bool shufflePivot, TaskGroup *group)
+{
+    const int INSERTION_THRESHOLD = 16;
+    const int PARALLEL_THRESHOLD = 1 << 15;
+
+    while (high - low > INSERTION_THRESHOLD)
+    {
+        if (badSplitsLeft < 0)
+        {
+            countGuard(heapFallbacks, "quick sort heap fallbacks");
+            heapSortTextbook(array + low, high - low + 1);
+            return;
+        }
+
+        int mid = low + (high - low) / 2;
+        if (shufflePivot)
+        {
+            countGuard(pivotShuffles, "quick sort pivot shuffles");
+            std::swap(array[low], array[randomIndex(low, high, 0)]);
+            std::swap(array[mid], array[randomIndex(low, high, 1)]);
+            std::swap(array[high], array[randomIndex(low, high, 2)]);
+        }
+        if (array[mid] < array[low])
+            std::swap(array[mid], array[low]);
+        if (array[high] < array[low])
+            std::swap(array[high], array[low]);
+        if (array[high] < array[mid])
+            std::swap(array[high], array[mid]);
+        int pivot = array[mid];
+
+        int left = low;
+        int right = high;
+        while (left <= right)
         {
-            // Sort left partition
-            start = start;
-            end = pivotIdx - 1;
-            phase = 0;
+            while (array[left] < pivot)
+                left++;
+            while (array[right] > pivot)
+                right--;
+            if (left <= right)
+            {
+                std::swap(array[left], array[right]);
+                left++;
+                right--;
+            }
         }
-        else if (pivotIdx + 1 < end)
+
+        int rangeSize = high - low + 1;
+        int smallLow = low;
+        int smallHigh = right;
+        if (right - low < high - left)
         {
-            // Sort right partition
-            start = pivotIdx + 1;
-            end = end;
-            phase = 0;
+            low = left;
         }
         else
         {
-            // Both partitions done, restart with whole array
-            start = 0;
-            end = size - 1;
-            phase = 0;
+            smallLow = left;
+            smallHigh = high;
+            high = right;
         }
-        step++;
-        break;
+
+        shufflePivot = isBadSplit(smallHigh - smallLow + 1, rangeSize);
+        if (shufflePivot)
+            badSplitsLeft--;
+
+        if (group && smallHigh - smallLow >= PARALLEL_THRESHOLD)
+            group->run([array, smallLow, smallHigh, badSplitsLeft, shufflePivot, group]() {
+                TRACE_SCOPE("quick sort partition task");
+                quickSortRange(array, smallLow, smallHigh, badSplitsLeft, shufflePivot, group);
+            });
+        else
+            quickSortRange(array, smallLow, smallHigh, badSplitsLeft, shufflePivot, group);
     }
 
-    return result;
-} 
\ No newline at end of file
+    insertionSortRange(array, low, high);
+}
+
+/**
+ * Quick Sort - whole array in one call
+ */
+void quickSortAll(int array[], int size, Arena &)
+{
+    TRACE_SCOPE("quick sort");
+    TaskGroup group;
+    quickSortRange(array, 0, size - 1, badSplitLimit(size), false, &group);
+    group.wait();
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+/**
+ * Running totals of Quick Sort's bad split guard, over both the step and the
+ * whole-array paths and every thread, since the process started
+ */
+struct QuickSortGuardCounts
+{
+    long long pivotShuffles; // Ranges after a bad split that took a random pivot
+    long long heapFallbacks; // Ranges heap sorted once their bad split budget was spent
+};
+
+QuickSortGuardCounts quickSortGuardCounts();
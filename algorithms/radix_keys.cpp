@@ -0,0 +1,166 @@
+#include "radix_keys.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <vector>
+
+// Above this many keys the LSD buffer (a second copy of the input) is not
+// worth it; a memory-mapped file sorts in place instead
+static const size_t IN_PLACE_THRESHOLD = 1 << 20;
+static const size_t FLAG_SORT_SMALL = 128;        // Buckets this small go to std::sort
+static const size_t FLAG_SORT_PARALLEL = 1 << 16; // Buckets of larger ranges go to the pool
+
+/**
+ * In-place MSD radix sort (American flag sort) of keys on the byte at shift
+ * and every byte below it: count the byte's buckets, cycle each key into its
+ * bucket's next free slot, then sort each bucket on the next byte down
+ */
+template <typename Key>
+static void americanFlagSort(Key keys[], size_t size, int shift)
+{
+    size_t counts[256];
+    for (;;)
+    {
+        if (size <= FLAG_SORT_SMALL)
+        {
+            std::sort(keys, keys + size);
+            return;
+        }
+
+        std::fill(counts, counts + 256, 0);
+        for (size_t i = 0; i < size; i++)
+        {
+            counts[(keys[i] >> shift) & 0xFF]++;
+        }
+
+        if (counts[(keys[0] >> shift) & 0xFF] != size)
+            break;
+
+        // Every key shares this byte: nothing to move, go on to the next
+        if (shift == 0)
+            return;
+        shift -= 8;
+    }
+
+    size_t heads[256];
+    size_t tails[256];
+    size_t offset = 0;
+    for (int bucket = 0; bucket < 256; bucket++)
+    {
+        heads[bucket] = offset;
+        offset += counts[bucket];
+        tails[bucket] = offset;
+    }
+
+    for (int bucket = 0; bucket < 256; bucket++)
+    {
+        while (heads[bucket] < tails[bucket])
+        {
+            Key key = keys[heads[bucket]];
+            int digit = static_cast<int>((key >> shift) & 0xFF);
+            while (digit != bucket)
+            {
+                std::swap(key, keys[heads[digit]++]);
+                digit = static_cast<int>((key >> shift) & 0xFF);
+            }
+            keys[heads[bucket]++] = key;
+        }
+    }
+
+    if (shift == 0)
+        return;
+
+    auto sortBuckets = [&](long long first, long long last) {
+        for (long long bucket = first; bucket < last; bucket++)
+        {
+            size_t begin = tails[bucket] - counts[bucket];
+            americanFlagSort(keys + begin, counts[bucket], shift - 8);
+        }
+    };
+    if (size >= FLAG_SORT_PARALLEL)
+        parallelFor(0, 256, 1, sortBuckets);
+    else
+        sortBuckets(0, 256);
+}
+
+/**
+ * LSD radix sort of unsigned keys, one byte per pass, or American flag sort
+ * for inputs too large to double
+ */
+template <typename Key>
+static void radixSortUnsigned(Key keys[], size_t size)
+{
+    const int DIGITS = sizeof(Key);
+    if (size < 2)
+        return;
+
+    if (size > IN_PLACE_THRESHOLD)
+    {
+        americanFlagSort(keys, size, 8 * (DIGITS - 1));
+        return;
+    }
+
+    // One counting pass builds every histogram
+    std::vector<size_t> counts(DIGITS * 256, 0);
+    for (size_t i = 0; i < size; i++)
+    {
+        Key key = keys[i];
+        for (int digit = 0; digit < DIGITS; digit++)
+        {
+            counts[digit * 256 + ((key >> (8 * digit)) & 0xFF)]++;
+        }
+    }
+
+    std::vector<Key> buffer(size);
+    Key *from = keys;
+    Key *to = buffer.data();
+
+    for (int digit = 0; digit < DIGITS; digit++)
+    {
+        size_t *offsets = &counts[digit * 256];
+        int shift = 8 * digit;
+
+        if (offsets[(from[0] >> shift) & 0xFF] == size)
+            continue;
+
+        size_t offset = 0;
+        for (int bucket = 0; bucket < 256; bucket++)
+        {
+            size_t count = offsets[bucket];
+            offsets[bucket] = offset;
+            offset += count;
+        }
+
+        for (size_t i = 0; i < size; i++)
+        {
+            to[offsets[(from[i] >> shift) & 0xFF]++] = from[i];
+        }
+        std::swap(from, to);
+    }
+
+    if (from != keys)
+    {
+        std::copy(from, from + size, keys);
+    }
+}
+
+void radixSortKeys64(uint64_t keys[], size_t size)
+{
+    radixSortUnsigned(keys, size);
+}
+
+void radixSortKeys32(uint32_t keys[], size_t size)
+{
+    radixSortUnsigned(keys, size);
+}
+
+void radixSortInt64(int64_t values[], size_t size)
+{
+    const uint64_t SIGN_BIT = 0x8000000000000000ULL;
+    uint64_t *keys = reinterpret_cast<uint64_t *>(values);
+
+    for (size_t i = 0; i < size; i++)
+        keys[i] ^= SIGN_BIT;
+    radixSortKeys64(keys, size);
+    for (size_t i = 0; i < size; i++)
+        keys[i] ^= SIGN_BIT;
+}
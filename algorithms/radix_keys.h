@@ -0,0 +1,53 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Radix sort over wide keys, for data the int-based registered algorithms
+ * cannot hold (64-bit integers, and anything that maps to ordered 64-bit keys)
+ */
+
+/**
+ * LSD radix sort of unsigned 64-bit keys, 8 bits per pass
+ * Passes where every key shares the digit are skipped. The passes need a
+ * buffer as large as the input, so above 2^20 keys the sort runs in place
+ * instead: MSD radix (American flag sort) from the top byte down, with the
+ * buckets sorted in parallel. Memory-mapped files need no second copy.
+ */
+void radixSortKeys64(uint64_t keys[], size_t size);
+
+/**
+ * The same passes over unsigned 32-bit keys
+ */
+void radixSortKeys32(uint32_t keys[], size_t size);
+
+/**
+ * Sort signed 64-bit integers (sign bit flipped around radixSortKeys64)
+ */
+void radixSortInt64(int64_t values[], size_t size);
+
+/**
+ * IEEE-754 bits to unsigned keys in numeric order, and back
+ * Positive numbers get their sign bit set, negative ones have every bit
+ * flipped. That is IEEE 754 totalOrder: -0.0 just before +0.0, negative NaNs
+ * below -inf and positive NaNs above +inf.
+ */
+inline uint32_t floatBitsToKey(uint32_t bits)
+{
+    return bits ^ (static_cast<uint32_t>(-static_cast<int32_t>(bits >> 31)) | 0x80000000u);
+}
+
+inline uint32_t keyToFloatBits(uint32_t key)
+{
+    return key ^ (((key >> 31) - 1) | 0x80000000u);
+}
+
+inline uint64_t doubleBitsToKey(uint64_t bits)
+{
+    return bits ^ (static_cast<uint64_t>(-static_cast<int64_t>(bits >> 63)) | 0x8000000000000000ULL);
+}
+
+inline uint64_t keyToDoubleBits(uint64_t key)
+{
+    return key ^ (((key >> 63) - 1) | 0x8000000000000000ULL);
+}
@@ -1,120 +1,218 @@
 #include "algorithm_interface.h"
 #include "algorithm_registry.h"
-#include <cmath>
+#include "arena.h"
+#include "counting_sort.h"
+#include <algorithm>
+#include <cstdint>
 
 /**
  * Radix Sort Algorithm (LSD - Least Significant Digit)
  * Sorts by processing digits from least to most significant
  *
- * State variables:
- * state[0] = current digit position (0=ones, 1=tens, 2=hundreds, etc.)
- * state[1] = current bucket index (0-9)
- * state[2] = array index for distribution
- * state[3] = phase (0=distribution, 1=collection)
- * state[4] = bucket array index for collection
+ * State (RadixSortState, followed by size ints holding the buckets):
+ * digitPos = current digit position (0=ones, 1=tens, 2=hundreds, etc.)
+ * bucketIdx = current bucket index (0-9)
+ * arrayIdx = array index for distribution
+ * phase = 0=distribution, 1=collection
+ * bucketArrayIdx = bucket array index for collection
+ * maxDigits = digits in the largest key (0 until the first step)
+ * offset = subtracted from every value to make the keys; the minimum if any
+ *          value is negative, otherwise 0 (so the digits shown are the values')
+ * counts = elements in each bucket; bucket b starts at the sum of counts[0..b-1]
  */
+struct RadixSortState
+{
+    int digitPos;
+    int bucketIdx;
+    int arrayIdx;
+    int phase;
+    int bucketArrayIdx;
+    int maxDigits;
+    int offset;
+    int counts[10];
+    int bucketStart[10];
+};
+
+static int *radixSortBuckets(RadixSortState &s)
+{
+    return reinterpret_cast<int *>(&s + 1);
+}
+
+static size_t radixSortStateBytes(int size)
+{
+    return sizeof(RadixSortState) + static_cast<size_t>(size) * sizeof(int);
+}
+
+extern const StateType radixSortState = {radixSortStateBytes, nullptr, nullptr};
+
+static const uint32_t POWERS_OF_TEN[10] = {1,      10,      100,      1000,      10000,
+                                           100000, 1000000, 10000000, 100000000, 1000000000};
+
+// Keys are value - offset as unsigned, so INT_MIN..INT_MAX all fit (up to 10 digits)
+static int radixDigit(int value, int offset, int digitPos)
+{
+    uint32_t key = static_cast<uint32_t>(value) - static_cast<uint32_t>(offset);
+    return static_cast<int>(key / POWERS_OF_TEN[digitPos] % 10);
+}
+
 SwapResult radixSort(int array[], int size, int *state)
 {
-    int &digitPos = state[0];
-    int &bucketIdx = state[1];
-    int &arrayIdx = state[2];
-    int &phase = state[3];
-    int &bucketArrayIdx = state[4];
+    RadixSortState &s = typedState<RadixSortState>(state);
+    int *buckets = radixSortBuckets(s);
 
     SwapResult result = {-1, -1, false, false};
 
-    // Static arrays for buckets and counts
-    static int buckets[10][50]; // 10 buckets, max 50 elements each
-    static int counts[10];      // Count of elements in each bucket
-
-    // Initialize on first call
-    if (digitPos == 0 && bucketIdx == 0 && arrayIdx == 0 && phase == 0)
+    if (s.maxDigits == 0)
     {
-        // Clear counts
-        for (int i = 0; i < 10; i++)
+        int minValue = 0;
+        int maxValue = 0;
+        for (int i = 0; i < size; i++)
         {
-            counts[i] = 0;
+            if (array[i] < minValue) minValue = array[i];
+            if (array[i] > maxValue) maxValue = array[i];
         }
-    }
 
-    // Check if sorting is complete (all digits processed)
-    int maxValue = 0;
-    for (int i = 0; i < size; i++)
-    {
-        if (array[i] > maxValue) maxValue = array[i];
+        s.offset = minValue;
+        uint32_t maxKey = static_cast<uint32_t>(maxValue) - static_cast<uint32_t>(minValue);
+        s.maxDigits = 1;
+        while (maxKey /= 10) s.maxDigits++;
     }
-    
-    int maxDigits = 1;
-    while (maxValue /= 10) maxDigits++;
 
-    if (digitPos >= maxDigits)
+    // Check if sorting is complete (all digits processed)
+    if (s.digitPos >= s.maxDigits)
     {
         result.isComplete = true;
         return result;
     }
 
     // Handle different phases
-    switch (phase)
+    switch (s.phase)
     {
     case 0: // Distribution phase
         {
-            if (arrayIdx >= size)
+            if (s.arrayIdx >= size)
             {
-                // Distribution complete, move to collection
-                phase = 1;
-                bucketIdx = 0;
-                bucketArrayIdx = 0;
-                arrayIdx = 0;
+                // Distribution complete: lay the buckets out back to back, keeping arrival order
+                int offset = 0;
+                for (int b = 0; b < 10; b++)
+                {
+                    s.bucketStart[b] = offset;
+                    offset += s.counts[b];
+                }
+                int next[10];
+                for (int b = 0; b < 10; b++)
+                {
+                    next[b] = s.bucketStart[b];
+                }
+                for (int i = 0; i < size; i++)
+                {
+                    buckets[next[radixDigit(array[i], s.offset, s.digitPos)]++] = array[i];
+                }
+
+                // Move to collection
+                s.phase = 1;
+                s.bucketIdx = 0;
+                s.bucketArrayIdx = 0;
+                s.arrayIdx = 0;
                 return result;
             }
 
-            // Get current digit
-            int digit = (array[arrayIdx] / (int)pow(10, digitPos)) % 10;
-            
-            // Add to appropriate bucket
-            buckets[digit][counts[digit]] = array[arrayIdx];
-            counts[digit]++;
-            
-            arrayIdx++;
+            // Count the element for its bucket
+            s.counts[radixDigit(array[s.arrayIdx], s.offset, s.digitPos)]++;
+            s.arrayIdx++;
         }
         break;
 
     case 1: // Collection phase
-        if (bucketIdx >= 10)
+        if (s.bucketIdx >= 10)
         {
             // All buckets collected, move to next digit
-            digitPos++;
-            phase = 0;
-            arrayIdx = 0;
-            bucketIdx = 0;
-            
+            s.digitPos++;
+            s.phase = 0;
+            s.arrayIdx = 0;
+            s.bucketIdx = 0;
+
             // Clear counts for next iteration
             for (int i = 0; i < 10; i++)
             {
-                counts[i] = 0;
+                s.counts[i] = 0;
             }
             return result;
         }
 
-        if (bucketArrayIdx < counts[bucketIdx])
+        if (s.bucketArrayIdx < s.counts[s.bucketIdx])
         {
             // Collect from current bucket
-            array[arrayIdx] = buckets[bucketIdx][bucketArrayIdx];
-            result.index1 = arrayIdx;
-            result.index2 = bucketIdx;
+            array[s.arrayIdx] = buckets[s.bucketStart[s.bucketIdx] + s.bucketArrayIdx];
+            result.index1 = s.arrayIdx;
+            result.index2 = s.bucketIdx;
             result.swapped = true;
-            
-            arrayIdx++;
-            bucketArrayIdx++;
+
+            s.arrayIdx++;
+            s.bucketArrayIdx++;
         }
         else
         {
             // Move to next bucket
-            bucketIdx++;
-            bucketArrayIdx = 0;
+            s.bucketIdx++;
+            s.bucketArrayIdx = 0;
         }
         break;
     }
 
     return result;
-} 
\ No newline at end of file
+}
+
+/**
+ * Radix Sort - whole array in one call
+ * LSD over four 8-bit digits of the key with its sign bit flipped, so negative
+ * numbers order before positive ones. Passes where every key shares the digit
+ * are skipped. When max - min is small next to the size a single counting
+ * pass replaces the digit passes.
+ */
+void radixSortAll(int array[], int size, Arena &scratch)
+{
+    if (size < 2)
+        return;
+
+    auto bounds = std::minmax_element(array, array + size);
+    if (countingSortFits(size, static_cast<long long>(*bounds.second) - *bounds.first))
+    {
+        countingSortRange(array, size, *bounds.first, *bounds.second, scratch);
+        return;
+    }
+
+    int *from = array;
+    int *to = scratch.allocateArray<int>(size);
+
+    for (int shift = 0; shift < 32; shift += 8)
+    {
+        size_t counts[256] = {0};
+        for (int i = 0; i < size; i++)
+        {
+            counts[((static_cast<uint32_t>(from[i]) ^ 0x80000000u) >> shift) & 0xFF]++;
+        }
+
+        if (counts[((static_cast<uint32_t>(from[0]) ^ 0x80000000u) >> shift) & 0xFF] == static_cast<size_t>(size))
+            continue;
+
+        size_t offset = 0;
+        for (int digit = 0; digit < 256; digit++)
+        {
+            size_t count = counts[digit];
+            counts[digit] = offset;
+            offset += count;
+        }
+
+        for (int i = 0; i < size; i++)
+        {
+            to[counts[((static_cast<uint32_t>(from[i]) ^ 0x80000000u) >> shift) & 0xFF]++] = from[i];
+        }
+        std::swap(from, to);
+    }
+
+    if (from != array)
+    {
+        std::copy(from, from + size, array);
+    }
+}
@@ -1,4 +1,6 @@
 #include "algorithm_registry.h"
+#include "auto_sort.h"
+#include "selection.h"
 
 // Forward declarations of algorithm functions
 extern SwapResult bubbleSort(int array[], int size, int *state);
@@ -7,6 +9,36 @@ extern SwapResult shellSort(int array[], int size, int *state);
 extern SwapResult mergeSort(int array[], int size, int *state);
 extern SwapResult quickSort(int array[], int size, int *state);
 extern SwapResult radixSort(int array[], int size, int *state);
+extern SwapResult sampleSort(int array[], int size, int *state);
+extern SwapResult countingSort(int array[], int size, int *state);
+extern SwapResult bucketSort(int array[], int size, int *state);
+extern SwapResult heapSortStep(int array[], int size, int *state);
+extern SwapResult partialSortHeapStep(int array[], int size, int *state);
+extern SwapResult partialSortSelectStep(int array[], int size, int *state);
+extern SwapResult nthElementStep(int array[], int size, int *state);
+
+// Whole-array fast paths
+extern void shellSortAll(int array[], int size, Arena &scratch);
+extern void mergeSortAll(int array[], int size, Arena &scratch);
+extern void quickSortAll(int array[], int size, Arena &scratch);
+extern void radixSortAll(int array[], int size, Arena &scratch);
+extern void sampleSortAll(int array[], int size, Arena &scratch);
+extern void countingSortAll(int array[], int size, Arena &scratch);
+extern void bucketSortAll(int array[], int size, Arena &scratch);
+extern void binaryHeapSortAll(int array[], int size, Arena &scratch);
+extern void quaternaryHeapSortAll(int array[], int size, Arena &scratch);
+extern void octonaryHeapSortAll(int array[], int size, Arena &scratch);
+
+// Typed state
+extern const StateType quickSortState;
+extern const StateType radixSortState;
+extern const StateType countingSortState;
+extern const StateType bucketSortState;
+extern const StateType binaryHeapSortState;
+extern const StateType quaternaryHeapSortState;
+extern const StateType octonaryHeapSortState;
+extern const StateType heapSelectState;
+extern const StateType quickSelectState;
 
 /**
  * Register all algorithms explicitly
@@ -14,10 +46,33 @@ extern SwapResult radixSort(int array[], int size, int *state);
  */
 void registerAllAlgorithms()
 {
-    registerAlgorithm("Bubble Sort", bubbleSort, 2);
-    registerAlgorithm("Selection Sort", selectionSort, 3);
-    registerAlgorithm("Shell Sort", shellSort, 5);
-    registerAlgorithm("Merge Sort", mergeSort, 7);
-    registerAlgorithm("Quick Sort", quickSort, 8);
-    registerAlgorithm("Radix Sort", radixSort, 5);
+    registerAlgorithm("Bubble Sort", bubbleSort, 2, ALGO_STABLE | ALGO_IN_PLACE | ALGO_PERMUTING | ALGO_PARALLEL_SAFE);
+    registerAlgorithm("Selection Sort", selectionSort, 3, ALGO_IN_PLACE | ALGO_PERMUTING | ALGO_PARALLEL_SAFE);
+    registerAlgorithm("Shell Sort", shellSort, 5, ALGO_IN_PLACE | ALGO_ADAPTIVE | ALGO_PARALLEL_SAFE,
+                      shellSortAll);
+    // Not ALGO_IN_PLACE: the whole-array path merges through a buffer the size of the array
+    registerAlgorithm("Merge Sort", mergeSort, 7, ALGO_STABLE | ALGO_PERMUTING | ALGO_PARALLEL_SAFE, mergeSortAll);
+    registerAlgorithm("Quick Sort", quickSort, quickSortState, ALGO_IN_PLACE | ALGO_PERMUTING | ALGO_PARALLEL_SAFE,
+                      quickSortAll);
+    registerAlgorithm("Radix Sort", radixSort, radixSortState, ALGO_STABLE | ALGO_PARALLEL_SAFE, radixSortAll);
+    registerAlgorithm("Sample Sort", sampleSort, 14, ALGO_PERMUTING | ALGO_PARALLEL_SAFE, sampleSortAll);
+    registerAlgorithm("Auto", autoSort, autoSortState, ALGO_PARALLEL_SAFE, autoSortAll);
+    registerAlgorithm("Counting Sort", countingSort, countingSortState, ALGO_PARALLEL_SAFE, countingSortAll);
+    registerAlgorithm("Bucket Sort", bucketSort, bucketSortState, ALGO_PARALLEL_SAFE, bucketSortAll);
+    // Not ALGO_IN_PLACE: the whole-array path sorts a cache-line aligned copy of the array
+    registerAlgorithm("Heap Sort", heapSortStep, binaryHeapSortState, ALGO_PERMUTING | ALGO_PARALLEL_SAFE,
+                      binaryHeapSortAll);
+    registerAlgorithm("Heap Sort (4-ary)", heapSortStep, quaternaryHeapSortState, ALGO_PERMUTING | ALGO_PARALLEL_SAFE,
+                      quaternaryHeapSortAll);
+    registerAlgorithm("Heap Sort (8-ary)", heapSortStep, octonaryHeapSortState, ALGO_PERMUTING | ALGO_PARALLEL_SAFE,
+                      octonaryHeapSortAll);
+
+    // Selection: only the k smallest (selectionStepRank(size) when stepping)
+    registerSelectionAlgorithm("Partial Sort (Heap)", partialSortHeapStep, heapSelectState,
+                               ALGO_PARTIAL_SORT | ALGO_IN_PLACE | ALGO_PERMUTING | ALGO_PARALLEL_SAFE, partialSortHeap);
+    registerSelectionAlgorithm("Partial Sort (Quickselect)", partialSortSelectStep, quickSelectState,
+                               ALGO_PARTIAL_SORT | ALGO_IN_PLACE | ALGO_PERMUTING | ALGO_PARALLEL_SAFE,
+                               partialSortSelect);
+    registerSelectionAlgorithm("Nth Element", nthElementStep, quickSelectState,
+                               ALGO_IN_PLACE | ALGO_PERMUTING | ALGO_PARALLEL_SAFE, nthElement);
 }
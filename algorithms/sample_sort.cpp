@@ -0,0 +1,324 @@
+#include "algorithm_interface.h"
+#include "algorithm_registry.h"
+#include "arena.h"
+#include "thread_pool.h"
+#include "trace.h"
+#include <algorithm>
+#include <cstdint>
+
+/**
+ * Sample Sort Algorithm (visualization)
+ * Picks splitters from a sample, moves every element into the bucket between
+ * two splitters, then insertion-sorts each bucket on its own
+ *
+ * State variables:
+ * state[0] = phase (0=pick splitters, 1=partition into buckets, 2=sort buckets, 3=done)
+ * state[1] = scan position while partitioning
+ * state[2] = bucket currently being filled / sorted
+ * state[3] = first unfilled position
+ * state[4..6] = the three splitters
+ * state[7..11] = bucket boundaries (bucket b is [state[7+b], state[8+b]))
+ * state[12] = insertion sort: element being inserted
+ * state[13] = insertion sort: its current position
+ */
+static const int STEP_BUCKETS = 4;
+
+static int classifyStep(int value, const int *splitters)
+{
+    // Number of splitters below the value, without branches
+    return (value > splitters[0]) + (value > splitters[1]) + (value > splitters[2]);
+}
+
+SwapResult sampleSort(int array[], int size, int *state)
+{
+    int &phase = state[0];
+    int &scan = state[1];
+    int &bucket = state[2];
+    int &fill = state[3];
+    int *splitters = &state[4];
+    int *bounds = &state[7];
+    int &insertIndex = state[12];
+    int &insertPos = state[13];
+
+    SwapResult result = {-1, -1, false, false};
+
+    switch (phase)
+    {
+    case 0: // Pick splitters from seven evenly spaced samples
+        {
+            if (size < 2 * STEP_BUCKETS)
+            {
+                // Too small to split: one bucket holds everything
+                bounds[0] = 0;
+                for (int b = 1; b <= STEP_BUCKETS; b++)
+                    bounds[b] = size;
+                bucket = 0;
+                insertIndex = 1;
+                insertPos = 1;
+                phase = 2;
+                return result;
+            }
+
+            int samples[2 * STEP_BUCKETS - 1];
+            int sampleCount = 2 * STEP_BUCKETS - 1;
+            for (int s = 0; s < sampleCount; s++)
+            {
+                samples[s] = array[(static_cast<long long>(2 * s + 1) * size) / (2 * sampleCount)];
+            }
+            std::sort(samples, samples + sampleCount);
+            for (int b = 0; b < STEP_BUCKETS - 1; b++)
+            {
+                splitters[b] = samples[2 * b + 1];
+            }
+
+            bucket = 0;
+            fill = 0;
+            scan = 0;
+            bounds[0] = 0;
+            phase = 1;
+        }
+        break;
+
+    case 1: // Partition: move elements of the current bucket to the front of the unfilled area
+        if (bucket == STEP_BUCKETS - 1 || scan >= size)
+        {
+            bounds[bucket + 1] = (bucket == STEP_BUCKETS - 1) ? size : fill;
+            bucket++;
+            scan = fill;
+            if (bucket >= STEP_BUCKETS)
+            {
+                bucket = 0;
+                insertIndex = bounds[0] + 1;
+                insertPos = insertIndex;
+                phase = 2;
+            }
+            return result;
+        }
+
+        if (classifyStep(array[scan], splitters) == bucket)
+        {
+            if (scan != fill)
+            {
+                int temp = array[scan];
+                array[scan] = array[fill];
+                array[fill] = temp;
+                result.index1 = fill;
+                result.index2 = scan;
+                result.swapped = true;
+            }
+            fill++;
+        }
+        scan++;
+        break;
+
+    case 2: // Insertion sort inside the current bucket
+        {
+            if (bucket >= STEP_BUCKETS)
+            {
+                phase = 3;
+                result.isComplete = true;
+                return result;
+            }
+
+            int start = bounds[bucket];
+            int end = bounds[bucket + 1];
+            if (insertIndex >= end)
+            {
+                bucket++;
+                if (bucket < STEP_BUCKETS)
+                {
+                    insertIndex = bounds[bucket] + 1;
+                    insertPos = insertIndex;
+                }
+                return result;
+            }
+
+            if (insertPos > start && array[insertPos - 1] > array[insertPos])
+            {
+                int temp = array[insertPos];
+                array[insertPos] = array[insertPos - 1];
+                array[insertPos - 1] = temp;
+                result.index1 = insertPos - 1;
+                result.index2 = insertPos;
+                result.swapped = true;
+                insertPos--;
+            }
+            else
+            {
+                insertIndex++;
+                insertPos = insertIndex;
+            }
+        }
+        break;
+
+    default:
+        result.isComplete = true;
+        break;
+    }
+
+    return result;
+}
+
+/**
+ * Super Scalar Sample Sort - whole array in one call
+ *
+ * 1. Sort an oversampled random-ish sample and take every OVERSAMPLING-th
+ *    element as one of BUCKETS-1 splitters, stored as an implicit binary
+ *    search tree (Eytzinger layout).
+ * 2. Every thread classifies its own slice: descending the splitter tree is
+ *    log2(BUCKETS) steps of j = 2j + (x > tree[j]), with no branches to
+ *    mispredict. Bucket ids are remembered and counted per thread.
+ * 3. Prefix sums over (bucket, thread) give each thread private output
+ *    offsets, so the scatter into the buffer needs no synchronisation.
+ * 4. Buckets are sorted independently by whichever thread is free and copied
+ *    back into the array. Oversized buckets (skewed input) are split again
+ *    with the same pool, which keeps every thread busy; the bucket's part of
+ *    the array is free at that point and serves as its buffer.
+ *
+ * All parallel work runs on the shared thread pool.
+ */
+static const int BUCKETS = 256;
+static const int LOG_BUCKETS = 8;
+static const int OVERSAMPLING = 16;
+static const int SEQUENTIAL_THRESHOLD = 1 << 16;
+
+static void sampleSortRecursive(int array[], int size, int buffer[], int depth, Arena &scratch)
+{
+    if (size < SEQUENTIAL_THRESHOLD || depth > 4)
+    {
+        std::sort(array, array + size);
+        return;
+    }
+
+    // Sample evenly spaced elements, offset by a multiplicative hash to avoid aliasing with patterns
+    const int sampleSize = BUCKETS * OVERSAMPLING - 1;
+    int *sample = scratch.allocateArray<int>(sampleSize);
+    uint64_t position = 0x9E3779B97F4A7C15ULL * (depth + 1);
+    for (int s = 0; s < sampleSize; s++)
+    {
+        position += 0x9E3779B97F4A7C15ULL;
+        sample[s] = array[(position >> 16) % static_cast<uint64_t>(size)];
+    }
+    std::sort(sample, sample + sampleSize);
+
+    if (sample[0] == sample[sampleSize - 1])
+    {
+        // Too few distinct keys to split on
+        std::sort(array, array + size);
+        return;
+    }
+
+    // tree[1..BUCKETS-1] in Eytzinger order: node j has children 2j and 2j+1
+    int tree[BUCKETS];
+    {
+        int splitters[BUCKETS - 1];
+        for (int s = 0; s < BUCKETS - 1; s++)
+        {
+            splitters[s] = sample[(s + 1) * OVERSAMPLING - 1];
+        }
+
+        // In-order walk of the implicit tree assigns the sorted splitters
+        int next = 0;
+        int stack[LOG_BUCKETS + 1];
+        int top = 0;
+        int node = 1;
+        while (top > 0 || node < BUCKETS)
+        {
+            while (node < BUCKETS)
+            {
+                stack[top++] = node;
+                node = 2 * node;
+            }
+            node = stack[--top];
+            tree[node] = splitters[next++];
+            node = 2 * node + 1;
+        }
+    }
+
+    int threads = std::max(1, std::min(getThreadPool().size(), size / SEQUENTIAL_THRESHOLD));
+    uint8_t *oracle = scratch.allocateArray<uint8_t>(size);
+    int *counts = scratch.allocateArray<int>(static_cast<size_t>(threads) * BUCKETS); // Row t belongs to thread t
+    std::fill(counts, counts + threads * BUCKETS, 0);
+
+    auto sliceBegin = [size, threads](int t) { return static_cast<int>(static_cast<long long>(size) * t / threads); };
+    auto forEachSlice = [threads](const std::function<void(int)> &work) {
+        parallelFor(0, threads, 1, [&work](long long first, long long last) {
+            for (long long t = first; t < last; t++)
+                work(static_cast<int>(t));
+        });
+    };
+
+    // Classify
+    forEachSlice([&](int t) {
+        TRACE_SCOPE("sample sort classify");
+        int *count = counts + t * BUCKETS;
+        for (int i = sliceBegin(t), end = sliceBegin(t + 1); i < end; i++)
+        {
+            int value = array[i];
+            int j = 1;
+            for (int level = 0; level < LOG_BUCKETS; level++)
+            {
+                j = 2 * j + (value > tree[j]);
+            }
+            oracle[i] = static_cast<uint8_t>(j - BUCKETS);
+            count[j - BUCKETS]++;
+        }
+    });
+
+    // Bucket b, thread t writes from offsets[t][b]; bucketStart[b] is where bucket b begins
+    int bucketStart[BUCKETS + 1];
+    int offset = 0;
+    for (int b = 0; b < BUCKETS; b++)
+    {
+        bucketStart[b] = offset;
+        for (int t = 0; t < threads; t++)
+        {
+            int count = counts[t * BUCKETS + b];
+            counts[t * BUCKETS + b] = offset;
+            offset += count;
+        }
+    }
+    bucketStart[BUCKETS] = size;
+
+    // Scatter
+    forEachSlice([&](int t) {
+        TRACE_SCOPE("sample sort scatter");
+        int *next = counts + t * BUCKETS;
+        for (int i = sliceBegin(t), end = sliceBegin(t + 1); i < end; i++)
+        {
+            buffer[next[oracle[i]]++] = array[i];
+        }
+    });
+
+    // Sort buckets; idle threads steal the remaining ones
+    parallelFor(0, BUCKETS, 1, [&](long long firstBucket, long long lastBucket) {
+        for (int b = static_cast<int>(firstBucket); b < lastBucket; b++)
+        {
+            TRACE_SCOPE("sample sort bucket");
+            int start = bucketStart[b];
+            int length = bucketStart[b + 1] - start;
+            if (length < SEQUENTIAL_THRESHOLD || length == size)
+            {
+                // Small, or no progress (all keys between two equal splitters)
+                std::sort(buffer + start, buffer + start + length);
+            }
+            else
+            {
+                sampleSortRecursive(buffer + start, length, array + start, depth + 1, scratch);
+            }
+            std::copy(buffer + start, buffer + start + length, array + start);
+        }
+    });
+}
+
+void sampleSortAll(int array[], int size, Arena &scratch)
+{
+    TRACE_SCOPE("sample sort");
+    if (size < SEQUENTIAL_THRESHOLD)
+    {
+        std::sort(array, array + size);
+        return;
+    }
+
+    sampleSortRecursive(array, size, scratch.allocateArray<int>(size), 0, scratch);
+}
@@ -0,0 +1,426 @@
+#include "selection.h"
+#include "algorithm_interface.h"
+#include "algorithm_registry.h"
+#include <algorithm>
+#include <utility>
+
+// Ranges this small are finished with insertion sort
+static const int SELECT_INSERTION_LIMIT = 16;
+// partialSort uses the heap when k is at most size / PARTIAL_HEAP_DIVISOR
+static const int PARTIAL_HEAP_DIVISOR = 64;
+
+static void insertionSort(int array[], int low, int high)
+{
+    for (int i = low + 1; i < high; i++)
+    {
+        int value = array[i];
+        int j = i;
+        while (j > low && array[j - 1] > value)
+        {
+            array[j] = array[j - 1];
+            j--;
+        }
+        array[j] = value;
+    }
+}
+
+static int medianOfThree(int a, int b, int c)
+{
+    return std::max(std::min(a, b), std::min(std::max(a, b), c));
+}
+
+/**
+ * Median-of-medians pivot value for array[low..high): medians of groups of
+ * five are gathered at the front and the median of those is selected
+ */
+static int medianOfMedians(int array[], int low, int high)
+{
+    int groups = 0;
+    for (int first = low; first < high; first += 5)
+    {
+        int last = std::min(first + 5, high);
+        insertionSort(array, first, last);
+        std::swap(array[low + groups], array[first + (last - first) / 2]);
+        groups++;
+    }
+
+    nthElement(array + low, groups, groups / 2);
+    return array[low + groups / 2];
+}
+
+void nthElement(int array[], int size, int nth)
+{
+    if (nth < 0 || nth >= size)
+        return;
+
+    int low = 0;
+    int high = size;
+    int budget = 0;
+    for (int n = size; n > 1; n >>= 1)
+        budget += 2;
+
+    while (high - low > SELECT_INSERTION_LIMIT)
+    {
+        int pivot = budget-- > 0 ? medianOfThree(array[low], array[low + (high - low) / 2], array[high - 1])
+                                 : medianOfMedians(array, low, high);
+
+        // Three-way partition: [low, less) < pivot, [less, greater) == pivot, [greater, high) > pivot
+        int less = low;
+        int greater = high;
+        int i = low;
+        while (i < greater)
+        {
+            if (array[i] < pivot)
+                std::swap(array[less++], array[i++]);
+            else if (array[i] > pivot)
+                std::swap(array[i], array[--greater]);
+            else
+                i++;
+        }
+
+        if (nth < less)
+            high = less;
+        else if (nth >= greater)
+            low = greater;
+        else
+            return;
+    }
+
+    insertionSort(array, low, high);
+}
+
+static void siftDown(int heap[], int size, int node)
+{
+    int value = heap[node];
+    for (int child = 2 * node + 1; child < size; child = 2 * node + 1)
+    {
+        if (child + 1 < size && heap[child + 1] > heap[child])
+            child++;
+        if (heap[child] <= value)
+            break;
+        heap[node] = heap[child];
+        node = child;
+    }
+    heap[node] = value;
+}
+
+void partialSortHeap(int array[], int size, int k)
+{
+    k = std::min(k, size);
+    if (k <= 0)
+        return;
+
+    for (int node = k / 2 - 1; node >= 0; node--)
+        siftDown(array, k, node);
+
+    // Anything smaller than the largest of the k so far replaces it
+    for (int i = k; i < size; i++)
+    {
+        if (array[i] < array[0])
+        {
+            std::swap(array[0], array[i]);
+            siftDown(array, k, 0);
+        }
+    }
+
+    for (int end = k - 1; end > 0; end--)
+    {
+        std::swap(array[0], array[end]);
+        siftDown(array, end, 0);
+    }
+}
+
+void partialSortSelect(int array[], int size, int k)
+{
+    k = std::min(k, size);
+    if (k <= 0)
+        return;
+
+    nthElement(array, size, k < size ? k : size - 1);
+    std::sort(array, array + k);
+}
+
+void partialSort(int array[], int size, int k)
+{
+    if (k <= size / PARTIAL_HEAP_DIVISOR)
+        partialSortHeap(array, size, k);
+    else
+        partialSortSelect(array, size, k);
+}
+
+int medianInPlace(int values[], int size)
+{
+    int middle = (size - 1) / 2;
+    nthElement(values, size, middle);
+    return values[middle];
+}
+
+/**
+ * Partial Sort (Heap) (visualization)
+ * Builds a max-heap of the first k, lets every later element that is smaller
+ * than the heap's top replace it, then heap-sorts the k smallest
+ *
+ * State:
+ * phase = 0=build heap, 1=scan the rest, 2=sort the heap, 3=done
+ * k = selectionStepRank(size)
+ * next = build: next node to sift, scan: next element to look at,
+ *        sort: current heap size
+ * sift = node being sifted down (-1 when not sifting)
+ */
+struct HeapSelectState
+{
+    int phase;
+    int k;
+    int next;
+    int sift;
+};
+
+static void heapSelectInit(void *state, int size)
+{
+    HeapSelectState &s = *static_cast<HeapSelectState *>(state);
+    s.k = selectionStepRank(size);
+    s.next = s.k / 2 - 1;
+    s.sift = -1;
+}
+
+static size_t heapSelectStateBytes(int)
+{
+    return sizeof(HeapSelectState);
+}
+
+extern const StateType heapSelectState = {heapSelectStateBytes, heapSelectInit, nullptr};
+
+/**
+ * One swap of a sift-down within array[0..heapSize)
+ */
+static SwapResult siftStep(int array[], int heapSize, int &sift)
+{
+    SwapResult result = {-1, -1, false, false};
+    int child = 2 * sift + 1;
+    if (child + 1 < heapSize && array[child + 1] > array[child])
+        child++;
+
+    if (child < heapSize && array[child] > array[sift])
+    {
+        std::swap(array[child], array[sift]);
+        result.index1 = sift;
+        result.index2 = child;
+        result.swapped = true;
+        sift = child;
+    }
+    else
+    {
+        result.index1 = sift;
+        sift = -1;
+    }
+    return result;
+}
+
+SwapResult partialSortHeapStep(int array[], int size, int *state)
+{
+    HeapSelectState &s = typedState<HeapSelectState>(state);
+    SwapResult result = {-1, -1, false, false};
+
+    if (s.k <= 0)
+        s.phase = 3;
+
+    switch (s.phase)
+    {
+    case 0: // Build the heap over array[0..k)
+        if (s.sift >= 0)
+            return siftStep(array, s.k, s.sift);
+        if (s.next < 0)
+        {
+            s.phase = 1;
+            s.next = s.k;
+            return result;
+        }
+        s.sift = s.next--;
+        return siftStep(array, s.k, s.sift);
+
+    case 1: // Scan the rest
+        if (s.sift >= 0)
+            return siftStep(array, s.k, s.sift);
+        if (s.next >= size)
+        {
+            s.phase = 2;
+            s.next = s.k;
+            return result;
+        }
+
+        result.index1 = 0;
+        result.index2 = s.next;
+        if (array[s.next] < array[0])
+        {
+            std::swap(array[0], array[s.next]);
+            result.swapped = true;
+            s.sift = 0;
+        }
+        s.next++;
+        return result;
+
+    case 2: // Move the top to the end of the shrinking heap
+        if (s.sift >= 0)
+            return siftStep(array, s.next, s.sift);
+        if (s.next <= 1)
+        {
+            s.phase = 3;
+            break;
+        }
+
+        s.next--;
+        std::swap(array[0], array[s.next]);
+        result.index1 = 0;
+        result.index2 = s.next;
+        result.swapped = true;
+        s.sift = 0;
+        return result;
+    }
+
+    result.isComplete = true;
+    return result;
+}
+
+/**
+ * Partial Sort (Quickselect) / Nth Element (visualization)
+ * Lomuto partitions around a median-of-three pivot, keeping only the side
+ * that holds rank k, until the pivot lands on k. Partial Sort then
+ * insertion-sorts array[0..k)
+ *
+ * State:
+ * phase = 0=pick pivot, 1=partition, 2=insertion sort the prefix, 3=done
+ * k = selectionStepRank(size)
+ * low, high = range still holding rank k (inclusive)
+ * scan, store = partition: element being compared, next slot for smaller ones;
+ *               insertion: element being inserted, its current position
+ */
+struct QuickSelectState
+{
+    int phase;
+    int k;
+    int low;
+    int high;
+    int scan;
+    int store;
+};
+
+static void quickSelectInit(void *state, int size)
+{
+    QuickSelectState &s = *static_cast<QuickSelectState *>(state);
+    s.k = selectionStepRank(size);
+    s.high = size - 1;
+}
+
+static size_t quickSelectStateBytes(int)
+{
+    return sizeof(QuickSelectState);
+}
+
+extern const StateType quickSelectState = {quickSelectStateBytes, quickSelectInit, nullptr};
+
+static SwapResult quickSelectStep(int array[], int *state, bool sortPrefix)
+{
+    QuickSelectState &s = typedState<QuickSelectState>(state);
+    SwapResult result = {-1, -1, false, false};
+
+    switch (s.phase)
+    {
+    case 0: // Median of three to the end of the range
+        {
+            if (s.low >= s.high)
+            {
+                // Rank k is in place
+                s.phase = sortPrefix ? 2 : 3;
+                s.scan = 1;
+                s.store = 1;
+                return result;
+            }
+
+            int middle = s.low + (s.high - s.low) / 2;
+            int a = array[s.low], b = array[middle], c = array[s.high];
+            int median = (a < b) == (b < c) ? middle : (b < a) == (a < c) ? s.low : s.high;
+            if (median != s.high)
+            {
+                std::swap(array[median], array[s.high]);
+                result.index1 = median;
+                result.index2 = s.high;
+                result.swapped = true;
+            }
+            s.scan = s.low;
+            s.store = s.low;
+            s.phase = 1;
+            return result;
+        }
+
+    case 1: // Partition against the pivot at high
+        if (s.scan < s.high)
+        {
+            result.index1 = s.scan;
+            result.index2 = s.high;
+            if (array[s.scan] < array[s.high])
+            {
+                if (s.scan != s.store)
+                {
+                    std::swap(array[s.scan], array[s.store]);
+                    result.index2 = s.store;
+                    result.swapped = true;
+                }
+                s.store++;
+            }
+            s.scan++;
+            return result;
+        }
+
+        // Pivot into place, keep the side holding k
+        if (s.store != s.high)
+        {
+            std::swap(array[s.store], array[s.high]);
+            result.index1 = s.store;
+            result.index2 = s.high;
+            result.swapped = true;
+        }
+        if (s.k < s.store)
+            s.high = s.store - 1;
+        else if (s.k > s.store)
+            s.low = s.store + 1;
+        else
+            s.low = s.high = s.k;
+        s.phase = 0;
+        return result;
+
+    case 2: // Insertion sort of array[0..k)
+        if (s.scan >= s.k)
+        {
+            s.phase = 3;
+            break;
+        }
+
+        if (s.store > 0 && array[s.store - 1] > array[s.store])
+        {
+            std::swap(array[s.store - 1], array[s.store]);
+            result.index1 = s.store - 1;
+            result.index2 = s.store;
+            result.swapped = true;
+            s.store--;
+        }
+        else
+        {
+            s.scan++;
+            s.store = s.scan;
+        }
+        return result;
+    }
+
+    result.isComplete = true;
+    return result;
+}
+
+SwapResult partialSortSelectStep(int array[], int, int *state)
+{
+    return quickSelectStep(array, state, true);
+}
+
+SwapResult nthElementStep(int array[], int, int *state)
+{
+    return quickSelectStep(array, state, false);
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+/**
+ * Selection: the k smallest elements, or the element of rank k, without
+ * paying for a full sort
+ *
+ * These are the fast paths behind the registered selection engines
+ * ("Partial Sort (Heap)", "Partial Sort (Quickselect)", "Nth Element").
+ */
+
+/**
+ * Introselect: put the element of rank nth at array[nth], nothing larger
+ * before it and nothing smaller after it
+ * Quickselect with median-of-three pivots and three-way partitions; after
+ * 2 log2(n) rounds without converging it switches to median-of-medians
+ * pivots, so the worst case stays O(n)
+ */
+void nthElement(int array[], int size, int nth);
+
+/**
+ * Sort the k smallest into array[0..k) with a max-heap of k: O(n log k)
+ * The best choice when k is much smaller than n
+ */
+void partialSortHeap(int array[], int size, int k);
+
+/**
+ * Sort the k smallest into array[0..k) with nthElement, then sort the prefix:
+ * O(n + k log k)
+ */
+void partialSortSelect(int array[], int size, int k);
+
+/**
+ * Whichever of the two suits k
+ */
+void partialSort(int array[], int size, int k);
+
+/**
+ * Lower median of values[0..size) in O(n); reorders values
+ */
+int medianInPlace(int values[], int size);
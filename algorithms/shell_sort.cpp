@@ -83,3 +83,43 @@ SwapResult shellSort(int array[], int size, int *state)
 
     return result;
 }
+
+/**
+ * Shell Sort - whole array in one call
+ * Uses Ciura's gap sequence, extended by a factor of 2.25 for large arrays
+ */
+void shellSortAll(int array[], int size, Arena &)
+{
+    static const int ciuraGaps[] = {1, 4, 10, 23, 57, 132, 301, 701, 1750};
+
+    // Build the gap list from largest to smallest
+    long long gaps[64];
+    int gapCount = 0;
+    for (int g : ciuraGaps)
+    {
+        if (g >= size)
+            break;
+        gaps[gapCount++] = g;
+    }
+    while (gapCount > 0 && gapCount < 64 && gaps[gapCount - 1] * 9 / 4 < size)
+    {
+        gaps[gapCount] = gaps[gapCount - 1] * 9 / 4;
+        gapCount++;
+    }
+
+    for (int g = gapCount - 1; g >= 0; g--)
+    {
+        int gap = static_cast<int>(gaps[g]);
+        for (int i = gap; i < size; i++)
+        {
+            int temp = array[i];
+            int j = i;
+            while (j >= gap && array[j - gap] > temp)
+            {
+                array[j] = array[j - gap];
+                j -= gap;
+            }
+            array[j] = temp;
+        }
+    }
+}
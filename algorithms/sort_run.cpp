@@ -0,0 +1,54 @@
+#include "sort_run.h"
+#include <algorithm>
+#include <cstring>
+
+SortRun::SortRun(Arena *scratch)
+    : arena(scratch ? scratch : &ownArena), algorithm(nullptr), size(0), state(nullptr), stateBytes(0)
+{
+}
+
+SortRun::~SortRun()
+{
+    finish();
+}
+
+void SortRun::start(const AlgorithmInfo &info, int arraySize)
+{
+    finish();
+    if (arena == &ownArena)
+        ownArena.reset();
+
+    const StateType &type = info.stateType;
+    stateBytes = type.bytesFor ? type.bytesFor(arraySize)
+                               : static_cast<size_t>(std::max(info.stateSize, 1)) * sizeof(int);
+
+    state = static_cast<int *>(arena->allocate(stateBytes));
+    std::memset(state, 0, stateBytes);
+    if (type.init)
+        type.init(state, arraySize);
+
+    algorithm = &info;
+    size = arraySize;
+}
+
+void SortRun::finish()
+{
+    if (algorithm && algorithm->stateType.destroy)
+        algorithm->stateType.destroy(state);
+
+    algorithm = nullptr;
+    state = nullptr;
+    stateBytes = 0;
+}
+
+void SortRun::saveState(std::vector<unsigned char> &snapshot) const
+{
+    const unsigned char *bytes = reinterpret_cast<const unsigned char *>(state);
+    snapshot.assign(bytes, bytes + stateBytes);
+}
+
+void SortRun::restoreState(const std::vector<unsigned char> &snapshot)
+{
+    if (snapshot.size() == stateBytes)
+        std::memcpy(state, snapshot.data(), stateBytes);
+}
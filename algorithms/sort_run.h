@@ -0,0 +1,47 @@
+#pragma once
+#include "algorithm_interface.h"
+#include "arena.h"
+#include <vector>
+
+/**
+ * One step-by-step run of an algorithm over one array
+ *
+ * Owns the run's state: plain int state or the algorithm's StateType block,
+ * allocated from an arena, initialised by start() and destroyed by finish()
+ * or the destructor. Separate runs share nothing, so any number of them can
+ * step at the same time, including runs of the same algorithm.
+ */
+class SortRun
+{
+public:
+    /**
+     * @param scratch: Arena to take the state from; nullptr uses one owned by
+     *                 the run (reused by every start(), so restarts don't allocate)
+     */
+    explicit SortRun(Arena *scratch = nullptr);
+    ~SortRun();
+
+    void start(const AlgorithmInfo &algorithm, int size);
+    void finish();
+
+    bool isStarted() const { return algorithm != nullptr; }
+    const AlgorithmInfo *getAlgorithm() const { return algorithm; }
+
+    SwapResult step(int array[]) { return algorithm->function(array, size, state); }
+
+    /**
+     * Copy the state out / back in (the array is the caller's to save)
+     * Not available for states with a destroy hook, whose bytes may own resources
+     */
+    bool canSnapshot() const { return algorithm && !algorithm->stateType.destroy; }
+    void saveState(std::vector<unsigned char> &snapshot) const;
+    void restoreState(const std::vector<unsigned char> &snapshot);
+
+private:
+    Arena ownArena;
+    Arena *arena;
+    const AlgorithmInfo *algorithm;
+    int size;
+    int *state;
+    size_t stateBytes;
+};
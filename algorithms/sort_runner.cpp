@@ -0,0 +1,103 @@
+#include "sort_runner.h"
+#include "algorithm_registry.h"
+#include "sort_run.h"
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+void runToCompletion(const AlgorithmInfo &algorithm, int array[], int size, Arena &scratch)
+{
+    if (algorithm.bulkFunction)
+    {
+        algorithm.bulkFunction(array, size, scratch);
+        return;
+    }
+
+    SortRun run(&scratch);
+    run.start(algorithm, size);
+    while (!run.step(array).isComplete)
+    {
+    }
+}
+
+namespace
+{
+// Runs using this thread's scratch arena; a thread that helps the pool while it
+// waits can start a run inside another one, and only the outermost may reset
+thread_local int scratchUsers = 0;
+
+struct ScratchUser
+{
+    ScratchUser() { scratchUsers++; }
+    ~ScratchUser() { scratchUsers--; }
+};
+}
+
+void runToCompletion(const AlgorithmInfo &algorithm, int array[], int size)
+{
+    Arena &scratch = threadScratchArena();
+    if (scratchUsers == 0)
+        scratch.reset();
+
+    ScratchUser user;
+    runToCompletion(algorithm, array, size, scratch);
+}
+
+void runSelection(const AlgorithmInfo &algorithm, int array[], int size, int k)
+{
+    if (algorithm.selectFunction)
+        algorithm.selectFunction(array, size, k);
+    else
+        runToCompletion(algorithm, array, size);
+}
+
+bool isBulkSortEngine(const AlgorithmInfo &algorithm)
+{
+    return algorithm.bulkFunction && !hasCapabilities(algorithm, ALGO_SELECTION);
+}
+
+const AlgorithmInfo *getBulkSortEngine(const char *name, std::string &error)
+{
+    const AlgorithmInfo *algorithm = getAlgorithmByName(name);
+    if (!algorithm)
+    {
+        error = std::string("unknown algorithm: ") + name;
+        return nullptr;
+    }
+    if (!isBulkSortEngine(*algorithm))
+    {
+        error = std::string(name) +
+                (hasCapabilities(*algorithm, ALGO_SELECTION) ? " only selects; it does not sort the whole array"
+                                                             : " has no whole-array sort (step-only)");
+        return nullptr;
+    }
+    return algorithm;
+}
+
+const AlgorithmInfo *pickFastestAlgorithm(const int sample[], int size, int requiredCapabilities)
+{
+    const AlgorithmInfo *fastest = nullptr;
+    std::chrono::steady_clock::duration fastestTime = std::chrono::steady_clock::duration::max();
+    std::vector<int> copy(size);
+    Arena &scratch = threadScratchArena();
+
+    for (AlgorithmInfo *algorithm : getAlgorithmsWithCapabilities(requiredCapabilities))
+    {
+        if (!isBulkSortEngine(*algorithm))
+            continue;
+
+        std::copy(sample, sample + size, copy.begin());
+        scratch.reset();
+        auto start = std::chrono::steady_clock::now();
+        algorithm->bulkFunction(copy.data(), size, scratch);
+        auto elapsed = std::chrono::steady_clock::now() - start;
+
+        if (elapsed < fastestTime)
+        {
+            fastestTime = elapsed;
+            fastest = algorithm;
+        }
+    }
+
+    return fastest;
+}
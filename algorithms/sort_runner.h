@@ -0,0 +1,51 @@
+#pragma once
+#include "algorithm_interface.h"
+#include "arena.h"
+#include <string>
+
+/**
+ * Helpers for running registered algorithms outside the visualizer
+ */
+
+/**
+ * Sort the whole array with an algorithm
+ * Uses the algorithm's bulk fast path when it has one, otherwise calls the
+ * step function until it reports completion. Selection algorithms only select
+ * k = selectionStepRank(size) this way; see runSelection
+ * @param scratch: Arena for the run's temporary memory; the caller resets it
+ */
+void runToCompletion(const AlgorithmInfo &algorithm, int array[], int size, Arena &scratch);
+
+/**
+ * Same, with the calling thread's scratch arena (reset before the run unless
+ * the thread is already inside another run)
+ */
+void runToCompletion(const AlgorithmInfo &algorithm, int array[], int size);
+
+/**
+ * Select the k smallest with an algorithm: its selection fast path if it has
+ * one, otherwise a full sort (which is also a valid selection)
+ */
+void runSelection(const AlgorithmInfo &algorithm, int array[], int size, int k);
+
+/**
+ * Whether an algorithm can sort bulk data: it has a whole-array fast path and
+ * is not a selection algorithm (which, run to completion, only selects)
+ * Step-only algorithms are for watching; on files and requests of real size
+ * they would run for hours
+ */
+bool isBulkSortEngine(const AlgorithmInfo &algorithm);
+
+/**
+ * Registered algorithm by name, for callers that sort whole arrays of bulk data
+ * @return nullptr, with error set, for an unknown name or an algorithm that
+ *         fails isBulkSortEngine
+ */
+const AlgorithmInfo *getBulkSortEngine(const char *name, std::string &error);
+
+/**
+ * Time every registered algorithm that has a bulk fast path on a copy of sample
+ * and return the fastest one (nullptr if none qualifies)
+ * @param requiredCapabilities: AlgorithmCapability flags the result must declare
+ */
+const AlgorithmInfo *pickFastestAlgorithm(const int sample[], int size, int requiredCapabilities = 0);
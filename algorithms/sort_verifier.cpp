@@ -0,0 +1,672 @@
+#include "sort_verifier.h"
+#include "algorithm_registry.h"
+#include "incremental_sort.h"
+#include "input_generator.h"
+#include "quick_sort.h"
+#include "sort_run.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <iterator>
+#include <random>
+#include <sstream>
+#include <vector>
+
+namespace
+{
+/**
+ * Packs a key and its original index into one int
+ *
+ * Comparison sorts only see the order of values, so they need the key in the
+ * high part (KEY_MAJOR). Digit sorts look at the low decimal digits first, so
+ * they need the key in the low digits (KEY_MINOR). Whichever packing makes the
+ * algorithm repeat the plain run move for move is the one whose tags are real.
+ */
+struct Packing
+{
+    enum Layout
+    {
+        KEY_MAJOR, // key * scale + tag
+        KEY_MINOR  // tag * scale + key
+    };
+
+    Layout layout;
+    int scale;
+
+    int pack(int key, int tag) const
+    {
+        return layout == KEY_MAJOR ? key * scale + tag : tag * scale + key;
+    }
+    int keyOf(int packed) const
+    {
+        return layout == KEY_MAJOR ? packed / scale : packed % scale;
+    }
+    int tagOf(int packed) const
+    {
+        return layout == KEY_MAJOR ? packed % scale : packed / scale;
+    }
+};
+
+/**
+ * What one step looked like from the outside
+ */
+struct StepRecord
+{
+    SwapResult result;
+    uint64_t arrayHash;
+};
+
+// FNV-1a over the keys, so the tagged run can be compared without storing every array
+template <typename KeyOf>
+uint64_t hashKeys(const std::vector<int> &array, KeyOf keyOf)
+{
+    uint64_t hash = 1469598103934665603ULL;
+    for (int value : array)
+    {
+        hash ^= static_cast<uint32_t>(keyOf(value));
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// Order-independent fingerprint of the keys: equal for any two permutations
+uint64_t multisetFingerprint(const std::vector<int> &array)
+{
+    uint64_t sum = 0;
+    for (int value : array)
+    {
+        uint64_t x = static_cast<uint32_t>(value) + 0x9e3779b97f4a7c15ULL;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+        sum += x ^ (x >> 31);
+    }
+    return sum;
+}
+
+/**
+ * What IncrementalSort::apply() should leave, computed from scratch: the
+ * array plus every added value minus every removed one, fully sorted
+ * @return false if the batch removes a value neither the array nor the batch holds
+ */
+bool expectedAfterBatch(const std::vector<int> &before, const std::vector<SortedChange> &changes,
+                        std::vector<int> &after)
+{
+    std::vector<int> grown = before;
+    std::vector<int> removed;
+    for (const SortedChange &change : changes)
+    {
+        if (change.type != CHANGE_INSERT)
+            removed.push_back(change.oldValue);
+        if (change.type != CHANGE_DELETE)
+            grown.push_back(change.newValue);
+    }
+    std::sort(grown.begin(), grown.end());
+    std::sort(removed.begin(), removed.end());
+
+    // Multiset difference: each removal takes away one equal value
+    after.clear();
+    std::set_difference(grown.begin(), grown.end(), removed.begin(), removed.end(), std::back_inserter(after));
+    return after.size() + removed.size() == grown.size();
+}
+
+/**
+ * Apply a batch and compare against expectedAfterBatch (a refused batch must
+ * leave the array as it was)
+ */
+void checkIncrementalBatch(IncrementalSort &incremental, const std::vector<SortedChange> &changes,
+                           const std::string &label, std::vector<std::string> &failures)
+{
+    std::vector<int> before = incremental.values();
+    std::vector<int> expected;
+    bool valid = expectedAfterBatch(before, changes, expected);
+
+    std::string error;
+    bool applied = incremental.apply(changes.data(), static_cast<int>(changes.size()), error);
+    const char *failure = nullptr;
+    if (applied != valid)
+        failure = applied ? "applied a batch that removes a missing value" : "refused a valid batch";
+    else if (incremental.values() != (valid ? expected : before))
+        failure = valid ? "result differs from a full sort" : "refused batch changed the array";
+
+    if (failure)
+    {
+        std::ostringstream oss;
+        oss << "IncrementalSort, " << label << ", n=" << before.size() << ", " << changes.size()
+            << " change(s): " << failure;
+        failures.push_back(oss.str());
+    }
+}
+
+bool sameStep(const SwapResult &a, const SwapResult &b)
+{
+    return a.index1 == b.index1 && a.index2 == b.index2 && a.swapped == b.swapped;
+}
+
+/**
+ * Whether a selection algorithm's step run left the right k smallest in front
+ */
+bool selectionCorrect(const AlgorithmInfo &algorithm, const std::vector<int> &array, const std::vector<int> &expected)
+{
+    int size = static_cast<int>(array.size());
+    int k = selectionStepRank(size);
+    if (hasCapabilities(algorithm, ALGO_PARTIAL_SORT))
+        return std::equal(array.begin(), array.begin() + k, expected.begin());
+    if (size == 0)
+        return true;
+
+    int nth = array[k];
+    return nth == expected[k] && std::all_of(array.begin(), array.begin() + k, [nth](int v) { return v <= nth; }) &&
+           std::all_of(array.begin() + k, array.end(), [nth](int v) { return v >= nth; });
+}
+
+/**
+ * Replay the run on packed values; returns false as soon as it takes a different move
+ * @param keys: The input keys minus base (all non-negative)
+ */
+bool replayTagged(const AlgorithmInfo &algorithm, const int keys[], int size, int base, const Packing &packing,
+                  const std::vector<StepRecord> &trace, std::vector<int> &tagged)
+{
+    tagged.resize(size);
+    for (int i = 0; i < size; i++)
+    {
+        tagged[i] = packing.pack(keys[i], i);
+    }
+    SortRun run;
+    run.start(algorithm, size);
+
+    for (size_t step = 0; step < trace.size(); step++)
+    {
+        SwapResult result = run.step(tagged.data());
+
+        bool last = step + 1 == trace.size();
+        if (!sameStep(result, trace[step].result) || (result.isComplete && !last))
+            return false;
+
+        auto keyOf = [&packing, base](int value) { return packing.keyOf(value) + base; };
+        if (hashKeys(tagged, keyOf) != trace[step].arrayHash)
+            return false;
+    }
+    return true;
+}
+}
+
+VerificationResult verifyAlgorithm(const AlgorithmInfo &algorithm, const int keys[], int size, long long maxSteps)
+{
+    VerificationResult result = {false, false, false, false, false, true, 0};
+
+    std::vector<int> array(keys, keys + size);
+    SortRun run;
+    run.start(algorithm, size);
+    std::vector<StepRecord> trace;
+
+    bool permuting = hasCapabilities(algorithm, ALGO_PERMUTING);
+    uint64_t fingerprint = multisetFingerprint(array);
+
+    auto identity = [](int value) { return value; };
+    while (result.steps < maxSteps)
+    {
+        SwapResult step = run.step(array.data());
+        result.steps++;
+        trace.push_back({step, hashKeys(array, identity)});
+
+        if (permuting && result.permutingEveryStep && multisetFingerprint(array) != fingerprint)
+            result.permutingEveryStep = false;
+
+        if (step.isComplete)
+        {
+            result.completed = true;
+            break;
+        }
+    }
+
+    std::vector<int> expected(keys, keys + size);
+    std::sort(expected.begin(), expected.end());
+
+    bool selection = hasCapabilities(algorithm, ALGO_SELECTION);
+    result.sorted = selection ? selectionCorrect(algorithm, array, expected) : std::is_sorted(array.begin(), array.end());
+    result.permutation = result.sorted && !selection
+                             ? array == expected
+                             : std::is_permutation(array.begin(), array.end(), expected.begin());
+
+    // Nothing to reorder
+    if (size < 2)
+    {
+        result.stabilityChecked = true;
+        result.stable = result.sorted && result.permutation;
+        return result;
+    }
+
+    // Tags only fit next to non-negative keys that leave room in an int, so
+    // negative keys are replayed shifted up by the minimum (same order)
+    int64_t base = std::min<int64_t>(expected.front(), 0);
+    int64_t maxKey = static_cast<int64_t>(expected.back()) - base;
+    if (maxKey > INT_MAX)
+        return result;
+
+    std::vector<int> rebased(keys, keys + size);
+    for (int &key : rebased)
+    {
+        key = static_cast<int>(key - base);
+    }
+
+    int64_t decimalScale = 10;
+    while (decimalScale <= maxKey)
+    {
+        decimalScale *= 10;
+    }
+
+    std::vector<Packing> packings;
+    if (maxKey * size + size <= INT_MAX)
+    {
+        packings.push_back({Packing::KEY_MAJOR, size});
+    }
+    if (decimalScale * size <= INT_MAX)
+    {
+        packings.push_back({Packing::KEY_MINOR, static_cast<int>(decimalScale)});
+    }
+
+    std::vector<int> tagged;
+    for (const Packing &packing : packings)
+    {
+        if (!replayTagged(algorithm, rebased.data(), size, static_cast<int>(base), packing, trace, tagged))
+            continue;
+
+        result.stabilityChecked = true;
+        result.stable = result.sorted && result.permutation;
+        for (int i = 0; result.stable && i + 1 < size; i++)
+        {
+            if (array[i] == array[i + 1] && packing.tagOf(tagged[i]) > packing.tagOf(tagged[i + 1]))
+            {
+                result.stable = false;
+            }
+        }
+        break;
+    }
+
+    // A key-major replay only breaks away when ties were decided against index order
+    if (!result.stabilityChecked && !packings.empty() && packings.front().layout == Packing::KEY_MAJOR)
+    {
+        result.stabilityChecked = true;
+        result.stable = false;
+    }
+
+    return result;
+}
+
+VerificationResult verifyAlgorithm(const AlgorithmInfo &algorithm, int size)
+{
+    // Few distinct keys so that most keys have equal partners to be ordered against
+    std::mt19937 gen(20240 + size);
+    std::uniform_int_distribution<int> dist(1, std::max(2, size / 3));
+
+    std::vector<int> keys(size);
+    for (int i = 0; i < size; i++)
+    {
+        keys[i] = dist(gen);
+    }
+
+    return verifyAlgorithm(algorithm, keys.data(), size, verificationStepBound(size));
+}
+
+long long verificationStepBound(int size)
+{
+    long long n = size;
+    return 4 * n * n + 32 * n + 256;
+}
+
+bool verificationPassed(const AlgorithmInfo &algorithm, const VerificationResult &result)
+{
+    if (!result.completed || !result.sorted || !result.permutation)
+        return false;
+    if (!result.permutingEveryStep && hasCapabilities(algorithm, ALGO_PERMUTING))
+        return false;
+
+    // Keys too wide to tag leave stability unknown rather than broken
+    return result.stable || !result.stabilityChecked || !hasCapabilities(algorithm, ALGO_STABLE);
+}
+
+std::string describeVerification(const AlgorithmInfo &algorithm, const VerificationResult &result)
+{
+    bool declaredStable = hasCapabilities(algorithm, ALGO_STABLE);
+
+    std::ostringstream oss;
+    oss << "Verify: " << (verificationPassed(algorithm, result) ? "PASS" : "FAIL")
+        << " | completed " << (result.completed ? "OK" : "FAIL")
+        << (hasCapabilities(algorithm, ALGO_SELECTION) ? " | selected " : " | sorted ")
+        << (result.sorted ? "OK" : "FAIL")
+        << " | permutation " << (result.permutation ? "OK" : "FAIL")
+        << " | stable " << (!result.stabilityChecked ? "n/a" : result.stable ? "yes" : "no")
+        << (declaredStable ? " (declared)" : " (not declared)");
+    if (hasCapabilities(algorithm, ALGO_PERMUTING))
+        oss << " | permuting " << (result.permutingEveryStep ? "OK" : "FAIL");
+    oss << " | steps " << result.steps;
+    return oss.str();
+}
+
+const char *verificationInputName(VerificationInput input)
+{
+    switch (input)
+    {
+    case INPUT_RANDOM:
+        return "random";
+    case INPUT_SORTED:
+        return "sorted";
+    case INPUT_REVERSED:
+        return "reversed";
+    case INPUT_EQUAL:
+        return "all equal";
+    case INPUT_FEW_DISTINCT:
+        return "few distinct";
+    case INPUT_NEGATIVE:
+        return "negative";
+    case INPUT_EXTREMES:
+        return "extremes";
+    case INPUT_ORGAN_PIPE:
+        return "organ pipe";
+    case INPUT_QUICKSORT_KILLER:
+        return "quicksort killer";
+    default:
+        return "unknown";
+    }
+}
+
+void makeVerificationInput(VerificationInput input, int size, unsigned seed, std::vector<int> &keys)
+{
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<int> any(INT_MIN, INT_MAX);
+    keys.resize(size);
+
+    // Built by replaying the sort rather than element by element
+    if (input == INPUT_QUICKSORT_KILLER)
+    {
+        InputSpec spec;
+        spec.distribution = DIST_MEDIAN3_KILLER;
+        spec.seed = seed;
+        generateInput(spec, keys.data(), size);
+        return;
+    }
+
+    for (int i = 0; i < size; i++)
+    {
+        switch (input)
+        {
+        case INPUT_RANDOM:
+            keys[i] = static_cast<int>(gen() % 1000);
+            break;
+        case INPUT_SORTED:
+            keys[i] = i;
+            break;
+        case INPUT_REVERSED:
+            keys[i] = size - i;
+            break;
+        case INPUT_EQUAL:
+            keys[i] = 7;
+            break;
+        case INPUT_FEW_DISTINCT:
+            keys[i] = static_cast<int>(gen() % 3);
+            break;
+        case INPUT_NEGATIVE:
+            keys[i] = static_cast<int>(gen() % 2001) - 1000;
+            break;
+        case INPUT_EXTREMES:
+            {
+                // The ends of the range, their neighbours, zero and anything in between
+                static const int edges[] = {INT_MIN, INT_MIN + 1, -1, 0, 1, INT_MAX - 1, INT_MAX};
+                unsigned pick = gen() % 10;
+                keys[i] = pick < 7 ? edges[pick] : any(gen);
+                break;
+            }
+        default: // INPUT_ORGAN_PIPE
+            keys[i] = std::min(i, size - 1 - i);
+            break;
+        }
+    }
+}
+
+std::string verifyFastPath(const AlgorithmInfo &algorithm, const std::vector<int> &keys, Arena &scratch)
+{
+    if (!algorithm.bulkFunction && !algorithm.selectFunction)
+        return "";
+
+    std::vector<int> array = keys;
+    std::vector<int> expected = keys;
+    std::sort(expected.begin(), expected.end());
+    int size = static_cast<int>(array.size());
+
+    scratch.reset();
+    if (algorithm.selectFunction)
+    {
+        algorithm.selectFunction(array.data(), size, selectionStepRank(size));
+        if (!std::is_permutation(array.begin(), array.end(), expected.begin()))
+            return "fast path lost or invented keys";
+        return selectionCorrect(algorithm, array, expected) ? "" : "fast path selected wrongly";
+    }
+
+    algorithm.bulkFunction(array.data(), size, scratch);
+    if (array == expected)
+        return "";
+    return std::is_sorted(array.begin(), array.end()) ? "fast path lost or invented keys" : "fast path left it unsorted";
+}
+
+std::vector<std::string> verifyAllAlgorithms(int maxSize, unsigned seed)
+{
+    // Every size up to 17 (the small-size special cases), then around powers of two
+    std::vector<int> sizes;
+    for (int size = 0; size <= std::min(maxSize, 17); size++)
+    {
+        sizes.push_back(size);
+    }
+    for (int power = 32; power <= maxSize; power *= 2)
+    {
+        sizes.push_back(power - 1);
+        sizes.push_back(power);
+        if (power + 1 <= maxSize)
+            sizes.push_back(power + 1);
+    }
+    if (sizes.back() != maxSize)
+        sizes.push_back(maxSize);
+
+    std::vector<std::string> failures;
+    std::vector<int> keys;
+    Arena scratch;
+
+    for (int index = 0; index < getAlgorithmCount(); index++)
+    {
+        const AlgorithmInfo &algorithm = *getAlgorithmByIndex(index);
+        for (int size : sizes)
+        {
+            for (int input = 0; input < INPUT_COUNT; input++)
+            {
+                makeVerificationInput(static_cast<VerificationInput>(input), size, seed + size * INPUT_COUNT + input,
+                                      keys);
+
+                std::string failure;
+                VerificationResult result =
+                    verifyAlgorithm(algorithm, keys.data(), size, verificationStepBound(size));
+                if (!verificationPassed(algorithm, result))
+                    failure = describeVerification(algorithm, result);
+                else
+                    failure = verifyFastPath(algorithm, keys, scratch);
+
+                if (!failure.empty())
+                {
+                    std::ostringstream oss;
+                    oss << algorithm.name << ", " << verificationInputName(static_cast<VerificationInput>(input))
+                        << ", n=" << size << ", seed " << seed << ": " << failure;
+                    failures.push_back(oss.str());
+                }
+            }
+        }
+    }
+    return failures;
+}
+
+std::vector<std::string> verifyQuickSortGuard(unsigned seed)
+{
+    const int STEP_SIZE = 1 << 12;
+    const double STEP_BUDGET = 4.0; // Steps per n log2(n); every family needs under 2
+    const int BULK_SIZE = 1 << 17;
+
+    std::vector<std::string> failures;
+    const AlgorithmInfo *quickSort = getAlgorithmByName("Quick Sort");
+    if (!quickSort || !quickSort->bulkFunction)
+    {
+        failures.push_back("Quick Sort is not registered with a whole-array path");
+        return failures;
+    }
+
+    // Step path: first-element pivots, so sorted and reversed inputs are its killers
+    long long budget = static_cast<long long>(STEP_BUDGET * STEP_SIZE * std::log2(STEP_SIZE));
+    std::vector<int> keys;
+    for (int input = 0; input < INPUT_COUNT; input++)
+    {
+        makeVerificationInput(static_cast<VerificationInput>(input), STEP_SIZE, seed + input, keys);
+        std::vector<int> expected = keys;
+        std::sort(expected.begin(), expected.end());
+
+        SortRun run;
+        run.start(*quickSort, STEP_SIZE);
+        long long steps = 1;
+        while (steps <= budget && !run.step(keys.data()).isComplete)
+        {
+            steps++;
+        }
+
+        if (steps > budget || keys != expected)
+        {
+            std::ostringstream oss;
+            oss << "Quick Sort guard, " << verificationInputName(static_cast<VerificationInput>(input))
+                << ", n=" << STEP_SIZE << ", seed " << seed << ": "
+                << (steps > budget ? "step function over its n log n budget of " : "step function left it unsorted, ")
+                << budget << " steps";
+            failures.push_back(oss.str());
+        }
+    }
+
+    // Whole-array path: median-of-3 killer, quadratic unless the guard steps in
+    InputSpec spec;
+    spec.distribution = DIST_MEDIAN3_KILLER;
+    spec.seed = seed;
+    keys.resize(BULK_SIZE);
+    generateInput(spec, keys.data(), BULK_SIZE);
+
+    QuickSortGuardCounts before = quickSortGuardCounts();
+    Arena scratch;
+    quickSort->bulkFunction(keys.data(), BULK_SIZE, scratch);
+    QuickSortGuardCounts after = quickSortGuardCounts();
+
+    bool sorted = true;
+    for (int i = 0; i < BULK_SIZE && sorted; i++)
+    {
+        sorted = keys[i] == i + 1;
+    }
+    if (!sorted)
+        failures.push_back("Quick Sort guard, median-of-3 killer, n=" + std::to_string(BULK_SIZE) +
+                           ": fast path left it unsorted");
+    if (after.pivotShuffles == before.pivotShuffles && after.heapFallbacks == before.heapFallbacks)
+        failures.push_back("Quick Sort guard, median-of-3 killer, n=" + std::to_string(BULK_SIZE) +
+                           ": fast path never shuffled a pivot or fell back to heap sort");
+    return failures;
+}
+
+std::vector<std::string> verifyIncrementalSort(unsigned seed)
+{
+    const int ROUNDS = 200;
+    const int BATCHES_PER_ROUND = 6;
+    const int MAX_SIZE = 1000;
+
+    std::vector<std::string> failures;
+    std::mt19937 gen(seed);
+    IncrementalSort incremental;
+    std::vector<SortedChange> changes;
+
+    // The edge cases by name, on an array with runs of duplicates
+    std::vector<int> base;
+    for (int i = 0; i < 64; i++)
+    {
+        base.push_back(i / 4);
+    }
+
+    incremental.assign(base);
+    checkIncrementalBatch(incremental, changes, "empty batch", failures);
+
+    changes.clear();
+    for (int value : base)
+    {
+        changes.push_back({CHANGE_DELETE, value, 0});
+    }
+    incremental.assign(base);
+    checkIncrementalBatch(incremental, changes, "delete every element", failures);
+    checkIncrementalBatch(incremental, changes, "delete from an empty array", failures);
+
+    changes.assign({{CHANGE_DELETE, 3, 0}, {CHANGE_DELETE, 1000, 0}});
+    incremental.assign(base);
+    checkIncrementalBatch(incremental, changes, "delete absent value", failures);
+
+    changes.assign(5, SortedChange{CHANGE_DELETE, 7, 0});
+    checkIncrementalBatch(incremental, changes, "delete more copies than held", failures);
+
+    changes.assign({{CHANGE_UPDATE, 5, 9}, {CHANGE_UPDATE, 5, 2}, {CHANGE_UPDATE, 9, 9}, {CHANGE_UPDATE, 5, 5}});
+    checkIncrementalBatch(incremental, changes, "updates on duplicates", failures);
+
+    changes.assign({{CHANGE_INSERT, 0, INT_MIN}, {CHANGE_INSERT, 0, INT_MAX}, {CHANGE_INSERT, 0, -1},
+                    {CHANGE_INSERT, 0, 100}, {CHANGE_INSERT, 0, INT_MIN}});
+    checkIncrementalBatch(incremental, changes, "inserts at both ends", failures);
+
+    changes.assign({{CHANGE_INSERT, 0, 42}, {CHANGE_DELETE, 42, 0}, {CHANGE_UPDATE, 42, 43}});
+    checkIncrementalBatch(incremental, changes, "removing values added by the same batch", failures);
+
+    // Random arrays and batches against a full sort
+    for (int round = 0; round < ROUNDS; round++)
+    {
+        int size = static_cast<int>(gen() % (MAX_SIZE + 1));
+        int range = gen() % 2 ? 16 : 1 << 20; // Heavy duplicates, or mostly distinct
+        std::vector<int> values(size);
+        for (int &value : values)
+        {
+            value = static_cast<int>(gen() % range);
+        }
+        incremental.assign(values);
+
+        for (int batch = 0; batch < BATCHES_PER_ROUND; batch++)
+        {
+            const std::vector<int> &current = incremental.values();
+            int count = static_cast<int>(gen() % (current.size() / 2 + 8));
+            changes.clear();
+            for (int i = 0; i < count; i++)
+            {
+                // Removals mostly name a value the array holds
+                int held = current.empty() ? 0 : current[gen() % current.size()];
+                int fresh = static_cast<int>(gen() % range);
+                switch (gen() % 8)
+                {
+                case 0:
+                    changes.push_back({CHANGE_INSERT, 0, gen() % 2 ? INT_MIN + static_cast<int>(gen() % 4)
+                                                                    : INT_MAX - static_cast<int>(gen() % 4)});
+                    break;
+                case 1:
+                case 2:
+                    changes.push_back({CHANGE_INSERT, 0, fresh});
+                    break;
+                case 3:
+                case 4:
+                    changes.push_back({CHANGE_DELETE, held, 0});
+                    break;
+                default:
+                    changes.push_back({CHANGE_UPDATE, held, fresh});
+                    break;
+                }
+            }
+
+            // Now and then a value that is nowhere, which must refuse the whole batch
+            if (count > 0 && gen() % 10 == 0)
+                changes[gen() % count] = {CHANGE_DELETE, -1 - static_cast<int>(gen() % 100), 0};
+
+            std::ostringstream label;
+            label << "random batch, seed " << seed << ", round " << round;
+            checkIncrementalBatch(incremental, changes, label.str(), failures);
+        }
+    }
+    return failures;
+}
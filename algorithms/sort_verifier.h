@@ -0,0 +1,115 @@
+#pragma once
+#include "algorithm_interface.h"
+#include "arena.h"
+#include <string>
+#include <vector>
+
+/**
+ * Verification mode for registered algorithms
+ * Drives an algorithm's step function to completion and checks the result
+ * against the capabilities the algorithm declares
+ *
+ * Stability is checked by replaying the run on tagged key/index pairs packed
+ * into one int. The tagged run only counts if it makes exactly the same moves
+ * as the plain run; then the tags show where every original index ended up.
+ */
+
+struct VerificationResult
+{
+    bool completed;        // isComplete was reported within the step bound
+    bool sorted;           // Final array is in non-decreasing order (selection algorithms:
+                           // the selection at k = selectionStepRank(size) is right)
+    bool permutation;      // Final array holds exactly the input keys
+    bool stable;           // Equal keys kept the order of their original indices
+    bool stabilityChecked; // False if no tagged replay could follow the run
+    bool permutingEveryStep; // Every intermediate array held exactly the input keys
+                             // (only checked for ALGO_PERMUTING algorithms)
+    long long steps;       // Number of calls made to the step function
+};
+
+/**
+ * Run an algorithm on a copy of keys and verify the outcome
+ * @param algorithm: Algorithm to verify
+ * @param keys: Input keys (duplicates are what make the stability check meaningful)
+ * @param size: Number of keys
+ * @param maxSteps: Give up after this many calls to the step function
+ */
+VerificationResult verifyAlgorithm(const AlgorithmInfo &algorithm, const int keys[], int size, long long maxSteps);
+
+/**
+ * Verify an algorithm on a reproducible duplicate-heavy input of the given size
+ */
+VerificationResult verifyAlgorithm(const AlgorithmInfo &algorithm, int size);
+
+/**
+ * Step calls any registered algorithm may need for size elements: quadratic
+ * sorts, and radix passes over all ten decimal digits of an int (quadratic, so
+ * it needs more than an int past about 23000 elements)
+ */
+long long verificationStepBound(int size);
+
+/**
+ * True if the result is a sorted permutation and every declared guarantee held
+ * (stability counts as held when the keys were too wide to check it)
+ */
+bool verificationPassed(const AlgorithmInfo &algorithm, const VerificationResult &result);
+
+/**
+ * One-line human readable summary, e.g. "Verify: sorted OK | permutation OK | stable FAIL"
+ */
+std::string describeVerification(const AlgorithmInfo &algorithm, const VerificationResult &result);
+
+/**
+ * Run the algorithm's whole-array path (bulk sort, or selection at
+ * k = selectionStepRank(size)) on a copy of keys
+ * @return Empty if the result was right (or there is no such path),
+ *         otherwise what went wrong
+ */
+std::string verifyFastPath(const AlgorithmInfo &algorithm, const std::vector<int> &keys, Arena &scratch);
+
+/**
+ * Input families of the verification suite
+ */
+enum VerificationInput
+{
+    INPUT_RANDOM,           // 0..999
+    INPUT_SORTED,
+    INPUT_REVERSED,
+    INPUT_EQUAL,
+    INPUT_FEW_DISTINCT,     // 0..2
+    INPUT_NEGATIVE,         // -1000..1000
+    INPUT_EXTREMES,         // INT_MIN, INT_MAX and their neighbours, mixed with anything
+    INPUT_ORGAN_PIPE,       // Rising then falling
+    INPUT_QUICKSORT_KILLER, // McIlroy's adversary against median-of-3 Quick Sort (generateInput)
+    INPUT_COUNT
+};
+
+const char *verificationInputName(VerificationInput input);
+void makeVerificationInput(VerificationInput input, int size, unsigned seed, std::vector<int> &keys);
+
+/**
+ * Verification suite: every registered algorithm's step function, driven to
+ * completion within verificationStepBound(), then its whole-array path (bulk
+ * sort or selection), on every input family at sizes 0..17 and around each
+ * power of two up to maxSize
+ * @return One line per failing case; empty if everything passed
+ */
+std::vector<std::string> verifyAllAlgorithms(int maxSize, unsigned seed);
+
+/**
+ * Quick Sort's bad split guard against adversarial input
+ * The step function must finish every input family of 2^12 keys within
+ * 4 n log2(n) steps (sorted input alone takes n^2 / 2 without the guard), and
+ * the whole-array path must sort a 2^17 median-of-3 killer with the guard's
+ * counters moving
+ * @return One line per failing case; empty if everything passed
+ */
+std::vector<std::string> verifyQuickSortGuard(unsigned seed);
+
+/**
+ * IncrementalSort::apply() against a full sort of the same multiset: named
+ * edge cases (empty batch, deleting everything, absent values, updates among
+ * duplicates, inserts at both ends) and random batches on random arrays
+ * @return One line per failing case; empty if everything passed
+ */
+std::vector<std::string> verifyIncrementalSort(unsigned seed);
@@ -0,0 +1,532 @@
+#include "string_sort.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+// Buckets and partitions this small are finished by insertion sort
+static const size_t INSERTION_SORT_MAX = 16;
+// Batches larger than this use the thread pool
+static const size_t PARALLEL_ABOVE = 1 << 16;
+// Bytes cached per string
+static const size_t CACHE_BYTES = 8;
+// The LCP merge sort's initial runs, sorted by MSD radix
+static const size_t LCP_RUN_MAX = 1 << 12;
+
+namespace
+{
+/**
+ * A string's index, length and the 8 bytes from cacheDepth on (big-endian,
+ * zero-padded past the end), so comparing the words compares the bytes
+ */
+struct CachedString
+{
+    uint64_t prefix;
+    uint32_t index;
+    uint32_t length;
+};
+
+const unsigned char *stringBytes(const StringBatch &batch, uint32_t index)
+{
+    return reinterpret_cast<const unsigned char *>(batch.bytes) + batch.offsets[index];
+}
+
+uint32_t stringLength(const StringBatch &batch, uint32_t index)
+{
+    return static_cast<uint32_t>(batch.offsets[index + 1] - batch.offsets[index]);
+}
+
+uint64_t loadBigEndian(const unsigned char *bytes)
+{
+    uint64_t value = 0;
+    for (size_t i = 0; i < CACHE_BYTES; i++)
+        value = value << 8 | bytes[i];
+    return value;
+}
+
+uint64_t loadPrefix(const unsigned char *bytes, uint32_t length, size_t depth)
+{
+    if (depth + CACHE_BYTES <= length)
+        return loadBigEndian(bytes + depth);
+
+    uint64_t value = 0;
+    for (size_t i = 0; i < CACHE_BYTES; i++)
+        value = value << 8 | (depth + i < length ? bytes[depth + i] : 0);
+    return value;
+}
+
+void fillCache(const StringBatch &batch, CachedString items[], size_t count, size_t depth)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        items[i].prefix = loadPrefix(stringBytes(batch, items[i].index), items[i].length, depth);
+    }
+}
+
+/**
+ * First position from depth on where x and y differ, or the shorter length
+ * @param order: Receives <0, 0 or >0 as x sorts before, with or after y
+ */
+size_t commonPrefixFrom(const unsigned char *x, uint32_t xLength, const unsigned char *y, uint32_t yLength,
+                        size_t depth, int &order)
+{
+    size_t limit = std::min(xLength, yLength);
+    size_t position = depth;
+    while (position + CACHE_BYTES <= limit && std::memcmp(x + position, y + position, CACHE_BYTES) == 0)
+        position += CACHE_BYTES;
+    while (position < limit && x[position] == y[position])
+        position++;
+
+    if (position < limit)
+        order = x[position] < y[position] ? -1 : 1;
+    else
+        order = xLength < yLength ? -1 : (xLength > yLength ? 1 : 0);
+    return position;
+}
+
+/**
+ * Order of two strings that agree before cacheDepth, caches filled there
+ */
+bool cachedLess(const StringBatch &batch, const CachedString &x, const CachedString &y, size_t cacheDepth)
+{
+    if (x.prefix != y.prefix)
+        return x.prefix < y.prefix;
+
+    // The cached words cannot tell "a" from "a\0"; past them, read the bytes
+    size_t end = cacheDepth + CACHE_BYTES;
+    if (x.length <= end || y.length <= end)
+        return x.length < y.length;
+    int order;
+    commonPrefixFrom(stringBytes(batch, x.index), x.length, stringBytes(batch, y.index), y.length, end, order);
+    return order < 0;
+}
+
+void insertionSortCached(const StringBatch &batch, CachedString items[], size_t count, size_t cacheDepth)
+{
+    for (size_t i = 1; i < count; i++)
+    {
+        CachedString item = items[i];
+        size_t j = i;
+        for (; j > 0 && cachedLess(batch, item, items[j - 1], cacheDepth); j--)
+            items[j] = items[j - 1];
+        items[j] = item;
+    }
+}
+
+/**
+ * Byte depth of the string plus one, or 0 if the string has ended: ended
+ * strings sort first
+ */
+int radixBucket(const CachedString &item, size_t depth, size_t cacheDepth)
+{
+    if (item.length <= depth)
+        return 0;
+    return static_cast<int>((item.prefix >> (8 * (CACHE_BYTES - 1 - (depth - cacheDepth)))) & 0xFF) + 1;
+}
+
+/**
+ * Bytes from depth on that every string has and shares, up to the end of the
+ * cached words: one pass skips what would be up to 8 single-byte levels
+ */
+size_t sharedCachedBytes(const CachedString items[], size_t count, size_t depth, size_t cacheDepth)
+{
+    uint64_t differ = 0;
+    uint32_t shortest = items[0].length;
+    for (size_t i = 1; i < count; i++)
+    {
+        differ |= items[i].prefix ^ items[0].prefix;
+        shortest = std::min(shortest, items[i].length);
+    }
+
+    size_t sameBytes = 0;
+    while (sameBytes < CACHE_BYTES && (differ >> (8 * (CACHE_BYTES - 1 - sameBytes)) & 0xFF) == 0)
+        sameBytes++;
+    size_t shared = cacheDepth + sameBytes - depth;
+    return shortest > depth ? std::min<size_t>(shared, shortest - depth) : 0;
+}
+
+/**
+ * Strings in items agree on their first depth bytes; caches hold the 8
+ * bytes from cacheDepth
+ */
+void msdRadixSort(const StringBatch &batch, CachedString items[], CachedString buffer[], size_t count, size_t depth,
+                  size_t cacheDepth, bool parallel)
+{
+    for (;;)
+    {
+        if (depth >= cacheDepth + CACHE_BYTES)
+        {
+            fillCache(batch, items, count, depth);
+            cacheDepth = depth;
+        }
+        if (count <= INSERTION_SORT_MAX)
+        {
+            insertionSortCached(batch, items, count, cacheDepth);
+            return;
+        }
+
+        // Skip the bytes every string shares; if that empties the cache, refill
+        depth += sharedCachedBytes(items, count, depth, cacheDepth);
+        if (depth < cacheDepth + CACHE_BYTES)
+            break;
+    }
+
+    size_t counts[257] = {};
+    for (size_t i = 0; i < count; i++)
+    {
+        counts[radixBucket(items[i], depth, cacheDepth)]++;
+    }
+    // All ended: equal strings
+    if (counts[0] == count)
+        return;
+
+    size_t starts[258];
+    size_t offset = 0;
+    for (int bucket = 0; bucket < 257; bucket++)
+    {
+        starts[bucket] = offset;
+        offset += counts[bucket];
+        counts[bucket] = starts[bucket];
+    }
+    starts[257] = count;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        buffer[counts[radixBucket(items[i], depth, cacheDepth)]++] = items[i];
+    }
+    std::copy(buffer, buffer + count, items);
+
+    // Bucket 0 holds the strings that ended at depth, all equal
+    auto sortBuckets = [=, &starts, &batch](long long first, long long last) {
+        for (long long bucket = first; bucket < last; bucket++)
+        {
+            size_t begin = starts[bucket];
+            size_t size = starts[bucket + 1] - begin;
+            if (size > 1)
+                msdRadixSort(batch, items + begin, buffer + begin, size, depth + 1, cacheDepth, false);
+        }
+    };
+    if (parallel)
+        parallelFor(1, 257, 1, sortBuckets);
+    else
+        sortBuckets(1, 257);
+}
+
+void multikeyQuicksort(const StringBatch &batch, CachedString items[], size_t count, size_t depth, size_t cacheDepth)
+{
+    for (;;)
+    {
+        if (depth >= cacheDepth + CACHE_BYTES)
+        {
+            fillCache(batch, items, count, depth);
+            cacheDepth = depth;
+        }
+        if (count <= INSERTION_SORT_MAX)
+        {
+            insertionSortCached(batch, items, count, cacheDepth);
+            return;
+        }
+        size_t shared = sharedCachedBytes(items, count, depth, cacheDepth);
+        if (shared > 0)
+        {
+            depth += shared;
+            continue;
+        }
+
+        // Median of three bytes
+        int first = radixBucket(items[0], depth, cacheDepth);
+        int middle = radixBucket(items[count / 2], depth, cacheDepth);
+        int last = radixBucket(items[count - 1], depth, cacheDepth);
+        int pivot = std::max(std::min(first, middle), std::min(std::max(first, middle), last));
+
+        // Three-way partition: [0, less) below, [less, greater) equal, [greater, count) above
+        size_t less = 0;
+        size_t i = 0;
+        size_t greater = count;
+        while (i < greater)
+        {
+            int bucket = radixBucket(items[i], depth, cacheDepth);
+            if (bucket < pivot)
+                std::swap(items[less++], items[i++]);
+            else if (bucket > pivot)
+                std::swap(items[i], items[--greater]);
+            else
+                i++;
+        }
+
+        if (less > 1)
+            multikeyQuicksort(batch, items, less, depth, cacheDepth);
+        if (count - greater > 1)
+            multikeyQuicksort(batch, items + greater, count - greater, depth, cacheDepth);
+
+        // The middle agrees one byte further; if those strings ended, they are equal
+        if (pivot == 0 || greater - less < 2)
+            return;
+        items += less;
+        count = greater - less;
+        depth++;
+    }
+}
+
+/**
+ * A sorted run for the LCP merge sort: per string its LCP with the string
+ * before it (0 for the first), and its byte at that position as
+ * characterAt() gives it, so ties on the LCP are mostly settled without
+ * reading the strings
+ */
+struct LcpRun
+{
+    uint32_t *strings;
+    uint32_t *lcp;
+    uint16_t *next;
+};
+
+/**
+ * Byte position of a string plus one, 0 past its end (which sorts first)
+ */
+uint16_t characterAt(const StringBatch &batch, uint32_t index, size_t position)
+{
+    return position < stringLength(batch, index) ? stringBytes(batch, index)[position] + 1 : 0;
+}
+
+/**
+ * Sort an initial run with the MSD radix sort (stable), then record its LCPs
+ * @param items, buffer: Room for count cached strings
+ */
+void sortInitialRun(const StringBatch &batch, const LcpRun &run, size_t count, CachedString items[],
+                    CachedString buffer[])
+{
+    uint32_t *strings = run.strings;
+    for (size_t i = 0; i < count; i++)
+    {
+        items[i].index = strings[i];
+        items[i].length = stringLength(batch, strings[i]);
+    }
+    fillCache(batch, items, count, 0);
+    msdRadixSort(batch, items, buffer, count, 0, 0, false);
+    for (size_t i = 0; i < count; i++)
+        strings[i] = items[i].index;
+
+    run.lcp[0] = 0;
+    run.next[0] = characterAt(batch, strings[0], 0);
+    for (size_t i = 1; i < count; i++)
+    {
+        int order;
+        size_t common = commonPrefixFrom(stringBytes(batch, strings[i - 1]), stringLength(batch, strings[i - 1]),
+                                         stringBytes(batch, strings[i]), stringLength(batch, strings[i]), 0, order);
+        run.lcp[i] = static_cast<uint32_t>(common);
+        run.next[i] = characterAt(batch, strings[i], common);
+    }
+}
+
+/**
+ * Merge two sorted runs into out
+ *
+ * Each side tracks the LCP of its next string with the last one written, and
+ * that string's byte there. If the LCPs differ, the side with the longer one
+ * holds the smaller string; if they are equal, the bytes after them decide;
+ * only if those are equal too are the strings read, from one byte further.
+ */
+void lcpMerge(const StringBatch &batch, const LcpRun &left, size_t leftCount, const LcpRun &right, size_t rightCount,
+              const LcpRun &out)
+{
+    size_t i = 0, j = 0, k = 0;
+    uint32_t leftCommon = 0, rightCommon = 0;
+    uint16_t leftNext = left.next[0], rightNext = right.next[0];
+    while (i < leftCount && j < rightCount)
+    {
+        bool takeLeft;
+        if (leftCommon != rightCommon)
+        {
+            takeLeft = leftCommon > rightCommon;
+        }
+        else if (leftNext != rightNext || leftNext == 0)
+        {
+            takeLeft = leftNext <= rightNext; // Equal strings: the left run first, so the sort is stable
+        }
+        else
+        {
+            int order;
+            uint32_t common = static_cast<uint32_t>(commonPrefixFrom(
+                stringBytes(batch, left.strings[i]), stringLength(batch, left.strings[i]),
+                stringBytes(batch, right.strings[j]), stringLength(batch, right.strings[j]), leftCommon + 1, order));
+            takeLeft = order <= 0;
+            if (takeLeft)
+            {
+                rightCommon = common;
+                rightNext = characterAt(batch, right.strings[j], common);
+            }
+            else
+            {
+                leftCommon = common;
+                leftNext = characterAt(batch, left.strings[i], common);
+            }
+        }
+
+        if (takeLeft)
+        {
+            out.strings[k] = left.strings[i];
+            out.lcp[k] = leftCommon;
+            out.next[k++] = leftNext;
+            i++;
+            if (i < leftCount)
+            {
+                leftCommon = left.lcp[i];
+                leftNext = left.next[i];
+            }
+        }
+        else
+        {
+            out.strings[k] = right.strings[j];
+            out.lcp[k] = rightCommon;
+            out.next[k++] = rightNext;
+            j++;
+            if (j < rightCount)
+            {
+                rightCommon = right.lcp[j];
+                rightNext = right.next[j];
+            }
+        }
+    }
+
+    // The first string left over continues from the last one written
+    for (bool first = true; i < leftCount; i++, first = false)
+    {
+        out.strings[k] = left.strings[i];
+        out.lcp[k] = first ? leftCommon : left.lcp[i];
+        out.next[k++] = first ? leftNext : left.next[i];
+    }
+    for (bool first = true; j < rightCount; j++, first = false)
+    {
+        out.strings[k] = right.strings[j];
+        out.lcp[k] = first ? rightCommon : right.lcp[j];
+        out.next[k++] = first ? rightNext : right.next[j];
+    }
+}
+
+LcpRun offsetRun(const LcpRun &run, size_t offset)
+{
+    return {run.strings + offset, run.lcp + offset, run.next + offset};
+}
+
+/**
+ * @param items, cacheBuffer: Room for count cached strings, for the initial runs
+ */
+void lcpMergeSort(const StringBatch &batch, const LcpRun &run, const LcpRun &buffer, size_t count,
+                  CachedString items[], CachedString cacheBuffer[], bool parallel)
+{
+    if (count <= LCP_RUN_MAX)
+    {
+        sortInitialRun(batch, run, count, items, cacheBuffer);
+        return;
+    }
+
+    size_t half = count / 2;
+    LcpRun rightRun = offsetRun(run, half);
+    auto sortLeft = [&] { lcpMergeSort(batch, run, buffer, half, items, cacheBuffer, false); };
+    auto sortRight = [&] {
+        lcpMergeSort(batch, rightRun, offsetRun(buffer, half), count - half, items + half, cacheBuffer + half, false);
+    };
+    if (parallel)
+        parallelInvoke(sortLeft, sortRight);
+    else
+    {
+        sortLeft();
+        sortRight();
+    }
+
+    lcpMerge(batch, run, half, rightRun, count - half, buffer);
+    std::copy(buffer.strings, buffer.strings + count, run.strings);
+    std::copy(buffer.lcp, buffer.lcp + count, run.lcp);
+    std::copy(buffer.next, buffer.next + count, run.next);
+}
+
+CachedString *cacheStrings(const StringBatch &batch, Arena &scratch)
+{
+    CachedString *items = scratch.allocateArray<CachedString>(batch.count);
+    for (size_t i = 0; i < batch.count; i++)
+    {
+        items[i].index = static_cast<uint32_t>(i);
+        items[i].length = stringLength(batch, static_cast<uint32_t>(i));
+    }
+    fillCache(batch, items, batch.count, 0);
+    return items;
+}
+} // namespace
+
+const char *stringSortEngineName(StringSortEngine engine)
+{
+    switch (engine)
+    {
+    case STRING_MSD_RADIX:
+        return "msd-radix";
+    case STRING_MULTIKEY_QUICKSORT:
+        return "multikey-quicksort";
+    case STRING_LCP_MERGE:
+        return "lcp-merge";
+    default:
+        return nullptr;
+    }
+}
+
+bool findStringSortEngine(const char *name, StringSortEngine &engine)
+{
+    for (int candidate = 0; candidate < STRING_ENGINE_COUNT; candidate++)
+    {
+        if (std::strcmp(name, stringSortEngineName(static_cast<StringSortEngine>(candidate))) == 0)
+        {
+            engine = static_cast<StringSortEngine>(candidate);
+            return true;
+        }
+    }
+    return false;
+}
+
+void msdRadixSortStrings(const StringBatch &batch, uint32_t order[], Arena &scratch)
+{
+    CachedString *items = cacheStrings(batch, scratch);
+    CachedString *buffer = scratch.allocateArray<CachedString>(batch.count);
+    if (batch.count > 1)
+        msdRadixSort(batch, items, buffer, batch.count, 0, 0, batch.count > PARALLEL_ABOVE);
+    for (size_t i = 0; i < batch.count; i++)
+        order[i] = items[i].index;
+}
+
+void multikeyQuicksortStrings(const StringBatch &batch, uint32_t order[], Arena &scratch)
+{
+    CachedString *items = cacheStrings(batch, scratch);
+    if (batch.count > 1)
+        multikeyQuicksort(batch, items, batch.count, 0, 0);
+    for (size_t i = 0; i < batch.count; i++)
+        order[i] = items[i].index;
+}
+
+void lcpMergeSortStrings(const StringBatch &batch, uint32_t order[], Arena &scratch)
+{
+    if (batch.count == 0)
+        return;
+    LcpRun run = {order, scratch.allocateArray<uint32_t>(batch.count), scratch.allocateArray<uint16_t>(batch.count)};
+    LcpRun buffer = {scratch.allocateArray<uint32_t>(batch.count), scratch.allocateArray<uint32_t>(batch.count),
+                     scratch.allocateArray<uint16_t>(batch.count)};
+    for (size_t i = 0; i < batch.count; i++)
+        order[i] = static_cast<uint32_t>(i);
+    CachedString *items = scratch.allocateArray<CachedString>(batch.count);
+    CachedString *cacheBuffer = scratch.allocateArray<CachedString>(batch.count);
+    lcpMergeSort(batch, run, buffer, batch.count, items, cacheBuffer, batch.count > PARALLEL_ABOVE);
+}
+
+void sortStrings(StringSortEngine engine, const StringBatch &batch, uint32_t order[], Arena &scratch)
+{
+    switch (engine)
+    {
+    case STRING_MULTIKEY_QUICKSORT:
+        multikeyQuicksortStrings(batch, order, scratch);
+        break;
+    case STRING_LCP_MERGE:
+        lcpMergeSortStrings(batch, order, scratch);
+        break;
+    default:
+        msdRadixSortStrings(batch, order, scratch);
+        break;
+    }
+}
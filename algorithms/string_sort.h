@@ -0,0 +1,75 @@
+#pragma once
+#include "arena.h"
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Sorting variable-length byte strings, which the int-based registered
+ * algorithms cannot hold
+ *
+ * Strings compare as unsigned bytes, a proper prefix first (memcmp order).
+ * Each engine writes the order of the strings as indices and never moves the
+ * bytes themselves.
+ */
+
+/**
+ * count strings packed back to back (Arrow style): string i is
+ * bytes[offsets[i]] .. bytes[offsets[i + 1]], so offsets has count + 1
+ * entries. At most 2^32 - 1 strings, each shorter than 4 GiB
+ */
+struct StringBatch
+{
+    const char *bytes;
+    const uint64_t *offsets;
+    size_t count;
+};
+
+enum StringSortEngine
+{
+    STRING_MSD_RADIX,
+    STRING_MULTIKEY_QUICKSORT,
+    STRING_LCP_MERGE,
+    STRING_ENGINE_COUNT
+};
+
+/**
+ * e.g. "msd-radix"; nullptr past the last engine
+ */
+const char *stringSortEngineName(StringSortEngine engine);
+
+/**
+ * @return: false if no engine has that name
+ */
+bool findStringSortEngine(const char *name, StringSortEngine &engine);
+
+/**
+ * MSD radix sort, one byte per level, stable
+ * Every string carries a cached copy of its next 8 bytes, refilled once per
+ * 8 levels, so distributing reads the (small, sequential) cache instead of
+ * chasing each string's bytes. Levels where every string has the same byte
+ * are skipped without moving anything; buckets of 16 or fewer strings are
+ * finished by insertion sort. Large batches sort the top-level buckets on
+ * the thread pool.
+ */
+void msdRadixSortStrings(const StringBatch &batch, uint32_t order[], Arena &scratch);
+
+/**
+ * Multikey quicksort (Bentley and Sedgewick): three-way partitions on one
+ * byte at a time, over the same cached 8 bytes as the MSD radix sort
+ * Not stable; needs no buffer, and suits batches with few distinct bytes per
+ * position, where most radix buckets would be empty
+ */
+void multikeyQuicksortStrings(const StringBatch &batch, uint32_t order[], Arena &scratch);
+
+/**
+ * Merge sort that keeps, for every sorted run, the length of the common
+ * prefix (LCP) of each string with the one before it and the byte after it,
+ * stable
+ * Merging compares the LCPs first, then those bytes, and only reads strings
+ * when both tie, from past the shared prefix, so a shared prefix is not
+ * re-read by every comparison. Runs of up to 4096 strings come from the MSD
+ * radix sort; the two halves of large batches are sorted on the thread pool.
+ */
+void lcpMergeSortStrings(const StringBatch &batch, uint32_t order[], Arena &scratch);
+
+void sortStrings(StringSortEngine engine, const StringBatch &batch, uint32_t order[], Arena &scratch);
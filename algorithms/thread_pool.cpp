@@ -0,0 +1,296 @@
+#include "thread_pool.h"
+#include "trace.h"
+#include <algorithm>
+#include <cstdio>
+#include <string>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace
+{
+thread_local int currentWorker = -1; // Index of the pool worker running on this thread
+
+int configuredThreads = 0;
+bool configuredPinning = false;
+
+/**
+ * CPUs in the order workers should be pinned to them: one CPU from each NUMA
+ * node in turn, so consecutive workers spread over memory controllers
+ */
+std::vector<int> pinningOrder()
+{
+    std::vector<std::vector<int>> nodes;
+
+#ifdef __linux__
+    for (int node = 0;; node++)
+    {
+        std::string path = "/sys/devices/system/node/node" + std::to_string(node) + "/cpulist";
+        FILE *file = std::fopen(path.c_str(), "r");
+        if (!file)
+            break;
+
+        // cpulist looks like "0-15,32-47"
+        std::vector<int> cpus;
+        int first = 0;
+        int last = 0;
+        char separator = 0;
+        while (std::fscanf(file, "%d", &first) == 1)
+        {
+            last = first;
+            if (std::fscanf(file, "%c", &separator) == 1 && separator == '-')
+            {
+                if (std::fscanf(file, "%d", &last) != 1)
+                    break;
+                std::fscanf(file, "%c", &separator);
+            }
+            for (int cpu = first; cpu <= last; cpu++)
+                cpus.push_back(cpu);
+        }
+        std::fclose(file);
+
+        if (!cpus.empty())
+            nodes.push_back(cpus);
+    }
+#endif
+
+    if (nodes.empty())
+    {
+        // No NUMA information: treat the machine as a single node
+        std::vector<int> cpus;
+        int count = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        for (int cpu = 0; cpu < count; cpu++)
+            cpus.push_back(cpu);
+        nodes.push_back(cpus);
+    }
+
+    std::vector<int> order;
+    for (size_t round = 0;; round++)
+    {
+        bool added = false;
+        for (const std::vector<int> &cpus : nodes)
+        {
+            if (round < cpus.size())
+            {
+                order.push_back(cpus[round]);
+                added = true;
+            }
+        }
+        if (!added)
+            break;
+    }
+    return order;
+}
+
+void pinCurrentThread(int cpu)
+{
+#ifdef _WIN32
+    if (cpu < 64)
+        SetThreadAffinityMask(GetCurrentThread(), static_cast<DWORD_PTR>(1) << cpu);
+#elif defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+    (void)cpu;
+#endif
+}
+}
+
+ThreadPool::ThreadPool(int threads, bool pinThreads)
+    : queuedTasks(0), stopping(false)
+{
+    int workerCount = std::max(1, threads) - 1;
+    for (int i = 0; i <= workerCount; i++)
+    {
+        queues.emplace_back(new WorkQueue());
+    }
+
+    std::vector<int> cpus = pinThreads ? pinningOrder() : std::vector<int>();
+    for (int i = 0; i < workerCount; i++)
+    {
+        // The waiting thread is not pinned, so workers take the CPUs after the first
+        int cpu = cpus.empty() ? -1 : cpus[(i + 1) % cpus.size()];
+        workers.emplace_back([this, i, cpu]() {
+            if (cpu >= 0)
+                pinCurrentThread(cpu);
+            workerLoop(i);
+        });
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> guard(sleepLock);
+        stopping = true;
+    }
+    wakeUp.notify_all();
+
+    for (std::thread &worker : workers)
+    {
+        worker.join();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> task)
+{
+    // Workers keep their own tasks local; everyone else uses the shared queue at the end
+    int index = currentWorker >= 0 ? currentWorker : static_cast<int>(workers.size());
+    {
+        std::lock_guard<std::mutex> guard(queues[index]->lock);
+        queues[index]->tasks.push_back(std::move(task));
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(sleepLock);
+        queuedTasks++;
+    }
+    wakeUp.notify_one();
+}
+
+bool ThreadPool::popTask(int index, std::function<void()> &task)
+{
+    int queueCount = static_cast<int>(queues.size());
+
+    // Own work first, newest task
+    if (index >= 0)
+    {
+        std::lock_guard<std::mutex> guard(queues[index]->lock);
+        if (!queues[index]->tasks.empty())
+        {
+            task = std::move(queues[index]->tasks.back());
+            queues[index]->tasks.pop_back();
+            queuedTasks--;
+            return true;
+        }
+    }
+
+    // Steal the oldest task from someone else, starting next to us
+    for (int offset = 1; offset <= queueCount; offset++)
+    {
+        int victim = (std::max(index, 0) + offset) % queueCount;
+        if (victim == index)
+            continue;
+
+        std::lock_guard<std::mutex> guard(queues[victim]->lock);
+        if (!queues[victim]->tasks.empty())
+        {
+            task = std::move(queues[victim]->tasks.front());
+            queues[victim]->tasks.pop_front();
+            queuedTasks--;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ThreadPool::runPendingTask()
+{
+    std::function<void()> task;
+    if (!popTask(currentWorker, task))
+        return false;
+
+    TRACE_SCOPE("pool task (helping)");
+    task();
+    return true;
+}
+
+void ThreadPool::workerLoop(int index)
+{
+    currentWorker = index;
+#ifdef SORT_TRACE
+    std::string name = "pool worker " + std::to_string(index);
+    TRACE_THREAD_NAME(name.c_str());
+#endif
+
+    for (;;)
+    {
+        std::function<void()> task;
+        if (popTask(index, task))
+        {
+            TRACE_SCOPE("pool task");
+            task();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> guard(sleepLock);
+        wakeUp.wait(guard, [this]() { return stopping || queuedTasks > 0; });
+        if (stopping && queuedTasks == 0)
+            return;
+    }
+}
+
+void configureThreadPool(int threads, bool pinThreads)
+{
+    configuredThreads = threads;
+    configuredPinning = pinThreads;
+}
+
+ThreadPool &getThreadPool()
+{
+    static ThreadPool pool(configuredThreads > 0 ? configuredThreads
+                                                 : static_cast<int>(std::max(1u, std::thread::hardware_concurrency())),
+                           configuredPinning);
+    return pool;
+}
+
+void TaskGroup::finishTasks()
+{
+    // Help instead of blocking, so tasks that wait on their own children still make progress
+    while (pending > 0)
+    {
+        if (!pool.runPendingTask())
+            std::this_thread::yield();
+    }
+}
+
+void TaskGroup::wait()
+{
+    finishTasks();
+
+    std::exception_ptr thrown;
+    {
+        std::lock_guard<std::mutex> guard(errorLock);
+        std::swap(thrown, error);
+    }
+    if (thrown)
+        std::rethrow_exception(thrown);
+}
+
+void parallelFor(long long begin, long long end, long long grain,
+                 const std::function<void(long long, long long)> &body)
+{
+    if (end <= begin)
+        return;
+
+    ThreadPool &pool = getThreadPool();
+    long long length = end - begin;
+    grain = std::max(1LL, grain);
+
+    // A few chunks per thread so stealing can even out uneven chunks
+    long long chunks = std::min((length + grain - 1) / grain, 4LL * pool.size());
+    if (chunks <= 1)
+    {
+        body(begin, end);
+        return;
+    }
+
+    TaskGroup group(pool);
+    for (long long c = 1; c < chunks; c++)
+    {
+        long long chunkBegin = begin + length * c / chunks;
+        long long chunkEnd = begin + length * (c + 1) / chunks;
+        group.run([&body, chunkBegin, chunkEnd]() { body(chunkBegin, chunkEnd); });
+    }
+
+    // The calling thread takes the first chunk itself
+    body(begin, begin + length / chunks);
+    group.wait();
+}
@@ -0,0 +1,132 @@
+#pragma once
+#include <atomic>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * Shared parallel runtime
+ *
+ * One fixed pool of worker threads serves every parallel engine, so nested or
+ * concurrent parallel work never oversubscribes the machine. Each worker owns
+ * a deque: it pushes and pops its own tasks at the back (newest first, cache
+ * warm) and idle workers steal from the front of other deques (oldest first,
+ * usually the biggest pieces of work). A thread waiting on a TaskGroup runs
+ * queued tasks while it waits, so nested parallelFor() calls cannot deadlock.
+ */
+class ThreadPool
+{
+public:
+    /**
+     * @param threads: Total threads doing work, including the thread that waits
+     *                 (threads - 1 workers are started)
+     * @param pinThreads: Pin workers to CPUs, spread round-robin over NUMA nodes
+     */
+    ThreadPool(int threads, bool pinThreads);
+    ~ThreadPool();
+
+    int size() const { return static_cast<int>(workers.size()) + 1; }
+
+    void submit(std::function<void()> task);
+
+    /**
+     * Run one queued task on the calling thread
+     * @return: false if there was nothing to run
+     */
+    bool runPendingTask();
+
+private:
+    struct WorkQueue
+    {
+        std::mutex lock;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::thread> workers;
+    std::vector<std::unique_ptr<WorkQueue>> queues; // One per worker, plus one for outside threads
+    std::mutex sleepLock;
+    std::condition_variable wakeUp;
+    std::atomic<int> queuedTasks;
+    bool stopping;
+
+    void workerLoop(int index);
+    bool popTask(int index, std::function<void()> &task);
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+};
+
+/**
+ * Set the size of the shared pool; call before the first getThreadPool()
+ * @param threads: 0 uses every hardware thread
+ */
+void configureThreadPool(int threads, bool pinThreads);
+
+/**
+ * The pool shared by all engines (created on first use)
+ */
+ThreadPool &getThreadPool();
+
+/**
+ * A set of tasks that can be waited on together
+ * The first exception thrown by a task is rethrown from wait()
+ */
+class TaskGroup
+{
+public:
+    explicit TaskGroup(ThreadPool &pool = getThreadPool()) : pool(pool), pending(0) {}
+    ~TaskGroup() { finishTasks(); }
+
+    template <typename Function>
+    void run(Function &&function)
+    {
+        pending++;
+        pool.submit([this, function = std::forward<Function>(function)]() mutable {
+            try
+            {
+                function();
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> guard(errorLock);
+                if (!error)
+                    error = std::current_exception();
+            }
+            pending--;
+        });
+    }
+
+    void wait();
+
+private:
+    ThreadPool &pool;
+    std::atomic<int> pending;
+    std::mutex errorLock;
+    std::exception_ptr error;
+
+    void finishTasks();
+};
+
+/**
+ * Call body(chunkBegin, chunkEnd) over [begin, end) in parallel
+ * @param grain: Smallest chunk worth a task of its own
+ */
+void parallelFor(long long begin, long long end, long long grain,
+                 const std::function<void(long long, long long)> &body);
+
+/**
+ * Run every function in parallel and return when all have finished
+ */
+template <typename... Functions>
+void parallelInvoke(Functions &&...functions)
+{
+    TaskGroup group;
+    (group.run(std::forward<Functions>(functions)), ...);
+    group.wait();
+}
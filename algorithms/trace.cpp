@@ -0,0 +1,220 @@
+#include "trace.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <vector>
+
+std::atomic<bool> traceActive(false);
+
+namespace
+{
+const int CHUNK_EVENTS = 4096;
+
+struct TraceEvent
+{
+    const char *name;
+    uint64_t start; // Nanoseconds since tracing started
+    uint64_t end;   // Counters: unused
+    long long value;
+    char phase;     // 'X' complete span, 'C' counter
+};
+
+/**
+ * Events are appended by the owning thread only; count is published with a
+ * release store, so the writer of the file sees every event below it
+ */
+struct TraceChunk
+{
+    TraceEvent events[CHUNK_EVENTS];
+    std::atomic<int> count{0};
+    std::atomic<TraceChunk *> next{nullptr};
+};
+
+struct ThreadTrace
+{
+    int tid;
+    std::string name;
+    TraceChunk *first;
+    TraceChunk *last; // Only touched by the owning thread
+};
+
+struct TraceRegistry
+{
+    std::mutex lock;
+    std::vector<ThreadTrace *> threads;
+    std::string path;
+    bool started = false;
+    std::chrono::steady_clock::time_point origin;
+};
+
+// Never destroyed: pool workers may still record while the process exits
+TraceRegistry &registry()
+{
+    static TraceRegistry *instance = new TraceRegistry();
+    return *instance;
+}
+
+thread_local ThreadTrace *localTrace = nullptr;
+
+ThreadTrace &threadTrace()
+{
+    if (!localTrace)
+    {
+        TraceRegistry &traces = registry();
+        std::lock_guard<std::mutex> guard(traces.lock);
+        TraceChunk *chunk = new TraceChunk();
+        localTrace = new ThreadTrace{static_cast<int>(traces.threads.size()) + 1, std::string(), chunk, chunk};
+        traces.threads.push_back(localTrace);
+    }
+    return *localTrace;
+}
+
+void append(const TraceEvent &event)
+{
+    ThreadTrace &trace = threadTrace();
+    TraceChunk *chunk = trace.last;
+    int used = chunk->count.load(std::memory_order_relaxed);
+    if (used == CHUNK_EVENTS)
+    {
+        TraceChunk *fresh = new TraceChunk();
+        chunk->next.store(fresh, std::memory_order_release);
+        trace.last = chunk = fresh;
+        used = 0;
+    }
+    chunk->events[used] = event;
+    chunk->count.store(used + 1, std::memory_order_release);
+}
+
+void writeJsonString(std::FILE *file, const char *text)
+{
+    std::fputc('"', file);
+    for (; *text; text++)
+    {
+        if (*text == '"' || *text == '\\')
+            std::fputc('\\', file);
+        if (static_cast<unsigned char>(*text) >= 0x20)
+            std::fputc(*text, file);
+    }
+    std::fputc('"', file);
+}
+
+void stopTracingAtExit()
+{
+    stopTracing();
+}
+} // namespace
+
+uint64_t traceNow()
+{
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - registry().origin)
+            .count());
+}
+
+void traceComplete(const char *name, uint64_t start, uint64_t end)
+{
+    append(TraceEvent{name, start, end, 0, 'X'});
+}
+
+void traceCounter(const char *name, long long value)
+{
+    append(TraceEvent{name, traceNow(), 0, value, 'C'});
+}
+
+void traceThreadName(const char *name)
+{
+    ThreadTrace &trace = threadTrace();
+    std::lock_guard<std::mutex> guard(registry().lock);
+    trace.name = name;
+}
+
+bool startTracing(const char *path)
+{
+#ifdef SORT_TRACE
+    TraceRegistry &traces = registry();
+    std::lock_guard<std::mutex> guard(traces.lock);
+    if (traces.started)
+        return false;
+    traces.started = true;
+    traces.path = path;
+    traces.origin = std::chrono::steady_clock::now();
+    traceActive.store(true, std::memory_order_release);
+    return true;
+#else
+    (void)path;
+    return false;
+#endif
+}
+
+void startTracingFromEnvironment()
+{
+    const char *path = std::getenv("SORT_TRACE_FILE");
+    if (!path || !*path)
+        return;
+
+    if (startTracing(path))
+        std::atexit(stopTracingAtExit);
+    else
+        std::fprintf(stderr, "SORT_TRACE_FILE ignored: built without -DSORT_TRACE=ON\n");
+}
+
+bool stopTracing()
+{
+    if (!traceActive.exchange(false))
+        return true;
+
+    TraceRegistry &traces = registry();
+    std::lock_guard<std::mutex> guard(traces.lock);
+    std::FILE *file = std::fopen(traces.path.c_str(), "w");
+    if (!file)
+    {
+        std::fprintf(stderr, "could not write trace file %s\n", traces.path.c_str());
+        return false;
+    }
+
+    std::fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    bool firstEvent = true;
+    auto separate = [&]() {
+        std::fputs(firstEvent ? "" : ",\n", file);
+        firstEvent = false;
+    };
+
+    for (const ThreadTrace *trace : traces.threads)
+    {
+        if (!trace->name.empty())
+        {
+            separate();
+            std::fprintf(file, "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":",
+                         trace->tid);
+            writeJsonString(file, trace->name.c_str());
+            std::fputs("}}", file);
+        }
+
+        for (const TraceChunk *chunk = trace->first; chunk; chunk = chunk->next.load(std::memory_order_acquire))
+        {
+            int count = chunk->count.load(std::memory_order_acquire);
+            for (int i = 0; i < count; i++)
+            {
+                const TraceEvent &event = chunk->events[i];
+                separate();
+                std::fputs("{\"name\":", file);
+                writeJsonString(file, event.name);
+                if (event.phase == 'X')
+                {
+                    std::fprintf(file, ",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}", trace->tid,
+                                 event.start / 1e3, (event.end - event.start) / 1e3);
+                }
+                else
+                {
+                    std::fprintf(file, ",\"ph\":\"C\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"args\":{\"value\":%lld}}",
+                                 trace->tid, event.start / 1e3, event.value);
+                }
+            }
+        }
+    }
+
+    std::fputs("\n]}\n", file);
+    return std::fclose(file) == 0;
+}
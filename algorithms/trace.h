@@ -0,0 +1,95 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+/**
+ * Scoped tracing to a Chrome trace-event JSON file
+ *
+ * Open the file in chrome://tracing or https://ui.perfetto.dev to see one
+ * track per thread with the spans nested as they ran.
+ *
+ *   TRACE_SCOPE("merge pass");          // Span from here to the end of the scope
+ *   TRACE_COUNTER("depth limit hit", n); // Counter track sample
+ *   TRACE_THREAD_NAME("pool worker 3");  // Label the calling thread's track
+ *
+ * The macros compile to nothing unless the build defines SORT_TRACE (cmake
+ * -DSORT_TRACE=ON); TRACE_COUNTER's arguments are still evaluated, so values
+ * kept only for the counter do not need to be marked unused. Built in, they cost one atomic load and a branch until
+ * startTracing() is called. While tracing, each thread appends fixed-size
+ * events to its own buffer of chunks, which only that thread writes; no locks
+ * are taken and nothing is formatted until stopTracing() writes the file.
+ *
+ * Names must be string literals (or otherwise outlive the trace): only the
+ * pointer is stored.
+ */
+
+/**
+ * Start recording; stopTracing() writes everything recorded to path
+ * Tracing can only be started once per process.
+ * @return False if tracing is compiled out or was already started
+ */
+bool startTracing(const char *path);
+
+/**
+ * Start tracing if $SORT_TRACE_FILE names an output file, and stop (writing
+ * the file) when the process exits
+ */
+void startTracingFromEnvironment();
+
+/**
+ * Stop recording and write the trace file (does nothing if not tracing)
+ * @return False if the file could not be written
+ */
+bool stopTracing();
+
+extern std::atomic<bool> traceActive;
+
+inline bool tracingEnabled()
+{
+    return traceActive.load(std::memory_order_acquire);
+}
+
+// Recording functions behind the macros
+uint64_t traceNow();
+void traceComplete(const char *name, uint64_t start, uint64_t end);
+void traceCounter(const char *name, long long value);
+void traceThreadName(const char *name);
+
+class TraceScope
+{
+public:
+    explicit TraceScope(const char *spanName)
+        : name(tracingEnabled() ? spanName : nullptr), start(name ? traceNow() : 0)
+    {
+    }
+    ~TraceScope()
+    {
+        if (name)
+            traceComplete(name, start, traceNow());
+    }
+
+private:
+    const char *name;
+    uint64_t start;
+
+    TraceScope(const TraceScope &) = delete;
+    TraceScope &operator=(const TraceScope &) = delete;
+};
+
+#define TRACE_JOIN_INNER(a, b) a##b
+#define TRACE_JOIN(a, b) TRACE_JOIN_INNER(a, b)
+
+#ifdef SORT_TRACE
+#define TRACE_SCOPE(name) TraceScope TRACE_JOIN(traceScope, __LINE__)(name)
+#define TRACE_COUNTER(name, value)                                                                                     \
+    do                                                                                                                 \
+    {                                                                                                                  \
+        if (tracingEnabled())                                                                                          \
+            traceCounter(name, value);                                                                                 \
+    } while (0)
+#define TRACE_THREAD_NAME(name) traceThreadName(name)
+#else
+#define TRACE_SCOPE(name) ((void)0)
+#define TRACE_COUNTER(name, value) ((void)(name), (void)(value))
+#define TRACE_THREAD_NAME(name) ((void)0)
+#endif
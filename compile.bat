@@ -12,12 +12,15 @@ cd /d "%~dp0"
 
 echo Compiling new visualizer...
 g++ -std=c++17 -Wall -O2 -mwindows ^
-    src/main.cpp src/visualizer.cpp ^
-    src/ui/simple_ui.cpp src/ui/bar_renderer.cpp src/ui/input_handler.cpp src/ui/algorithm_comparison.cpp ^
-    algorithms/algorithm_registry.cpp algorithms/register_algorithms.cpp ^
+    src/main.cpp src/visualizer.cpp src/frame_scheduler.cpp ^
+    src/ui/simple_ui.cpp src/ui/bar_renderer.cpp src/ui/input_handler.cpp src/ui/algorithm_comparison.cpp src/ui/perf_hud.cpp ^
+    algorithms/algorithm_registry.cpp algorithms/register_algorithms.cpp algorithms/sort_verifier.cpp ^
+    algorithms/sort_runner.cpp algorithms/external_sort.cpp algorithms/mapped_file.cpp algorithms/radix_keys.cpp ^
+    algorithms/loser_tree.cpp algorithms/thread_pool.cpp algorithms/arena.cpp algorithms/sort_run.cpp algorithms/latency_histogram.cpp ^
     algorithms/bubble_sort.cpp algorithms/selection_sort.cpp ^
     algorithms/shell_sort.cpp algorithms/merge_sort.cpp ^
-    algorithms/quick_sort.cpp algorithms/radix_sort.cpp ^
+    algorithms/quick_sort.cpp algorithms/radix_sort.cpp algorithms/sample_sort.cpp algorithms/auto_sort.cpp ^
+    algorithms/counting_sort.cpp algorithms/bucket_sort.cpp algorithms/selection.cpp algorithms/heap_sort.cpp algorithms/incremental_sort.cpp algorithms/columnar_sort.cpp algorithms/string_sort.cpp algorithms/float_sort.cpp algorithms/trace.cpp algorithms/input_generator.cpp ^
     -lsfml-graphics -lsfml-window -lsfml-system ^
     -o build/SortingVisualizer.exe
 
@@ -34,12 +37,15 @@ if %ERRORLEVEL% EQU 0 (
     echo Compilation failed!
     echo Error details:
     g++ -std=c++17 -Wall -O2 ^
-        src/main.cpp src/visualizer.cpp ^
-        src/ui/simple_ui.cpp src/ui/bar_renderer.cpp src/ui/input_handler.cpp src/ui/algorithm_comparison.cpp ^
-        algorithms/algorithm_registry.cpp algorithms/register_algorithms.cpp ^
+        src/main.cpp src/visualizer.cpp src/frame_scheduler.cpp ^
+        src/ui/simple_ui.cpp src/ui/bar_renderer.cpp src/ui/input_handler.cpp src/ui/algorithm_comparison.cpp src/ui/perf_hud.cpp ^
+        algorithms/algorithm_registry.cpp algorithms/register_algorithms.cpp algorithms/sort_verifier.cpp ^
+    algorithms/sort_runner.cpp algorithms/external_sort.cpp algorithms/mapped_file.cpp algorithms/radix_keys.cpp ^
+    algorithms/loser_tree.cpp algorithms/thread_pool.cpp algorithms/arena.cpp algorithms/sort_run.cpp algorithms/latency_histogram.cpp ^
         algorithms/bubble_sort.cpp algorithms/selection_sort.cpp ^
         algorithms/shell_sort.cpp algorithms/merge_sort.cpp ^
-        algorithms/quick_sort.cpp algorithms/radix_sort.cpp ^
+        algorithms/quick_sort.cpp algorithms/radix_sort.cpp algorithms/sample_sort.cpp algorithms/auto_sort.cpp ^
+    algorithms/counting_sort.cpp algorithms/bucket_sort.cpp algorithms/selection.cpp algorithms/heap_sort.cpp algorithms/incremental_sort.cpp algorithms/columnar_sort.cpp algorithms/string_sort.cpp algorithms/float_sort.cpp algorithms/trace.cpp algorithms/input_generator.cpp ^
         -lsfml-graphics -lsfml-window -lsfml-system ^
         -o build/SortingVisualizer.exe
     exit /b 1
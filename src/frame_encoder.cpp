@@ -0,0 +1,199 @@
+#include "frame_encoder.h"
+#include <filesystem>
+#include <thread>
+#include <utility>
+
+// Frames queued per pool thread before submit() starts helping
+static const int FRAMES_PER_THREAD = 2;
+
+static bool endsWith(const std::string &text, const char *suffix)
+{
+    std::string tail(suffix);
+    return text.size() >= tail.size() && text.compare(text.size() - tail.size(), tail.size(), tail) == 0;
+}
+
+FrameEncoder::FrameEncoder()
+    : y4m(false), width(0), height(0), stream(nullptr), maxInFlight(1), nextFrame(0), inFlight(0), nextToWrite(0)
+{
+}
+
+FrameEncoder::~FrameEncoder()
+{
+    std::string ignored;
+    close(ignored);
+}
+
+bool FrameEncoder::open(const std::string &outputPath, unsigned frameWidth, unsigned frameHeight, int frameRate,
+                        std::string &error)
+{
+    path = outputPath;
+    width = frameWidth;
+    height = frameHeight;
+    y4m = endsWith(path, ".y4m");
+    nextFrame = 0;
+    nextToWrite = 0;
+    maxInFlight = getThreadPool().size() * FRAMES_PER_THREAD;
+
+    if (y4m)
+    {
+        if (width % 2 != 0 || height % 2 != 0)
+        {
+            error = "Y4M 4:2:0 output needs an even width and height";
+            return false;
+        }
+        stream = std::fopen(path.c_str(), "wb");
+        if (!stream)
+        {
+            error = "cannot create " + path;
+            return false;
+        }
+        // Full-range BT.601, the same as JPEG
+        std::fprintf(stream, "YUV4MPEG2 W%u H%u F%d:1 Ip A1:1 C420jpeg\n", width, height, frameRate);
+        return true;
+    }
+
+    std::error_code failure;
+    std::filesystem::create_directories(path, failure);
+    if (failure)
+    {
+        error = "cannot create directory " + path + ": " + failure.message();
+        return false;
+    }
+    return true;
+}
+
+void FrameEncoder::submit(const sf::Uint8 *pixels)
+{
+    // Full: help encode instead of queueing more
+    while (inFlight.load() >= maxInFlight)
+    {
+        if (!getThreadPool().runPendingTask())
+            std::this_thread::yield();
+    }
+
+    Frame frame;
+    frame.index = nextFrame++;
+    {
+        std::lock_guard<std::mutex> guard(bufferLock);
+        if (!spareBuffers.empty())
+        {
+            frame.pixels = std::move(spareBuffers.back());
+            spareBuffers.pop_back();
+        }
+    }
+    frame.pixels.assign(pixels, pixels + static_cast<size_t>(width) * height * 4);
+
+    inFlight++;
+    tasks.run([this, frame = std::move(frame)]() mutable { encode(frame); });
+}
+
+void FrameEncoder::encode(Frame &frame)
+{
+    if (!y4m)
+    {
+        writePng(frame);
+        recycle(frame.pixels);
+        inFlight--;
+        return;
+    }
+
+    std::vector<sf::Uint8> yuv;
+    convertToYuv(frame, yuv);
+    recycle(frame.pixels);
+    appendInOrder(frame.index, yuv);
+}
+
+void FrameEncoder::writePng(const Frame &frame)
+{
+    char name[32];
+    std::snprintf(name, sizeof(name), "frame_%06lld.png", frame.index);
+
+    sf::Image image;
+    image.create(width, height, frame.pixels.data());
+    if (!image.saveToFile(path + "/" + name))
+        fail("cannot write " + path + "/" + name);
+}
+
+/**
+ * RGBA to planar Y, U, V with 2x2 chroma subsampling, in 16.16 fixed point
+ */
+void FrameEncoder::convertToYuv(const Frame &frame, std::vector<sf::Uint8> &yuv) const
+{
+    size_t lumaSize = static_cast<size_t>(width) * height;
+    yuv.resize(lumaSize + lumaSize / 2);
+    sf::Uint8 *luma = yuv.data();
+    sf::Uint8 *blue = luma + lumaSize;
+    sf::Uint8 *red = blue + lumaSize / 4;
+    const sf::Uint8 *rgba = frame.pixels.data();
+
+    for (size_t i = 0; i < lumaSize; i++)
+    {
+        const sf::Uint8 *p = rgba + i * 4;
+        luma[i] = static_cast<sf::Uint8>((19595 * p[0] + 38470 * p[1] + 7471 * p[2] + 32768) >> 16);
+    }
+
+    unsigned halfWidth = width / 2;
+    for (unsigned y = 0; y < height; y += 2)
+    {
+        for (unsigned x = 0; x < width; x += 2)
+        {
+            // Average the 2x2 block first: one conversion per chroma sample
+            const sf::Uint8 *top = rgba + (static_cast<size_t>(y) * width + x) * 4;
+            const sf::Uint8 *below = top + static_cast<size_t>(width) * 4;
+            int r = top[0] + top[4] + below[0] + below[4];
+            int g = top[1] + top[5] + below[1] + below[5];
+            int b = top[2] + top[6] + below[2] + below[6];
+
+            size_t chroma = static_cast<size_t>(y / 2) * halfWidth + x / 2;
+            blue[chroma] = static_cast<sf::Uint8>((-11059 * r - 21709 * g + 32768 * b + (128 << 18) + (1 << 17)) >> 18);
+            red[chroma] = static_cast<sf::Uint8>((32768 * r - 27439 * g - 5329 * b + (128 << 18) + (1 << 17)) >> 18);
+        }
+    }
+}
+
+/**
+ * Write this frame if it is next, then any converted frames queued behind it
+ */
+void FrameEncoder::appendInOrder(long long index, std::vector<sf::Uint8> &yuv)
+{
+    std::lock_guard<std::mutex> guard(writeLock);
+    converted.emplace(index, std::move(yuv));
+    while (!converted.empty() && converted.begin()->first == nextToWrite)
+    {
+        const std::vector<sf::Uint8> &planes = converted.begin()->second;
+        if (std::fputs("FRAME\n", stream) < 0 || std::fwrite(planes.data(), 1, planes.size(), stream) != planes.size())
+            fail("cannot write " + path);
+        converted.erase(converted.begin());
+        nextToWrite++;
+        inFlight--;
+    }
+}
+
+void FrameEncoder::recycle(std::vector<sf::Uint8> &buffer)
+{
+    std::lock_guard<std::mutex> guard(bufferLock);
+    spareBuffers.push_back(std::move(buffer));
+}
+
+void FrameEncoder::fail(const std::string &error)
+{
+    std::lock_guard<std::mutex> guard(errorLock);
+    if (firstError.empty())
+        firstError = error;
+}
+
+bool FrameEncoder::close(std::string &error)
+{
+    tasks.wait();
+    if (stream)
+    {
+        if (std::fclose(stream) != 0)
+            fail("cannot write " + path);
+        stream = nullptr;
+    }
+    spareBuffers.clear();
+
+    std::lock_guard<std::mutex> guard(errorLock);
+    error = firstError;
+    return firstError.empty();
+}
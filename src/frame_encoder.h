@@ -0,0 +1,89 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include "../algorithms/thread_pool.h"
+#include <atomic>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * Encodes and writes rendered frames on the shared thread pool
+ *
+ * submit() copies the frame's pixels into a recycled buffer and queues it;
+ * colour conversion, compression and the disk write run on pool workers,
+ * several frames at once, while the caller renders the next frame. At most
+ * maxInFlight frames are unwritten at any time: past that, submit() runs
+ * queued encoding work itself until there is room, which bounds memory
+ * however far rendering gets ahead.
+ *
+ * Output is either a directory of numbered PNG files (frame_000000.png, ...)
+ * or, for a path ending in .y4m, one uncompressed YUV 4:2:0 stream that
+ * ffmpeg and most players read directly. Y4M frames are converted in
+ * parallel and appended in order.
+ */
+class FrameEncoder
+{
+public:
+    FrameEncoder();
+    ~FrameEncoder();
+
+    /**
+     * @param path: A .y4m file, or a directory for PNG frames (created if missing)
+     * @param width, height: Frame size; Y4M needs both even
+     * @param frameRate: Playback rate recorded in the Y4M header
+     */
+    bool open(const std::string &path, unsigned width, unsigned height, int frameRate, std::string &error);
+
+    /**
+     * Queue one frame of width * height RGBA pixels
+     */
+    void submit(const sf::Uint8 *pixels);
+
+    /**
+     * Wait for every queued frame to be written and close the output
+     * @return: false if any frame failed to encode or write
+     */
+    bool close(std::string &error);
+
+    long long framesSubmitted() const { return nextFrame; }
+
+private:
+    struct Frame
+    {
+        long long index;
+        std::vector<sf::Uint8> pixels;
+    };
+
+    std::string path;
+    bool y4m;
+    unsigned width, height;
+    std::FILE *stream; // The Y4M output
+    int maxInFlight;
+    long long nextFrame;
+    std::atomic<int> inFlight; // Submitted but not yet written
+
+    std::mutex bufferLock;
+    std::vector<std::vector<sf::Uint8>> spareBuffers;
+
+    // Y4M frames are appended in order; converted ones wait here for their turn
+    std::mutex writeLock;
+    std::map<long long, std::vector<sf::Uint8>> converted;
+    long long nextToWrite;
+
+    std::mutex errorLock;
+    std::string firstError;
+
+    TaskGroup tasks;
+
+    void encode(Frame &frame);
+    void writePng(const Frame &frame);
+    void convertToYuv(const Frame &frame, std::vector<sf::Uint8> &yuv) const;
+    void appendInOrder(long long index, std::vector<sf::Uint8> &yuv);
+    void recycle(std::vector<sf::Uint8> &buffer);
+    void fail(const std::string &error);
+
+    FrameEncoder(const FrameEncoder &) = delete;
+    FrameEncoder &operator=(const FrameEncoder &) = delete;
+};
@@ -0,0 +1,138 @@
+#include "frame_scheduler.h"
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+// Speeds the controls can reach
+static const double MIN_RATE = 0.25;
+static const double MAX_RATE = 1e9;
+static const double MIN_FINISH_IN = 0.25;
+static const double MAX_FINISH_IN = 3600.0;
+
+// A frame never plans for more time than this since the last one (the window was dragged, ...)
+static const double MAX_FRAME_GAP = 0.25;
+// Share of the frame period left to event handling and the UI text
+static const double FRAME_HEADROOM = 0.2;
+// Stepping always gets at least this share, so a heavy render cannot stall the run
+static const double MIN_STEP_SHARE = 0.1;
+// Weight of the newest measurement in the smoothed costs
+static const double SMOOTHING = 0.2;
+// Steps tried before the first measurement
+static const int FIRST_FRAME_STEPS = 16;
+
+static double smooth(double average, double sample)
+{
+    return average == 0 ? sample : average + SMOOTHING * (sample - average);
+}
+
+FrameScheduler::FrameScheduler(double frameRate)
+    : framePeriod(1.0 / frameRate), stepsPerSecond(frameRate), finishMode(false), finishIn(10.0), timeLeft(10.0),
+      owed(0), stepCost(0), renderCost(0), plannedRate(frameRate)
+{
+}
+
+void FrameScheduler::setStepsPerSecond(double rate)
+{
+    stepsPerSecond = std::min(std::max(rate, MIN_RATE), MAX_RATE);
+    finishMode = false;
+}
+
+void FrameScheduler::setFinishIn(double seconds)
+{
+    finishIn = std::min(std::max(seconds, MIN_FINISH_IN), MAX_FINISH_IN);
+    timeLeft = finishIn;
+    finishMode = true;
+}
+
+void FrameScheduler::toggleFinishMode()
+{
+    if (finishMode)
+        setStepsPerSecond(stepsPerSecond);
+    else
+        setFinishIn(finishIn);
+}
+
+void FrameScheduler::faster()
+{
+    if (finishMode)
+    {
+        finishIn = std::max(finishIn / 2, MIN_FINISH_IN);
+        timeLeft /= 2;
+    }
+    else
+        setStepsPerSecond(stepsPerSecond * 2);
+}
+
+void FrameScheduler::slower()
+{
+    if (finishMode)
+    {
+        finishIn = std::min(finishIn * 2, MAX_FINISH_IN);
+        timeLeft *= 2;
+    }
+    else
+        setStepsPerSecond(stepsPerSecond / 2);
+}
+
+void FrameScheduler::restart()
+{
+    owed = 0;
+    timeLeft = finishIn;
+}
+
+int FrameScheduler::stepsForFrame(double elapsed, long long remaining)
+{
+    if (remaining == 0)
+        return 0;
+
+    // In finish-in mode the rate is whatever ends the run on time
+    elapsed = std::min(elapsed, MAX_FRAME_GAP);
+    double rate = stepsPerSecond;
+    if (finishMode && remaining > 0)
+        rate = remaining / std::max(timeLeft, framePeriod);
+    plannedRate = rate;
+    timeLeft = std::max(timeLeft - elapsed, 0.0);
+
+    owed += rate * elapsed;
+    double wanted = std::floor(owed + 1e-9); // Sixty sixtieths make a whole step
+
+    double budget = std::max(framePeriod * (1 - FRAME_HEADROOM) - renderCost, framePeriod * MIN_STEP_SHARE);
+    double fits = stepCost > 0 ? std::floor(budget / stepCost) : FIRST_FRAME_STEPS;
+
+    double steps = std::max(std::min(wanted, fits), 0.0);
+    if (remaining > 0)
+        steps = std::min(steps, static_cast<double>(remaining));
+
+    owed = wanted > steps ? 0 : owed - steps;
+    return static_cast<int>(std::min(steps, 1e9));
+}
+
+void FrameScheduler::recordSteps(int steps, double seconds)
+{
+    if (steps > 0)
+        stepCost = smooth(stepCost, seconds / steps);
+}
+
+void FrameScheduler::recordRender(double seconds)
+{
+    renderCost = smooth(renderCost, seconds);
+}
+
+std::string FrameScheduler::describe() const
+{
+    std::ostringstream oss;
+    oss.setf(std::ios::fixed);
+    if (finishMode)
+    {
+        oss.precision(1);
+        oss << "Speed: finish in " << timeLeft << "s (";
+        oss.precision(0);
+        oss << plannedRate << " steps/s)";
+    }
+    else
+    {
+        oss.precision(stepsPerSecond < 10 ? 2 : 0);
+        oss << "Speed: " << stepsPerSecond << " steps/s";
+    }
+    return oss.str();
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include <string>
+
+/**
+ * Decides how many algorithm steps to run in each frame
+ *
+ * Playback speed is a target rate in steps per second, either set directly or
+ * derived every frame from "finish in T seconds" and the steps still to go.
+ * Whatever the rate, a frame only runs as many steps as fit in its time
+ * budget: the frame period minus what rendering has recently taken, divided
+ * by the recently measured cost of one step. So small arrays play at exactly
+ * the requested speed, and large ones run as fast as the frame rate allows
+ * without dropping frames.
+ *
+ * Rates below the frame rate accumulate fractions of a step across frames.
+ * Steps that did not fit in a frame's budget are dropped, not owed, so one
+ * slow frame does not make the next one slow too.
+ */
+class FrameScheduler
+{
+public:
+    explicit FrameScheduler(double frameRate = 60.0);
+
+    /**
+     * Play at a fixed rate (leaves finish-in mode)
+     */
+    void setStepsPerSecond(double rate);
+
+    /**
+     * Pace runs to end seconds after they start (this one: seconds from now)
+     */
+    void setFinishIn(double seconds);
+
+    bool isFinishMode() const { return finishMode; }
+    void toggleFinishMode();
+
+    /**
+     * Double / halve the speed: the rate, or in finish-in mode the run time
+     */
+    void faster();
+    void slower();
+
+    /**
+     * A new run: forget partial steps and restart the finish-in clock
+     */
+    void restart();
+
+    /**
+     * Steps to take in a frame that began elapsed seconds after the previous one
+     * @param remaining: Steps the run still needs, -1 if unknown (finish-in
+     *                   mode then plays at the fixed rate)
+     */
+    int stepsForFrame(double elapsed, long long remaining);
+
+    /**
+     * Measurements the budget is based on
+     */
+    void recordSteps(int steps, double seconds);
+    void recordRender(double seconds);
+
+    /**
+     * Rate the last frame was planned at, in steps per second
+     */
+    double currentRate() const { return plannedRate; }
+
+    /**
+     * e.g. "Speed: 240 steps/s" or "Speed: finish in 8.0s (240 steps/s)"
+     */
+    std::string describe() const;
+
+private:
+    double framePeriod;
+    double stepsPerSecond;
+    bool finishMode;
+    double finishIn;       // Seconds a run should take
+    double timeLeft;       // Seconds the current run has left
+    double owed;           // Fraction of a step carried to the next frame
+    double stepCost;       // Smoothed seconds per step (0 until measured)
+    double renderCost;     // Smoothed seconds per render
+    double plannedRate;
+};
@@ -1,6 +1,7 @@
 #include <SFML/Graphics.hpp>
 #include "visualizer.h"
 #include "../algorithms/register_algorithms.h"
+#include "../algorithms/trace.h"
 
 int main()
 {
@@ -10,6 +11,10 @@ int main()
     // Register all algorithms
     registerAllAlgorithms();
 
+    // Chrome trace of the run, if $SORT_TRACE_FILE is set (needs -DSORT_TRACE=ON)
+    startTracingFromEnvironment();
+    TRACE_THREAD_NAME("main");
+
     // Create window
     sf::RenderWindow window(sf::VideoMode(WINDOW_WIDTH, WINDOW_HEIGHT),
                             "Sorting Algorithm Visualizer - Educational Version");
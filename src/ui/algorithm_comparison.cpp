@@ -1,21 +1,19 @@
 #include "algorithm_comparison.h"
 #include "../../algorithms/algorithm_registry.h"
-#include <random>
+#include "../../algorithms/input_generator.h"
+#include "../../algorithms/thread_pool.h"
+#include "../../algorithms/trace.h"
 #include <algorithm>
 #include <cstring>
 
 AlgorithmComparison::AlgorithmComparison()
-    : isActive(false), currentStep(0), isPaused(true)
+    : isActive(false), currentStep(0), isPaused(true), inputSeed(0)
 {
 }
 
 AlgorithmComparison::~AlgorithmComparison()
 {
-    for (auto& algo : algorithms)
-    {
-        delete[] algo.array;
-        delete[] algo.originalArray;
-    }
+    // Lane arrays are released with laneArena
 }
 
 bool AlgorithmComparison::initialize()
@@ -38,11 +36,12 @@ void AlgorithmComparison::addAlgorithm(AlgorithmInfo* algorithm, sf::Color color
 
     ComparisonAlgorithm compAlgo;
     compAlgo.algorithm = algorithm;
-    compAlgo.array = new int[COMPARISON_ARRAY_SIZE];
-    compAlgo.originalArray = new int[COMPARISON_ARRAY_SIZE];
+    compAlgo.array = laneArena.allocateArray<int>(COMPARISON_ARRAY_SIZE);
+    compAlgo.originalArray = laneArena.allocateArray<int>(COMPARISON_ARRAY_SIZE);
+    compAlgo.run.reset(new SortRun());
     compAlgo.color = color;
     
-    algorithms.push_back(compAlgo);
+    algorithms.push_back(std::move(compAlgo));
 }
 
 void AlgorithmComparison::reset()
@@ -55,7 +54,7 @@ void AlgorithmComparison::reset()
     
     for (auto& algo : algorithms)
     {
-        std::memset(algo.state, 0, sizeof(algo.state));
+        algo.run->start(*algo.algorithm, COMPARISON_ARRAY_SIZE);
         algo.stepCount = 0;
         algo.swapCount = 0;
         algo.isComplete = false;
@@ -68,28 +67,39 @@ void AlgorithmComparison::reset()
     }
 }
 
-void AlgorithmComparison::stepForward()
+void AlgorithmComparison::stepForward(int steps)
 {
-    if (isPaused || isComplete())
+    if (isPaused || isComplete() || steps <= 0)
         return;
 
-    currentStep++;
-    
-    for (auto& algo : algorithms)
-    {
-        if (!algo.isComplete)
+    TRACE_SCOPE("AlgorithmComparison::stepForward");
+    currentStep += steps;
+
+    auto stepLanes = [this, steps](long long first, long long last) {
+        for (long long lane = first; lane < last; lane++)
         {
-            SwapResult result = algo.algorithm->function(algo.array, COMPARISON_ARRAY_SIZE, algo.state);
-            
-            if (result.swapped)
+            TRACE_SCOPE("comparison lane steps");
+            ComparisonAlgorithm &algo = algorithms[lane];
+            for (int i = 0; i < steps && !algo.isComplete; i++)
             {
-                algo.stepCount++;
-                algo.swapCount++;
+                SwapResult result = algo.run->step(algo.array);
+
+                if (result.swapped)
+                {
+                    algo.stepCount++;
+                    algo.swapCount++;
+                }
+
+                algo.isComplete = result.isComplete;
             }
-            
-            algo.isComplete = result.isComplete;
         }
-    }
+    };
+
+    // Lanes share nothing, so big batches run them side by side on the pool
+    if (steps >= PARALLEL_LANE_STEPS)
+        parallelFor(0, static_cast<long long>(algorithms.size()), 1, stepLanes);
+    else
+        stepLanes(0, static_cast<long long>(algorithms.size()));
 }
 
 bool AlgorithmComparison::isComplete() const
@@ -221,13 +231,18 @@ void AlgorithmComparison::initializeArrays()
     }
 }
 
+/**
+ * Every lane races on the same input: the next seed's shuffle of 1..size
+ */
 void AlgorithmComparison::randomizeArrays()
 {
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    
+    InputSpec spec;
+    spec.seed = ++inputSeed;
+    int input[COMPARISON_ARRAY_SIZE];
+    generateInput(spec, input, COMPARISON_ARRAY_SIZE);
+
     for (auto& algo : algorithms)
     {
-        std::shuffle(algo.array, algo.array + COMPARISON_ARRAY_SIZE, gen);
+        std::copy(input, input + COMPARISON_ARRAY_SIZE, algo.array);
     }
-} 
\ No newline at end of file
+}
@@ -1,6 +1,10 @@
 #pragma once
 #include <SFML/Graphics.hpp>
 #include "../../algorithms/algorithm_interface.h"
+#include "../../algorithms/arena.h"
+#include "../../algorithms/sort_run.h"
+#include <cstdint>
+#include <memory>
 #include <vector>
 
 /**
@@ -11,13 +15,14 @@ class AlgorithmComparison
 private:
     static const int MAX_ALGORITHMS = 4;
     static const int COMPARISON_ARRAY_SIZE = 20;
+    static const int PARALLEL_LANE_STEPS = 4096; // Steps per frame worth a task per lane
     
     struct ComparisonAlgorithm
     {
         AlgorithmInfo* algorithm;
         int* array;
         int* originalArray;
-        int state[20];
+        std::unique_ptr<SortRun> run; // Each lane has its own state
         int stepCount;
         int swapCount;
         bool isComplete;
@@ -25,9 +30,11 @@ private:
     };
 
     std::vector<ComparisonAlgorithm> algorithms;
+    Arena laneArena; // Arrays of every lane
     bool isActive;
     int currentStep;
     bool isPaused;
+    uint64_t inputSeed; // Seed of the current input; each reset takes the next one
 
 public:
     AlgorithmComparison();
@@ -36,7 +43,7 @@ public:
     bool initialize();
     void addAlgorithm(AlgorithmInfo* algorithm, sf::Color color);
     void reset();
-    void stepForward();
+    void stepForward(int steps = 1);
     void togglePause() { isPaused = !isPaused; }
     bool isRunning() const { return !isPaused; }
     bool isPausedState() const { return isPaused; }
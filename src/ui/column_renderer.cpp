@@ -0,0 +1,88 @@
+#include "column_renderer.h"
+#include "../../algorithms/thread_pool.h"
+#include <algorithm>
+
+// Arrays smaller than this are reduced on the calling thread
+static const int PARALLEL_REDUCE_ABOVE = 1 << 16;
+// Columns per task when reducing in parallel
+static const long long COLUMN_GRAIN = 32;
+
+ColumnRenderer::ColumnRenderer()
+    : quads(sf::Quads), normalColor(100, 150, 255), highlightColor(255, 100, 100)
+{
+}
+
+void ColumnRenderer::update(const int array[], int size, unsigned left, unsigned top, unsigned width,
+                            unsigned height, int highlight1, int highlight2)
+{
+    if (size <= 0 || width == 0 || height == 0)
+    {
+        quads.clear();
+        return;
+    }
+
+    // Column c covers the elements i with i * columns / size == c
+    long long columns = std::min<long long>(size, width);
+    columnHigh.resize(columns);
+    columnLow.resize(columns);
+    auto reduce = [&](long long first, long long last) {
+        for (long long c = first; c < last; c++)
+        {
+            long long begin = (c * size + columns - 1) / columns;
+            long long end = ((c + 1) * size + columns - 1) / columns;
+            auto range = std::minmax_element(array + begin, array + end);
+            columnLow[c] = *range.first;
+            columnHigh[c] = *range.second;
+        }
+    };
+    if (size > PARALLEL_REDUCE_ABOVE)
+        parallelFor(0, columns, COLUMN_GRAIN, reduce);
+    else
+        reduce(0, columns);
+
+    // Bars rise from zero, or from the lowest value if there are negatives
+    long long base = std::min(0, *std::min_element(columnLow.begin(), columnLow.end()));
+    long long range = std::max<long long>(*std::max_element(columnHigh.begin(), columnHigh.end()) - base, 1);
+
+    float columnWidth = static_cast<float>(width) / columns;
+    float gap = columnWidth >= 4 ? 1.0f : 0.0f; // Separate the bars while they are wide enough to see it
+    float bottom = static_cast<float>(top + height);
+    quads.resize(columns * 4);
+    for (long long c = 0; c < columns; c++)
+    {
+        float barHeight = std::max(static_cast<float>((columnHigh[c] - base) * height / range), 1.0f);
+        float x0 = left + c * columnWidth + gap;
+        float x1 = left + (c + 1) * columnWidth - gap;
+        sf::Vertex *quad = &quads[c * 4];
+        quad[0].position = sf::Vector2f(x0, bottom - barHeight);
+        quad[1].position = sf::Vector2f(x1, bottom - barHeight);
+        quad[2].position = sf::Vector2f(x1, bottom);
+        quad[3].position = sf::Vector2f(x0, bottom);
+        setColumnColor(c, normalColor);
+    }
+
+    for (int highlight : {highlight1, highlight2})
+    {
+        if (highlight >= 0 && highlight < size)
+            setColumnColor(static_cast<long long>(highlight) * columns / size, highlightColor);
+    }
+}
+
+void ColumnRenderer::setColumnColor(long long column, sf::Color color)
+{
+    for (int corner = 0; corner < 4; corner++)
+    {
+        quads[column * 4 + corner].color = color;
+    }
+}
+
+void ColumnRenderer::render(sf::RenderTarget &target) const
+{
+    target.draw(quads);
+}
+
+void ColumnRenderer::setColors(sf::Color normal, sf::Color highlight)
+{
+    normalColor = normal;
+    highlightColor = highlight;
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <vector>
+
+/**
+ * Renders an array of any size as one bar per pixel column
+ *
+ * BarRenderer draws one shape per element, which is fine for the visualizer's
+ * 50 bars but not for a million. Here an array wider than its area is reduced
+ * first: each column shows the largest value among the elements it covers,
+ * and is highlighted if it covers a highlighted index. The reduction is one
+ * pass over the array, split across the thread pool for large arrays, and
+ * drawing is a single vertex array of at most one quad per column.
+ */
+class ColumnRenderer
+{
+public:
+    ColumnRenderer();
+
+    /**
+     * Rebuild the bars for array, to be drawn inside the given area (pixels)
+     */
+    void update(const int array[], int size, unsigned left, unsigned top, unsigned width, unsigned height,
+                int highlight1 = -1, int highlight2 = -1);
+    void render(sf::RenderTarget &target) const;
+    void setColors(sf::Color normal, sf::Color highlight);
+
+private:
+    sf::VertexArray quads;
+    std::vector<int> columnHigh; // Largest value in each column
+    std::vector<int> columnLow;  // Smallest value in each column
+    sf::Color normalColor;
+    sf::Color highlightColor;
+
+    void setColumnColor(long long column, sf::Color color);
+};
@@ -56,6 +56,16 @@ InputHandler::Action InputHandler::handleInput(sf::RenderWindow &window)
                 return TOGGLE_COMPARISON_MODE;
             case sf::Keyboard::S:
                 return COMPARISON_STEP_FORWARD;
+            case sf::Keyboard::V:
+                return VERIFY_ALGORITHM;
+            case sf::Keyboard::Up:
+                return SPEED_UP;
+            case sf::Keyboard::Down:
+                return SLOW_DOWN;
+            case sf::Keyboard::F:
+                return TOGGLE_FINISH_MODE;
+            case sf::Keyboard::P:
+                return TOGGLE_PERF_HUD;
             case sf::Keyboard::Escape:
                 return QUIT;
             default:
@@ -30,6 +30,11 @@ public:
         TOGGLE_COMPARISON_MODE,
         COMPARISON_STEP_FORWARD,
         COMPARISON_RESET,
+        VERIFY_ALGORITHM,
+        SPEED_UP,
+        SLOW_DOWN,
+        TOGGLE_FINISH_MODE,
+        TOGGLE_PERF_HUD,
         QUIT
     };
 
@@ -0,0 +1,148 @@
+#include "perf_hud.h"
+#include <cstdio>
+#include <string>
+
+const double PerfHud::REFRESH_SECONDS = 0.5;
+
+namespace
+{
+const char *const PHASE_LABELS[] = {"step  ", "render", "ui    ", "frame "};
+
+/**
+ * e.g. "850ns", "12.3us", "4.56ms", "1.20s"
+ */
+std::string formatNanoseconds(double ns)
+{
+    char buffer[32];
+    if (ns < 1e3)
+        std::snprintf(buffer, sizeof(buffer), "%.0fns", ns);
+    else if (ns < 1e6)
+        std::snprintf(buffer, sizeof(buffer), "%.1fus", ns / 1e3);
+    else if (ns < 1e9)
+        std::snprintf(buffer, sizeof(buffer), "%.2fms", ns / 1e6);
+    else
+        std::snprintf(buffer, sizeof(buffer), "%.2fs", ns / 1e9);
+    return buffer;
+}
+} // namespace
+
+PerfHud::PerfHud() : windowSteps(0), remainingSteps(-1), visible(false)
+{
+    startWindow();
+}
+
+void PerfHud::initialize(const sf::Font *font)
+{
+    if (font)
+        text.setFont(*font);
+    text.setCharacterSize(13);
+    text.setFillColor(sf::Color::White);
+    background.setFillColor(sf::Color(0, 0, 0, 190));
+    background.setOutlineColor(sf::Color(90, 90, 90));
+    background.setOutlineThickness(1);
+    text.setString("Perf: collecting...");
+}
+
+void PerfHud::toggle()
+{
+    visible = !visible;
+    startWindow();
+    text.setString("Perf: collecting...");
+}
+
+void PerfHud::recordSteps(int steps, double seconds)
+{
+    if (!visible || steps <= 0)
+        return;
+    histograms[PHASE_STEP].record(static_cast<uint64_t>(seconds * 1e9 / steps));
+    phaseSeconds[PHASE_STEP] += seconds;
+    windowSteps += steps;
+}
+
+void PerfHud::record(Phase phase, double seconds)
+{
+    if (!visible)
+        return;
+    histograms[phase].record(static_cast<uint64_t>(seconds * 1e9));
+    phaseSeconds[phase] += seconds;
+}
+
+void PerfHud::startWindow()
+{
+    for (int phase = 0; phase < PHASE_COUNT; phase++)
+    {
+        histograms[phase].clear();
+        phaseSeconds[phase] = 0;
+    }
+    windowSteps = 0;
+    windowClock.restart();
+}
+
+void PerfHud::rebuildText()
+{
+    double windowSeconds = windowClock.getElapsedTime().asSeconds();
+    double frameSeconds = phaseSeconds[PHASE_FRAME] > 0 ? phaseSeconds[PHASE_FRAME] : windowSeconds;
+
+    std::string lines = "Perf (P: hide), last " + formatNanoseconds(windowSeconds * 1e9) + "\n";
+    lines += "        p50      p99      max      frame%\n";
+    for (int phase = 0; phase < PHASE_COUNT; phase++)
+    {
+        const LatencyHistogram &histogram = histograms[phase];
+        char row[128];
+        std::snprintf(row, sizeof(row), "%s  %-8s %-8s %-8s", PHASE_LABELS[phase],
+                      formatNanoseconds(static_cast<double>(histogram.percentile(50))).c_str(),
+                      formatNanoseconds(static_cast<double>(histogram.percentile(99))).c_str(),
+                      formatNanoseconds(static_cast<double>(histogram.maxValue())).c_str());
+        lines += row;
+        if (phase != PHASE_FRAME && frameSeconds > 0)
+        {
+            std::snprintf(row, sizeof(row), " %5.1f%%", 100.0 * phaseSeconds[phase] / frameSeconds);
+            lines += row;
+        }
+        lines += "\n";
+    }
+
+    // Jitter: how far a slow frame strays from the typical one
+    const LatencyHistogram &frames = histograms[PHASE_FRAME];
+    uint64_t p50 = frames.percentile(50);
+    uint64_t p99 = frames.percentile(99);
+    lines += "jitter (p99 - p50): " + formatNanoseconds(static_cast<double>(p99 > p50 ? p99 - p50 : 0)) + "\n";
+
+    double stepsPerSecond = windowSeconds > 0 ? windowSteps / windowSeconds : 0;
+    char summary[96];
+    std::snprintf(summary, sizeof(summary), "ops/s: %.0f", stepsPerSecond);
+    lines += summary;
+    if (remainingSteps == 0)
+        lines += " | done";
+    else if (remainingSteps > 0 && stepsPerSecond > 0)
+        lines += " | ETA " + formatNanoseconds(remainingSteps / stepsPerSecond * 1e9);
+    else
+        lines += " | ETA -";
+
+    text.setString(lines);
+}
+
+void PerfHud::render(sf::RenderTarget &target)
+{
+    if (!visible)
+        return;
+
+    if (windowClock.getElapsedTime().asSeconds() >= REFRESH_SECONDS)
+    {
+        rebuildText();
+        startWindow();
+    }
+
+    // Top right corner, sized to the text
+    sf::FloatRect bounds = text.getLocalBounds();
+    const float padding = 8;
+    float width = bounds.left + bounds.width + 2 * padding;
+    float height = bounds.top + bounds.height + 2 * padding;
+    float left = target.getSize().x - width - 10;
+    background.setSize(sf::Vector2f(width, height));
+    background.setPosition(left, 10);
+    text.setPosition(left + padding, 10 + padding);
+
+    target.draw(background);
+    target.draw(text);
+}
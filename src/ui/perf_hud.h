@@ -0,0 +1,68 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include "../../algorithms/latency_histogram.h"
+
+/**
+ * Overlay showing where each frame's time goes
+ *
+ * Every frame the visualizer reports how long its phases took: stepping the
+ * algorithm, drawing the bars, formatting and drawing the UI text, and the
+ * whole frame interval. Each phase has a LatencyHistogram in nanoseconds,
+ * so recording a sample is a few shifts and an add. Every REFRESH_SECONDS the
+ * overlay text is rebuilt from the histograms (percentiles, the share of frame
+ * time each phase used, steps per second, and the time left for the run) and
+ * the histograms start over, so the numbers always describe the last window.
+ *
+ * Nothing is recorded while the overlay is hidden.
+ */
+class PerfHud
+{
+public:
+    enum Phase
+    {
+        PHASE_STEP,   // One algorithm step (a frame's batch time / its step count)
+        PHASE_RENDER, // Drawing the bars (or the comparison lanes)
+        PHASE_UI,     // Formatting and drawing the UI text
+        PHASE_FRAME,  // Start of one frame to the start of the next
+        PHASE_COUNT
+    };
+
+    PerfHud();
+
+    /**
+     * Use the font the rest of the UI loaded (nullptr: SFML's default)
+     */
+    void initialize(const sf::Font *font);
+
+    void toggle();
+    bool isVisible() const { return visible; }
+
+    /**
+     * A frame ran steps algorithm steps in seconds
+     */
+    void recordSteps(int steps, double seconds);
+    void record(Phase phase, double seconds);
+
+    /**
+     * Steps the current run still needs, -1 if unknown (no time left is shown)
+     */
+    void setRemainingSteps(long long remaining) { remainingSteps = remaining; }
+
+    void render(sf::RenderTarget &target);
+
+private:
+    static const double REFRESH_SECONDS;
+
+    LatencyHistogram histograms[PHASE_COUNT];
+    double phaseSeconds[PHASE_COUNT]; // Total per phase in this window (steps: whole batches)
+    long long windowSteps;
+    long long remainingSteps;
+    bool visible;
+
+    sf::Clock windowClock;
+    sf::RectangleShape background;
+    sf::Text text;
+
+    void rebuildText();
+    void startWindow();
+};
@@ -1,4 +1,5 @@
 #include "simple_ui.h"
+#include <algorithm>
 #include <sstream>
 #include <iostream>
 
@@ -81,6 +82,20 @@ bool SimpleUI::initialize()
     if (fontLoaded)
         arrayStats.setFont(font);
 
+    // Setup verification result text
+    verificationInfo.setCharacterSize(12);
+    verificationInfo.setFillColor(sf::Color::Green);
+    verificationInfo.setPosition(20, 272);
+    if (fontLoaded)
+        verificationInfo.setFont(font);
+
+    // Setup playback speed text
+    speedInfo.setCharacterSize(16);
+    speedInfo.setFillColor(sf::Color::Magenta);
+    speedInfo.setPosition(220, 165);
+    if (fontLoaded)
+        speedInfo.setFont(font);
+
     return true;
 }
 
@@ -93,53 +108,39 @@ void SimpleUI::updateInstructions(bool paused)
 {
     if (paused)
     {
-        instructions.setString("PAUSED - SPACE: resume | LEFT/RIGHT: step | R: reset | TAB: next algo | +/-: size | 1-6: select algo | C: comparison mode");
+        instructions.setString("PAUSED - SPACE: resume | LEFT/RIGHT: step | UP/DOWN: speed | F: finish-in | R: reset | TAB: next algo | +/-: size | 1-0: select algo | V: verify | C: comparison mode | P: perf");
     }
     else
     {
-        instructions.setString("RUNNING - SPACE: pause | R: reset | TAB: next algo | +/-: size | 1-6: select algo | C: comparison mode");
+        instructions.setString("RUNNING - SPACE: pause | UP/DOWN: speed | F: finish-in | R: reset | TAB: next algo | +/-: size | 1-0: select algo | V: verify | C: comparison mode | P: perf");
     }
 }
 
-void SimpleUI::updateArrayDisplay(int array[], int size)
+void SimpleUI::updateArrayDisplay(const int array[], int size, int focus)
 {
-    std::ostringstream oss;
-    oss << "Array: [";
-    for (int i = 0; i < size; i++)
-    {
-        oss << array[i];
-        if (i < size - 1)
-            oss << ", ";
-    }
-    oss << "]";
-    arrayDisplay.setString(oss.str());
+    shownArray = array;
+    shownSize = size;
+    shownFocus = focus;
+    dirty |= DIRTY_ARRAY;
 }
 
 void SimpleUI::updateStepInfo(int step, bool complete)
 {
-    std::ostringstream oss;
-    if (complete)
-    {
-        oss << "Sorting Complete! Steps taken: " << step;
-    }
-    else
-    {
-        oss << "Step: " << step;
-    }
-    stepInfo.setString(oss.str());
+    shownStep = step;
+    shownComplete = complete;
+    dirty |= DIRTY_STEP;
 }
 
 void SimpleUI::updateSwapInfo(int swaps)
 {
-    std::ostringstream oss;
-    oss << "Swaps: " << swaps;
-    swapInfo.setString(oss.str());
+    shownSwaps = swaps;
+    dirty |= DIRTY_SWAPS;
 }
 
-void SimpleUI::updateArraySize(int size)
+void SimpleUI::updateArraySize(int size, uint64_t seed)
 {
     std::ostringstream oss;
-    oss << "Array Size: " << size;
+    oss << "Array Size: " << size << " | Seed: " << seed;
     arraySize.setString(oss.str());
 }
 
@@ -157,13 +158,84 @@ void SimpleUI::updateAlgorithmDescription(const char* description)
 
 void SimpleUI::updateArrayStats(int min, int max, int median)
 {
-    std::ostringstream oss;
-    oss << "Array Stats - Min: " << min << " | Max: " << max << " | Median: " << median;
-    arrayStats.setString(oss.str());
+    shownMin = min;
+    shownMax = max;
+    shownMedian = median;
+    dirty |= DIRTY_STATS;
+}
+
+void SimpleUI::updateVerificationInfo(const std::string &summary)
+{
+    verificationInfo.setString(summary);
+}
+
+void SimpleUI::updateSpeedInfo(const std::string &speed)
+{
+    speedInfo.setString(speed);
+}
+
+void SimpleUI::formatDirtyTexts()
+{
+    if (dirty & DIRTY_ARRAY)
+    {
+        // A window of the array around the focus (the last swap), if it does not all fit
+        int first = 0;
+        int last = shownSize;
+        if (shownSize > MAX_DUMP_VALUES)
+        {
+            first = std::min(std::max(shownFocus - MAX_DUMP_VALUES / 2, 0), shownSize - MAX_DUMP_VALUES);
+            last = first + MAX_DUMP_VALUES;
+        }
+
+        std::ostringstream oss;
+        oss << "Array: [" << (first > 0 ? "... " : "");
+        for (int i = first; i < last; i++)
+        {
+            oss << shownArray[i];
+            if (i < last - 1)
+                oss << ", ";
+        }
+        oss << (last < shownSize ? " ...]" : "]");
+        if (first > 0 || last < shownSize)
+            oss << " (" << first << "-" << last - 1 << " of " << shownSize << ")";
+        arrayDisplay.setString(oss.str());
+    }
+
+    if (dirty & DIRTY_STEP)
+    {
+        std::ostringstream oss;
+        if (shownComplete)
+        {
+            oss << "Sorting Complete! Steps taken: " << shownStep;
+        }
+        else
+        {
+            oss << "Step: " << shownStep;
+        }
+        stepInfo.setString(oss.str());
+    }
+
+    if (dirty & DIRTY_SWAPS)
+    {
+        std::ostringstream oss;
+        oss << "Swaps: " << shownSwaps;
+        swapInfo.setString(oss.str());
+    }
+
+    if (dirty & DIRTY_STATS)
+    {
+        std::ostringstream oss;
+        oss << "Array Stats - Min: " << shownMin << " | Max: " << shownMax << " | Median: " << shownMedian;
+        arrayStats.setString(oss.str());
+    }
+
+    dirty = 0;
 }
 
 void SimpleUI::render(sf::RenderWindow &window)
 {
+    formatDirtyTexts();
+
     window.draw(algorithmName);
     window.draw(instructions);
     window.draw(arrayDisplay);
@@ -173,4 +245,6 @@ void SimpleUI::render(sf::RenderWindow &window)
     window.draw(complexityInfo);
     window.draw(algorithmDescription);
     window.draw(arrayStats);
+    window.draw(verificationInfo);
+    window.draw(speedInfo);
 }
@@ -1,12 +1,31 @@
 #pragma once
 #include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <string>
 
 /**
  * Simple UI manager for displaying text and instructions
+ *
+ * The texts that change with every step (array, step and swap counts, stats)
+ * are retained: their update calls only store the new values and mark them
+ * dirty, and render() formats each dirty text once per frame, however many
+ * steps ran in between. The array is read at render time, so it must stay
+ * valid until then; at most MAX_DUMP_VALUES of it are shown, around the
+ * focus index.
  */
 class SimpleUI
 {
 private:
+    static const int MAX_DUMP_VALUES = 32;
+
+    enum DirtyText
+    {
+        DIRTY_ARRAY = 1 << 0,
+        DIRTY_STEP = 1 << 1,
+        DIRTY_SWAPS = 1 << 2,
+        DIRTY_STATS = 1 << 3
+    };
+
     sf::Font font;
     sf::Text algorithmName;
     sf::Text instructions;
@@ -17,18 +36,35 @@ private:
     sf::Text complexityInfo;
     sf::Text algorithmDescription;
     sf::Text arrayStats;
+    sf::Text verificationInfo;
+    sf::Text speedInfo;
     bool fontLoaded;
 
+    // Retained values, formatted by render()
+    unsigned dirty = 0;
+    const int *shownArray = nullptr;
+    int shownSize = 0;
+    int shownFocus = -1;
+    int shownStep = 0;
+    bool shownComplete = false;
+    int shownSwaps = 0;
+    int shownMin = 0, shownMax = 0, shownMedian = 0;
+
+    void formatDirtyTexts();
+
 public:
     bool initialize();
+    const sf::Font *getFont() const { return fontLoaded ? &font : nullptr; }
     void updateAlgorithmName(const char *name);
     void updateInstructions(bool paused);
-    void updateArrayDisplay(int array[], int size);
+    void updateArrayDisplay(const int array[], int size, int focus = -1);
     void updateStepInfo(int step, bool complete);
     void updateSwapInfo(int swaps);
-    void updateArraySize(int size);
+    void updateArraySize(int size, uint64_t seed);
     void updateComplexityInfo(const char* best, const char* avg, const char* worst);
     void updateAlgorithmDescription(const char* description);
     void updateArrayStats(int min, int max, int median);
+    void updateVerificationInfo(const std::string &summary);
+    void updateSpeedInfo(const std::string &speed);
     void render(sf::RenderWindow &window);
 };
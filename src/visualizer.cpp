@@ -1,22 +1,23 @@
 #include "visualizer.h"
 #include "../algorithms/algorithm_registry.h"
-#include <random>
+#include "../algorithms/input_generator.h"
+#include "../algorithms/selection.h"
+#include "../algorithms/sort_verifier.h"
+#include "../algorithms/trace.h"
 #include <algorithm>
 #include <cstring>
 #include <iostream>
 #include <cstring>
 
-const float SortingVisualizer::FRAME_DURATION = 1.0f / 60.0f;
-
 SortingVisualizer::SortingVisualizer(sf::RenderWindow &win)
-    : window(win), array(nullptr), originalArray(nullptr), arraySize(7),
+    : window(win), array(nullptr), originalArray(nullptr), arraySize(7), statsStale(false),
       currentAlgorithm(nullptr), currentAlgorithmIndex(0),
-      isPaused(true), stepCount(0), swapCount(0), highlightIndex1(-1), highlightIndex2(-1),
-      sortingComplete(false), comparisonModeActive(false)
+      isPaused(true), callsMade(0), runLength(-1), stepCount(0), swapCount(0), highlightIndex1(-1), highlightIndex2(-1),
+      sortingComplete(false), comparisonModeActive(false), inputSeed(0)
 {
-    // Allocate dynamic arrays
-    array = new int[MAX_ARRAY_SIZE];
-    originalArray = new int[MAX_ARRAY_SIZE];
+    // Both arrays live as long as the visualizer, so the arena is never reset
+    array = arena.allocateArray<int>(MAX_ARRAY_SIZE);
+    originalArray = arena.allocateArray<int>(MAX_ARRAY_SIZE);
 
     // Initialize array with simple values
     initializeArray();
@@ -24,9 +25,7 @@ SortingVisualizer::SortingVisualizer(sf::RenderWindow &win)
 
 SortingVisualizer::~SortingVisualizer()
 {
-    // Clean up dynamic arrays
-    delete[] array;
-    delete[] originalArray;
+    // The arena releases the arrays
 }
 
 bool SortingVisualizer::initialize()
@@ -36,6 +35,7 @@ bool SortingVisualizer::initialize()
 
     // Initialize comparison mode
     comparisonMode.initialize();
+    perfHud.initialize(ui.getFont());
 
     // Check if algorithms are registered
     int algorithmCount = getAlgorithmCount();
@@ -62,13 +62,7 @@ bool SortingVisualizer::initialize()
 
 void SortingVisualizer::initializeArray()
 {
-    // Create a simple array with values 1 to arraySize
-    for (int i = 0; i < arraySize; i++)
-    {
-        array[i] = i + 1;
-    }
-
-    // Shuffle the array
+    // A shuffle of 1 to arraySize
     randomizeArray();
 
     // Save original for reset
@@ -78,11 +72,14 @@ void SortingVisualizer::initializeArray()
     }
 }
 
+/**
+ * Shuffle 1..arraySize with the next seed, so a session replays the same inputs
+ */
 void SortingVisualizer::randomizeArray()
 {
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::shuffle(array, array + arraySize, gen);
+    InputSpec spec;
+    spec.seed = ++inputSeed;
+    generateInput(spec, array, arraySize);
 }
 
 void SortingVisualizer::resetAlgorithm()
@@ -96,10 +93,14 @@ void SortingVisualizer::resetAlgorithm()
         array[i] = originalArray[i];
     }
 
-    // Clear algorithm state
-    std::memset(algorithmState, 0, sizeof(algorithmState));
+    // Fresh algorithm state
+    algorithmRun.start(*currentAlgorithm, arraySize);
+    history.clear();
+    measureRunLength();
+    scheduler.restart();
 
     // Reset visualization state
+    callsMade = 0;
     stepCount = 0;
     swapCount = 0;
     highlightIndex1 = -1;
@@ -112,19 +113,68 @@ void SortingVisualizer::resetAlgorithm()
     ui.updateArrayDisplay(array, arraySize);
     ui.updateStepInfo(stepCount, sortingComplete);
     ui.updateSwapInfo(swapCount);
-    ui.updateArraySize(arraySize);
-    
+    ui.updateArraySize(arraySize, inputSeed);
+    ui.updateVerificationInfo("");
+    ui.updateSpeedInfo(scheduler.describe());
+
     // Update algorithm-specific information
     updateAlgorithmInfo();
     updateArrayStats();
 }
 
+/**
+ * Count the step calls the run will take, on a copy of the array, so that
+ * "finish in T seconds" knows the rate it needs
+ */
+void SortingVisualizer::measureRunLength()
+{
+    std::vector<int> probe(originalArray, originalArray + arraySize);
+    SortRun probeRun;
+    probeRun.start(*currentAlgorithm, arraySize);
+
+    long long bound = verificationStepBound(arraySize);
+    for (runLength = 1; runLength <= bound; runLength++)
+    {
+        if (probeRun.step(probe.data()).isComplete)
+            return;
+    }
+    runLength = -1;
+}
+
 void SortingVisualizer::stepForward()
+{
+    TRACE_SCOPE("stepForward");
+    if (advance())
+        refreshRunDisplay();
+}
+
+/**
+ * One step of the algorithm, without touching the UI
+ * @return False if there was nothing left to do
+ */
+bool SortingVisualizer::advance()
 {
     if (!currentAlgorithm || sortingComplete)
-        return;
+        return false;
 
-    SwapResult result = currentAlgorithm->function(array, arraySize, algorithmState);
+    if (algorithmRun.canSnapshot())
+    {
+        if (static_cast<int>(history.size()) >= MAX_HISTORY)
+            history.pop_front();
+
+        StepSnapshot snapshot;
+        algorithmRun.saveState(snapshot.state);
+        snapshot.array.assign(array, array + arraySize);
+        snapshot.callsMade = callsMade;
+        snapshot.stepCount = stepCount;
+        snapshot.swapCount = swapCount;
+        snapshot.highlightIndex1 = highlightIndex1;
+        snapshot.highlightIndex2 = highlightIndex2;
+        history.push_back(std::move(snapshot));
+    }
+
+    SwapResult result = algorithmRun.step(array);
+    callsMade++;
 
     if (result.swapped)
     {
@@ -141,17 +191,61 @@ void SortingVisualizer::stepForward()
 
     sortingComplete = result.isComplete;
 
-    // Update UI
-    ui.updateArrayDisplay(array, arraySize);
+    // Swaps and moves keep the same values; anything else needs a rescan
+    if (!hasCapabilities(*currentAlgorithm, ALGO_PERMUTING))
+        statsStale = true;
+    return true;
+}
+
+void SortingVisualizer::runSteps(int count)
+{
+    for (int i = 0; i < count && advance(); i++)
+    {
+    }
+}
+
+/**
+ * Hand the run's progress to the UI, which formats it when the frame is drawn
+ */
+void SortingVisualizer::refreshRunDisplay()
+{
+    ui.updateArrayDisplay(array, arraySize, highlightIndex1);
     ui.updateStepInfo(stepCount, sortingComplete);
     ui.updateSwapInfo(swapCount);
-    updateArrayStats();
+    if (statsStale)
+        updateArrayStats();
 }
 
 void SortingVisualizer::stepBackward()
 {
-    // TODO: Implement step backward functionality
-    // This would require storing history of array states
+    if (!currentAlgorithm || history.empty())
+        return;
+
+    // Restore the array and the algorithm's state from before the last step
+    const StepSnapshot &snapshot = history.back();
+    algorithmRun.restoreState(snapshot.state);
+    std::copy(snapshot.array.begin(), snapshot.array.end(), array);
+    callsMade = snapshot.callsMade;
+    stepCount = snapshot.stepCount;
+    swapCount = snapshot.swapCount;
+    highlightIndex1 = snapshot.highlightIndex1;
+    highlightIndex2 = snapshot.highlightIndex2;
+    sortingComplete = false;
+    history.pop_back();
+    if (!hasCapabilities(*currentAlgorithm, ALGO_PERMUTING))
+        statsStale = true;
+
+    refreshRunDisplay();
+}
+
+void SortingVisualizer::verifyAlgorithm()
+{
+    if (!currentAlgorithm)
+        return;
+
+    // Runs on a separate duplicate-heavy array so the visible sort is untouched
+    VerificationResult result = ::verifyAlgorithm(*currentAlgorithm, arraySize);
+    ui.updateVerificationInfo(describeVerification(*currentAlgorithm, result));
 }
 
 void SortingVisualizer::nextAlgorithm()
@@ -208,6 +302,7 @@ void SortingVisualizer::resizeArray(int newSize)
 
 void SortingVisualizer::update()
 {
+    TRACE_SCOPE("update");
     InputHandler::Action action = inputHandler.handleInput(window);
 
     switch (action)
@@ -317,6 +412,32 @@ void SortingVisualizer::update()
         }
         break;
 
+    case InputHandler::SPEED_UP:
+        scheduler.faster();
+        ui.updateSpeedInfo(scheduler.describe());
+        break;
+
+    case InputHandler::SLOW_DOWN:
+        scheduler.slower();
+        ui.updateSpeedInfo(scheduler.describe());
+        break;
+
+    case InputHandler::TOGGLE_FINISH_MODE:
+        scheduler.toggleFinishMode();
+        ui.updateSpeedInfo(scheduler.describe());
+        break;
+
+    case InputHandler::TOGGLE_PERF_HUD:
+        perfHud.toggle();
+        break;
+
+    case InputHandler::VERIFY_ALGORITHM:
+        if (!comparisonModeActive)
+        {
+            verifyAlgorithm();
+        }
+        break;
+
     case InputHandler::QUIT:
         window.close();
         break;
@@ -325,43 +446,73 @@ void SortingVisualizer::update()
         break;
     }
 
-    // Auto-step if not paused and frame time has elapsed
-    if (frameClock.getElapsedTime().asSeconds() >= FRAME_DURATION)
+    // Run as many steps as the scheduler fits into this frame
+    double elapsed = frameClock.restart().asSeconds();
+    perfHud.record(PerfHud::PHASE_FRAME, elapsed);
+    if (comparisonModeActive)
     {
-        if (comparisonModeActive)
+        perfHud.setRemainingSteps(-1);
+        if (!comparisonMode.isPausedState() && !comparisonMode.isComplete())
         {
-            if (!comparisonMode.isPausedState() && !comparisonMode.isComplete())
-            {
-                comparisonMode.stepForward();
-            }
+            int steps = scheduler.stepsForFrame(elapsed, -1);
+            sf::Clock stepClock;
+            comparisonMode.stepForward(steps);
+            double stepSeconds = stepClock.getElapsedTime().asSeconds();
+            scheduler.recordSteps(steps, stepSeconds);
+            perfHud.recordSteps(steps, stepSeconds);
         }
-        else if (!isPaused && !sortingComplete)
+    }
+    else if (!isPaused && !sortingComplete)
+    {
+        int steps = scheduler.stepsForFrame(elapsed, runLength < 0 ? -1 : std::max(runLength - callsMade, 1LL));
+        sf::Clock stepClock;
         {
-            stepForward();
+            TRACE_SCOPE("runSteps");
+            runSteps(steps);
         }
-        frameClock.restart();
+        double stepSeconds = stepClock.getElapsedTime().asSeconds();
+        scheduler.recordSteps(steps, stepSeconds);
+        perfHud.recordSteps(steps, stepSeconds);
+
+        if (steps > 0)
+            refreshRunDisplay();
+        ui.updateSpeedInfo(scheduler.describe());
     }
+
+    if (!comparisonModeActive)
+        perfHud.setRemainingSteps(sortingComplete ? 0 : runLength < 0 ? -1 : std::max(runLength - callsMade, 1LL));
 }
 
 void SortingVisualizer::render()
 {
+    TRACE_SCOPE("render");
+    sf::Clock renderClock;
     window.clear(sf::Color::Black);
 
     if (comparisonModeActive)
     {
         // Render comparison mode
         comparisonMode.render(window);
+        perfHud.record(PerfHud::PHASE_RENDER, renderClock.getElapsedTime().asSeconds());
     }
     else
     {
         // Update and render bars
         barRenderer.updateBars(array, arraySize, highlightIndex1, highlightIndex2);
         barRenderer.render(window);
+        perfHud.record(PerfHud::PHASE_RENDER, renderClock.getElapsedTime().asSeconds());
 
         // Render UI
+        sf::Clock uiClock;
+        TRACE_SCOPE("ui text");
         ui.render(window);
+        perfHud.record(PerfHud::PHASE_UI, uiClock.getElapsedTime().asSeconds());
     }
+    perfHud.render(window);
 
+    // display() waits for the frame rate limit, so it is not render cost
+    scheduler.recordRender(renderClock.getElapsedTime().asSeconds());
+    TRACE_SCOPE("display (vsync wait)");
     window.display();
 }
 
@@ -418,6 +569,62 @@ void SortingVisualizer::updateAlgorithmInfo()
         worst = "O(nk)";
         description = "Non-comparison sort using digit distribution";
     }
+    else if (strcmp(currentAlgorithm->name, "Sample Sort") == 0)
+    {
+        best = "O(n log n)";
+        avg = "O(n log n)";
+        worst = "O(n log n)";
+        description = "Splits around sampled splitters into buckets, then sorts each bucket independently";
+    }
+    else if (strcmp(currentAlgorithm->name, "Auto") == 0)
+    {
+        best = "O(n)";
+        avg = "O(n log n)";
+        worst = "O(n log n)";
+        description = "Probes runs, duplicates and range, then runs the engine calibrated fastest for that input";
+    }
+    else if (strcmp(currentAlgorithm->name, "Counting Sort") == 0)
+    {
+        best = "O(n + k)";
+        avg = "O(n + k)";
+        worst = "O(n + k)";
+        description = "Counts each value between min and max, then writes them back in order";
+    }
+    else if (strcmp(currentAlgorithm->name, "Bucket Sort") == 0)
+    {
+        best = "O(n)";
+        avg = "O(n)";
+        worst = "O(n²)";
+        description = "Scatters values into range buckets by histogram, then sorts within each bucket";
+    }
+    else if (strncmp(currentAlgorithm->name, "Heap Sort", 9) == 0)
+    {
+        best = "O(n log n)";
+        avg = "O(n log n)";
+        worst = "O(n log n)";
+        description = "Builds a max-heap, then moves the top to the end and sifts the new top down";
+    }
+    else if (strcmp(currentAlgorithm->name, "Partial Sort (Heap)") == 0)
+    {
+        best = "O(n log k)";
+        avg = "O(n log k)";
+        worst = "O(n log k)";
+        description = "Keeps the k smallest in a max-heap, then sorts them (k = n/2 here)";
+    }
+    else if (strcmp(currentAlgorithm->name, "Partial Sort (Quickselect)") == 0)
+    {
+        best = "O(n + k log k)";
+        avg = "O(n + k log k)";
+        worst = "O(n²)";
+        description = "Partitions until the k smallest are in front, then sorts them (k = n/2 here)";
+    }
+    else if (strcmp(currentAlgorithm->name, "Nth Element") == 0)
+    {
+        best = "O(n)";
+        avg = "O(n)";
+        worst = "O(n²)";
+        description = "Quickselect: partitions only the side holding rank k until the median is in place";
+    }
 
     ui.updateComplexityInfo(best, avg, worst);
     ui.updateAlgorithmDescription(description);
@@ -430,19 +637,19 @@ void SortingVisualizer::updateArrayStats()
 
     int min = array[0];
     int max = array[0];
-    int sum = array[0];
 
     for (int i = 1; i < arraySize; i++)
     {
         if (array[i] < min) min = array[i];
         if (array[i] > max) max = array[i];
-        sum += array[i];
     }
 
-    // Calculate median (simplified - just middle element for odd size)
-    int median = array[arraySize / 2];
+    // Lower median by selection on a copy: O(n), and the array keeps its order
+    statsScratch.assign(array, array + arraySize);
+    int median = medianInPlace(statsScratch.data(), arraySize);
 
     ui.updateArrayStats(min, max, median);
+    statsStale = false;
 }
 
 void SortingVisualizer::run()
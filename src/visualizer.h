@@ -1,10 +1,16 @@
 #pragma once
 #include <SFML/Graphics.hpp>
 #include "../algorithms/algorithm_interface.h"
+#include "../algorithms/arena.h"
+#include "../algorithms/sort_run.h"
+#include "frame_scheduler.h"
 #include "ui/simple_ui.h"
 #include "ui/bar_renderer.h"
 #include "ui/input_handler.h"
 #include "ui/algorithm_comparison.h"
+#include "ui/perf_hud.h"
+#include <deque>
+#include <vector>
 
 /**
  * Main sorting visualizer class
@@ -15,16 +21,31 @@ class SortingVisualizer
 private:
     static const int MIN_ARRAY_SIZE = 3;
     static const int MAX_ARRAY_SIZE = 50;
-    static const int MAX_STATE_SIZE = 20;
+    static const int MAX_HISTORY = 1000; // Steps that can be undone
 
     // Window reference (needs to be first for initialization order)
     sf::RenderWindow &window;
 
-    // Core data - now dynamic
+    // Core data - carved from the arena once, at full size
+    Arena arena;
     int *array;
     int *originalArray;
     int arraySize;
-    int algorithmState[MAX_STATE_SIZE];
+    std::vector<int> statsScratch; // Copy of the array for the median
+    bool statsStale;               // A step may have changed min, max or median
+    SortRun algorithmRun;
+
+    // Everything needed to undo one step
+    struct StepSnapshot
+    {
+        std::vector<unsigned char> state;
+        std::vector<int> array;
+        long long callsMade;
+        int stepCount;
+        int swapCount;
+        int highlightIndex1, highlightIndex2;
+    };
+    std::deque<StepSnapshot> history;
 
     // Current algorithm
     AlgorithmInfo *currentAlgorithm;
@@ -32,25 +53,29 @@ private:
 
     // Visualization state
     bool isPaused;
+    long long callsMade; // Calls to the step function so far
+    long long runLength; // Calls the whole run takes (-1 if it could not be measured)
     int stepCount;
     int swapCount;
     int highlightIndex1, highlightIndex2;
     bool sortingComplete;
     bool comparisonModeActive;
+    uint64_t inputSeed; // Seed of the current input
 
-    // Frame timing
+    // Frame timing: how many steps each frame runs
     sf::Clock frameClock;
-    static const float FRAME_DURATION; // 1/60 second
+    FrameScheduler scheduler;
 
     // UI Components
     SimpleUI ui;
     BarRenderer barRenderer;
     InputHandler inputHandler;
     AlgorithmComparison comparisonMode;
+    PerfHud perfHud;
 
 public:
     SortingVisualizer(sf::RenderWindow &win);
-    ~SortingVisualizer(); // Destructor to clean up dynamic arrays
+    ~SortingVisualizer();
     bool initialize();
     void run();
 
@@ -58,7 +83,11 @@ private:
     void initializeArray();
     void resetAlgorithm();
     void stepForward();
-    void stepBackward(); // For future implementation
+    void stepBackward();
+    bool advance();
+    void runSteps(int count);
+    void refreshRunDisplay();
+    void measureRunLength();
     void nextAlgorithm();
     void selectAlgorithm(int algorithmIndex);
     void increaseArraySize();
@@ -67,6 +96,7 @@ private:
     void update();
     void render();
     void randomizeArray();
+    void verifyAlgorithm();
     
 private:
     void updateAlgorithmInfo();
@@ -0,0 +1,571 @@
+#include "../algorithms/algorithm_registry.h"
+#include "../algorithms/arena.h"
+#include "../algorithms/auto_sort.h"
+#include "../algorithms/columnar_sort.h"
+#include "../algorithms/float_sort.h"
+#include "../algorithms/heap_sort.h"
+#include "../algorithms/incremental_sort.h"
+#include "../algorithms/input_generator.h"
+#include "../algorithms/register_algorithms.h"
+#include "../algorithms/sort_runner.h"
+#include "../algorithms/string_sort.h"
+#include "../algorithms/thread_pool.h"
+#include "../algorithms/trace.h"
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * Benchmark suite for the bulk sort engines
+ *
+ *   sortbench [--max-size N] [--cache FILE] [--no-save] [--threads N] [--pin-threads]
+ *   sortbench --heap [--max-size N]
+ *   sortbench --incremental [--max-size N]
+ *   sortbench --columnar [--max-size N]
+ *   sortbench --strings [--max-size N]
+ *   sortbench --floats [--max-size N]
+ *   sortbench --inputs [--max-size N] [--seed S]
+ *
+ * Times every bulk-capable algorithm on each input shape (random, nearly
+ * sorted, few distinct, small range) at sizes 2^6, 2^8, ... up to max-size,
+ * prints the grid and writes the winners to the Auto engine's cache file
+ * (default: $SORT_AUTOTUNE_CACHE or autotune.cache)
+ *
+ * --heap instead races the d-ary heap sorts against a textbook binary heap
+ * sort on random arrays up to max-size (default 2^24 ints, larger than most
+ * last-level caches)
+ *
+ * --incremental keeps a table of max-size scores (default 2^20) ranked while
+ * 0.1% of them change per tick, timing a full re-sort of the table against
+ * IncrementalSort::apply() with the same updates
+ *
+ * --columnar sorts a batch of max-size rows (default 2^20) by two columns,
+ * region ascending then a nullable amount descending, nulls last, timing
+ * sortColumnar() against std::stable_sort of row indices with a comparator
+ * that reads the columns
+ *
+ * --strings sorts max-size (default 2^20) URLs, log keys and UUIDs with
+ * each string engine, against std::sort of std::string
+ *
+ * --floats sorts max-size (default 2^20) doubles and floats with 1% NaNs and
+ * some -0.0, NaNs last, through the order-preserving keys (radix passes, and
+ * for floats Merge Sort and Quick Sort on the keys), against std::sort with a
+ * NaN-aware comparator
+ *
+ * --inputs generates max-size ints (default 2^20) from every distribution of
+ * input_generator.h with one seed, reporting the generation rate, and times
+ * every bulk engine on each (engines are skipped after taking 10 s on one)
+ */
+
+namespace
+{
+template <typename Sort>
+double timeSort(const std::vector<int> &input, std::vector<int> &work, Sort sort)
+{
+    std::copy(input.begin(), input.end(), work.begin());
+    auto start = std::chrono::steady_clock::now();
+    sort(work.data(), static_cast<int>(work.size()));
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int compareHeapSorts(int maxSize)
+{
+    const char *const engines[] = {"Heap Sort", "Heap Sort (4-ary)", "Heap Sort (8-ary)"};
+    Arena scratch;
+    InputSpec spec;
+    spec.distribution = DIST_UNIFORM;
+    spec.seed = 20240;
+    spec.range = INT_MAX;
+
+    for (int size = 1 << 16; size <= maxSize; size *= 4)
+    {
+        std::vector<int> input(size);
+        std::vector<int> work(size);
+        generateInput(spec, input.data(), size);
+
+        double baseline = timeSort(input, work, heapSortTextbook);
+        std::printf("%10d | textbook %.1fns/elem", size, baseline * 1e9 / size);
+
+        for (const char *name : engines)
+        {
+            const AlgorithmInfo *algorithm = getAlgorithmByName(name);
+            if (!algorithm || !algorithm->bulkFunction)
+                continue;
+
+            scratch.reset();
+            double seconds = timeSort(input, work, [&](int *array, int n) {
+                algorithm->bulkFunction(array, n, scratch);
+            });
+            std::printf(", %s %.1fns/elem (%.2fx)", name, seconds * 1e9 / size, baseline / seconds);
+        }
+        std::printf("\n");
+    }
+    return 0;
+}
+
+int compareIncremental(int size)
+{
+    const int ticks = 20;
+    int changesPerTick = std::max(1, size / 1000);
+    SeededRandom random(20240);
+
+    std::vector<int> scores(size);
+    for (int &score : scores)
+        score = static_cast<int>(random() % 1000000);
+
+    IncrementalSort ranking;
+    ranking.assign(scores);
+
+    Arena scratch;
+    std::vector<int> resorted(size);
+    std::vector<SortedChange> changes(changesPerTick);
+    double fullSeconds = 0;
+    double incrementalSeconds = 0;
+    std::string error;
+
+    for (int tick = 0; tick < ticks; tick++)
+    {
+        for (SortedChange &change : changes)
+        {
+            int &score = scores[random() % size];
+            change = {CHANGE_UPDATE, score, static_cast<int>(random() % 1000000)};
+            score = change.newValue;
+        }
+
+        scratch.reset();
+        fullSeconds += timeSort(scores, resorted, [&](int *array, int n) { autoSortAll(array, n, scratch); });
+
+        auto start = std::chrono::steady_clock::now();
+        bool applied = ranking.apply(changes.data(), changesPerTick, error);
+        incrementalSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        if (!applied)
+        {
+            std::fprintf(stderr, "sortbench: %s\n", error.c_str());
+            return 1;
+        }
+        if (ranking.values() != resorted)
+        {
+            std::fprintf(stderr, "sortbench: incremental ranking diverged at tick %d\n", tick);
+            return 1;
+        }
+    }
+
+    std::printf("%d scores, %d changes per tick | full re-sort %.3fms/tick, incremental %.3fms/tick (%.1fx)\n", size,
+                changesPerTick, fullSeconds * 1e3 / ticks, incrementalSeconds * 1e3 / ticks,
+                fullSeconds / incrementalSeconds);
+    return 0;
+}
+
+int compareColumnar(int rows)
+{
+    const int repeats = 5;
+    SeededRandom random(20240);
+
+    // 50 regions, amounts with 5% nulls
+    std::vector<int32_t> region(rows);
+    std::vector<int64_t> amount(rows);
+    std::vector<uint8_t> amountValid((rows + 7) / 8, 0);
+    for (int i = 0; i < rows; i++)
+    {
+        region[i] = static_cast<int32_t>(random() % 50);
+        amount[i] = static_cast<int64_t>(random() >> 32) * 1000 - 2000000000000LL;
+        if (random() % 20 != 0)
+            amountValid[i / 8] |= static_cast<uint8_t>(1 << (i % 8));
+    }
+
+    RecordBatch batch;
+    batch.rowCount = rows;
+    batch.columns.push_back({COLUMN_INT32, region.data(), nullptr});
+    batch.columns.push_back({COLUMN_INT64, amount.data(), amountValid.data()});
+    const SortKey keys[] = {{0, false, false}, {1, true, false}};
+
+    auto rowLess = [&](uint32_t a, uint32_t b) {
+        if (region[a] != region[b])
+            return region[a] < region[b];
+        bool validA = (amountValid[a / 8] >> (a % 8)) & 1;
+        bool validB = (amountValid[b / 8] >> (b % 8)) & 1;
+        if (validA != validB)
+            return validA;
+        return validA && amount[a] > amount[b];
+    };
+
+    Arena scratch;
+    std::vector<uint32_t> order;
+    std::vector<uint32_t> expected(rows);
+    std::string error;
+    double rowSeconds = 0;
+    double columnarSeconds = 0;
+
+    for (int repeat = 0; repeat < repeats; repeat++)
+    {
+        for (int i = 0; i < rows; i++)
+            expected[i] = i;
+        auto start = std::chrono::steady_clock::now();
+        std::stable_sort(expected.begin(), expected.end(), rowLess);
+        rowSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        scratch.reset();
+        start = std::chrono::steady_clock::now();
+        bool sorted = sortColumnar(batch, keys, 2, order, scratch, error);
+        columnarSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        if (!sorted)
+        {
+            std::fprintf(stderr, "sortbench: %s\n", error.c_str());
+            return 1;
+        }
+        if (order != expected)
+        {
+            std::fprintf(stderr, "sortbench: columnar order differs from the row comparator's\n");
+            return 1;
+        }
+    }
+
+    std::printf("%d rows, ORDER BY region, amount DESC NULLS LAST | row comparator %.1fms, columnar %.1fms (%.2fx)\n",
+                rows, rowSeconds * 1e3 / repeats, columnarSeconds * 1e3 / repeats, rowSeconds / columnarSeconds);
+    return 0;
+}
+
+const char *const STRING_DATASETS[] = {"urls", "log keys", "uuids"};
+
+std::string makeDatasetString(int dataset, SeededRandom &random)
+{
+    char text[160];
+    switch (dataset)
+    {
+    case 0: // Few hosts, deep shared paths
+        std::snprintf(text, sizeof(text), "https://www.shop%u.example.com/catalog/category-%u/item/%u?ref=%u",
+                      static_cast<unsigned>(random() % 20), static_cast<unsigned>(random() % 200),
+                      static_cast<unsigned>(random() % 1000000), static_cast<unsigned>(random() % 10));
+        break;
+    case 1: // Timestamp-first log keys
+        std::snprintf(text, sizeof(text), "2024-06-%02u %02u:%02u:%02u.%03u host-%02u svc-%u %s",
+                      static_cast<unsigned>(1 + random() % 30), static_cast<unsigned>(random() % 24),
+                      static_cast<unsigned>(random() % 60), static_cast<unsigned>(random() % 60),
+                      static_cast<unsigned>(random() % 1000), static_cast<unsigned>(random() % 64),
+                      static_cast<unsigned>(random() % 16), random() % 8 == 0 ? "WARN" : "INFO");
+        break;
+    default: // Random hex, no shared prefixes
+        std::snprintf(text, sizeof(text), "%08x-%04x-4%03x-%04x-%08x%04x", static_cast<unsigned>(random()),
+                      static_cast<unsigned>(random() & 0xFFFF), static_cast<unsigned>(random() & 0xFFF),
+                      static_cast<unsigned>(0x8000 | (random() & 0x3FFF)), static_cast<unsigned>(random()),
+                      static_cast<unsigned>(random() & 0xFFFF));
+        break;
+    }
+    return text;
+}
+
+int compareStringSorts(int count)
+{
+    SeededRandom random(20240);
+    Arena scratch;
+    std::vector<uint32_t> order(count);
+
+    for (int dataset = 0; dataset < 3; dataset++)
+    {
+        std::vector<std::string> strings(count);
+        std::string bytes;
+        std::vector<uint64_t> offsets(1, 0);
+        for (std::string &text : strings)
+        {
+            text = makeDatasetString(dataset, random);
+            bytes += text;
+            offsets.push_back(bytes.size());
+        }
+        StringBatch batch = {bytes.data(), offsets.data(), strings.size()};
+
+        std::vector<std::string> expected(strings);
+        auto start = std::chrono::steady_clock::now();
+        std::sort(expected.begin(), expected.end());
+        double baseline = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::printf("%-8s %9d | std::sort(std::string) %.1fms", STRING_DATASETS[dataset], count, baseline * 1e3);
+
+        for (int engine = 0; engine < STRING_ENGINE_COUNT; engine++)
+        {
+            scratch.reset();
+            start = std::chrono::steady_clock::now();
+            sortStrings(static_cast<StringSortEngine>(engine), batch, order.data(), scratch);
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            for (int i = 0; i < count; i++)
+            {
+                if (strings[order[i]] != expected[i])
+                {
+                    std::fprintf(stderr, "\nsortbench: %s misordered %s\n",
+                                 stringSortEngineName(static_cast<StringSortEngine>(engine)), STRING_DATASETS[dataset]);
+                    return 1;
+                }
+            }
+            std::printf(", %s %.1fms (%.2fx)", stringSortEngineName(static_cast<StringSortEngine>(engine)),
+                        seconds * 1e3, baseline / seconds);
+        }
+        std::printf("\n");
+    }
+    return 0;
+}
+
+template <typename Float>
+bool nanAwareLess(Float a, Float b)
+{
+    return std::isnan(b) ? !std::isnan(a) : a < b;
+}
+
+/**
+ * Same order as the comparator's: NaN where it has NaN, equal values elsewhere
+ */
+template <typename Float>
+bool sameFloatOrder(const std::vector<Float> &sorted, const std::vector<Float> &expected)
+{
+    for (size_t i = 0; i < sorted.size(); i++)
+    {
+        if (std::isnan(sorted[i]) != std::isnan(expected[i]) || (!std::isnan(sorted[i]) && sorted[i] != expected[i]))
+            return false;
+    }
+    return true;
+}
+
+template <typename Float>
+std::vector<Float> makeMetrics(int size, SeededRandom &random)
+{
+    std::vector<Float> values(size);
+    std::normal_distribution<double> latency(250.0, 80.0);
+    for (Float &value : values)
+    {
+        unsigned kind = random() % 100;
+        if (kind == 0)
+            value = std::numeric_limits<Float>::quiet_NaN();
+        else if (kind == 1)
+            value = static_cast<Float>(-0.0);
+        else
+            value = static_cast<Float>(latency(random));
+    }
+    return values;
+}
+
+template <typename Float, typename Sort>
+double timeFloatSort(const std::vector<Float> &input, const std::vector<Float> &expected, Sort sort, bool &correct)
+{
+    std::vector<Float> work(input);
+    auto start = std::chrono::steady_clock::now();
+    sort(work);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    correct = correct && sameFloatOrder(work, expected);
+    return seconds;
+}
+
+int compareFloatSorts(int size)
+{
+    SeededRandom random(20240);
+    const FloatOrder order = {NANS_LAST, false};
+    bool correct = true;
+
+    std::vector<double> doubles = makeMetrics<double>(size, random);
+    std::vector<double> expectedDoubles(doubles);
+    auto start = std::chrono::steady_clock::now();
+    std::sort(expectedDoubles.begin(), expectedDoubles.end(), nanAwareLess<double>);
+    double baseline = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double seconds = timeFloatSort(doubles, expectedDoubles,
+                                   [&](std::vector<double> &work) { sortDoubles(work.data(), work.size(), order); },
+                                   correct);
+    std::printf("double %9d | std::sort + NaN comparator %.1fms, radix keys %.1fms (%.2fx)\n", size, baseline * 1e3,
+                seconds * 1e3, baseline / seconds);
+
+    std::vector<float> floats = makeMetrics<float>(size, random);
+    std::vector<float> expectedFloats(floats);
+    start = std::chrono::steady_clock::now();
+    std::sort(expectedFloats.begin(), expectedFloats.end(), nanAwareLess<float>);
+    baseline = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::printf("float  %9d | std::sort + NaN comparator %.1fms", size, baseline * 1e3);
+
+    const char *const engines[] = {nullptr, "Merge Sort", "Quick Sort"};
+    std::string error;
+    for (const char *name : engines)
+    {
+        const AlgorithmInfo *engine = name ? getAlgorithmByName(name) : nullptr;
+        seconds = timeFloatSort(floats, expectedFloats,
+                                [&](std::vector<float> &work) {
+                                    if (!sortFloats(work.data(), work.size(), order, engine, error))
+                                        std::fprintf(stderr, "\nsortbench: %s\n", error.c_str());
+                                },
+                                correct);
+        std::printf(", %s %.1fms (%.2fx)", name ? name : "radix keys", seconds * 1e3, baseline / seconds);
+    }
+    std::printf("\n");
+
+    if (!correct)
+    {
+        std::fprintf(stderr, "sortbench: a float sort disagreed with the comparator\n");
+        return 1;
+    }
+    return 0;
+}
+
+int compareInputs(int size, uint64_t seed)
+{
+    const double GIVE_UP_SECONDS = 10.0;
+    std::vector<int> input(size);
+    std::vector<int> work(size);
+    std::vector<bool> gaveUp(getAlgorithmCount(), false);
+    Arena scratch;
+
+    for (int distribution = 0; distribution < DIST_COUNT; distribution++)
+    {
+        InputSpec spec;
+        spec.distribution = static_cast<InputDistribution>(distribution);
+        spec.seed = seed;
+        auto start = std::chrono::steady_clock::now();
+        generateInput(spec, input.data(), size);
+        double generateSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::printf("%-14s %9d | generated at %.0fM/s", inputDistributionName(spec.distribution), size,
+                    size / generateSeconds / 1e6);
+
+        for (int i = 0; i < getAlgorithmCount(); i++)
+        {
+            const AlgorithmInfo *algorithm = getAlgorithmByIndex(i);
+            if (!isBulkSortEngine(*algorithm))
+                continue;
+            if (gaveUp[i])
+            {
+                std::printf(", %s skipped", algorithm->name);
+                continue;
+            }
+
+            scratch.reset();
+            double seconds = timeSort(input, work, [&](int *array, int n) { algorithm->bulkFunction(array, n, scratch); });
+            if (!std::is_sorted(work.begin(), work.end()))
+            {
+                std::fprintf(stderr, "\nsortbench: %s did not sort %s\n", algorithm->name,
+                             inputDistributionName(spec.distribution));
+                return 1;
+            }
+            gaveUp[i] = seconds > GIVE_UP_SECONDS;
+            std::printf(", %s %.1fns/elem", algorithm->name, seconds * 1e9 / size);
+        }
+        std::printf("\n");
+    }
+    return 0;
+}
+}
+
+int main(int argc, char **argv)
+{
+    int maxSize = 0;
+    bool heap = false;
+    bool incremental = false;
+    bool columnar = false;
+    bool strings = false;
+    bool floats = false;
+    bool inputs = false;
+    uint64_t seed = 1;
+    std::string cachePath = defaultAutoSortCachePath();
+    bool save = true;
+    int threads = 0;
+    bool pinThreads = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--max-size") == 0 && hasValue)
+            maxSize = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--cache") == 0 && hasValue)
+            cachePath = argv[++i];
+        else if (std::strcmp(argv[i], "--heap") == 0)
+            heap = true;
+        else if (std::strcmp(argv[i], "--incremental") == 0)
+            incremental = true;
+        else if (std::strcmp(argv[i], "--columnar") == 0)
+            columnar = true;
+        else if (std::strcmp(argv[i], "--strings") == 0)
+            strings = true;
+        else if (std::strcmp(argv[i], "--floats") == 0)
+            floats = true;
+        else if (std::strcmp(argv[i], "--inputs") == 0)
+            inputs = true;
+        else if (std::strcmp(argv[i], "--seed") == 0 && hasValue)
+            seed = std::strtoull(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "--no-save") == 0)
+            save = false;
+        else if (std::strcmp(argv[i], "--threads") == 0 && hasValue)
+            threads = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--pin-threads") == 0)
+            pinThreads = true;
+        else
+        {
+            std::fprintf(stderr, "usage: sortbench [--max-size N] [--cache FILE] [--no-save] [--threads N] "
+                                 "[--pin-threads]\n"
+                                 "       sortbench --heap [--max-size N]\n"
+                                 "       sortbench --incremental [--max-size N]\n"
+                                 "       sortbench --columnar [--max-size N]\n"
+                                 "       sortbench --strings [--max-size N]\n"
+                                 "       sortbench --floats [--max-size N]\n"
+                                 "       sortbench --inputs [--max-size N] [--seed S]\n");
+            return 1;
+        }
+    }
+
+    configureThreadPool(threads, pinThreads);
+    registerAllAlgorithms();
+    startTracingFromEnvironment();
+
+    if (heap)
+        return compareHeapSorts(maxSize > 0 ? maxSize : 1 << 24);
+    if (maxSize <= 0)
+        maxSize = 1 << 20;
+    if (incremental)
+        return compareIncremental(maxSize);
+    if (columnar)
+        return compareColumnar(maxSize);
+    if (strings)
+        return compareStringSorts(maxSize);
+    if (floats)
+        return compareFloatSorts(maxSize);
+    if (inputs)
+        return compareInputs(maxSize, seed);
+    std::printf("%d threads, sizes up to %d\n", getThreadPool().size(), maxSize);
+
+    std::vector<CalibrationResult> results = calibrateAutoSort(maxSize);
+
+    // One block per shape and size, fastest marked
+    for (size_t first = 0; first < results.size();)
+    {
+        size_t last = first;
+        size_t best = first;
+        while (last < results.size() && results[last].shape == results[first].shape &&
+               results[last].size == results[first].size)
+        {
+            if (results[last].seconds < results[best].seconds)
+                best = last;
+            last++;
+        }
+
+        std::printf("%-14s %9d |", inputShapeName(results[first].shape), results[first].size);
+        for (size_t i = first; i < last; i++)
+        {
+            std::printf(" %s%s %.1fns/elem", i == best ? "*" : "", results[i].algorithm->name,
+                        results[i].seconds * 1e9 / results[i].size);
+            std::printf(i + 1 < last ? "," : "\n");
+        }
+        first = last;
+    }
+
+    if (save)
+    {
+        std::string error;
+        if (!saveAutoSortCache(cachePath, error))
+        {
+            std::fprintf(stderr, "sortbench: %s\n", error.c_str());
+            return 1;
+        }
+        std::printf("choices written to %s\n", cachePath.c_str());
+    }
+    return 0;
+}
@@ -0,0 +1,112 @@
+#include "../algorithms/algorithm_registry.h"
+#include "../algorithms/register_algorithms.h"
+#include "../algorithms/sort_verifier.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+/**
+ * Verification suite for every registered algorithm
+ *
+ *   sortcheck [--max-size N] [--seed S] [--rounds N]
+ *
+ * Drives each step function to completion on random, sorted, reversed,
+ * all-equal, few-distinct, negative, INT_MIN/INT_MAX, organ-pipe and
+ * quicksort-killer inputs at sizes 0..17 and around powers of two up to max-size (default 256), then
+ * checks the whole-array path on the same inputs. Quick Sort's guard against
+ * adversarial input is held to an n log n step budget and must step in on a
+ * median-of-3 killer (verifyQuickSortGuard), and IncrementalSort's batches
+ * are checked against a full sort (verifyIncrementalSort). Each round uses the next
+ * seed. Prints every failing case and exits 1 if there was one. Configure with
+ * -DSORT_SANITIZE=ON to run it under AddressSanitizer and UBSan.
+ *
+ * Compiled with SORT_FUZZER defined (cmake -DSORT_FUZZ=ON, Clang only) this is
+ * the libFuzzer target sortfuzz instead: the first input byte picks the
+ * algorithm, the rest are the keys.
+ */
+
+#ifdef SORT_FUZZER
+
+// Keeps the quadratic step functions fast enough to fuzz
+static const size_t FUZZ_MAX_KEYS = 512;
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    static bool registered = (registerAllAlgorithms(), true);
+    (void)registered;
+    if (size == 0)
+        return 0;
+
+    const AlgorithmInfo &algorithm = *getAlgorithmByIndex(data[0] % getAlgorithmCount());
+    std::vector<int> keys(std::min((size - 1) / sizeof(int), FUZZ_MAX_KEYS));
+    if (!keys.empty())
+        std::memcpy(keys.data(), data + 1, keys.size() * sizeof(int));
+
+    int count = static_cast<int>(keys.size());
+    VerificationResult result = verifyAlgorithm(algorithm, keys.data(), count, verificationStepBound(count));
+    std::string failure = verificationPassed(algorithm, result) ? "" : describeVerification(algorithm, result);
+    if (failure.empty())
+    {
+        Arena scratch;
+        failure = verifyFastPath(algorithm, keys, scratch);
+    }
+
+    if (!failure.empty())
+    {
+        std::fprintf(stderr, "%s, n=%d: %s\n", algorithm.name, count, failure.c_str());
+        std::abort();
+    }
+    return 0;
+}
+
+#else
+
+int main(int argc, char **argv)
+{
+    int maxSize = 256;
+    unsigned seed = 1;
+    int rounds = 1;
+
+    for (int i = 1; i < argc; i++)
+    {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--max-size") == 0 && hasValue)
+            maxSize = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--seed") == 0 && hasValue)
+            seed = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        else if (std::strcmp(argv[i], "--rounds") == 0 && hasValue)
+            rounds = std::atoi(argv[++i]);
+        else
+        {
+            std::fprintf(stderr, "usage: sortcheck [--max-size N] [--seed S] [--rounds N]\n");
+            return 1;
+        }
+    }
+
+    registerAllAlgorithms();
+
+    size_t failed = 0;
+    for (int round = 0; round < rounds; round++)
+    {
+        std::vector<std::string> failures = verifyAllAlgorithms(std::max(maxSize, 0), seed + round);
+        std::vector<std::string> guardFailures = verifyQuickSortGuard(seed + round);
+        failures.insert(failures.end(), guardFailures.begin(), guardFailures.end());
+        std::vector<std::string> incrementalFailures = verifyIncrementalSort(seed + round);
+        failures.insert(failures.end(), incrementalFailures.begin(), incrementalFailures.end());
+        for (const std::string &failure : failures)
+        {
+            std::printf("FAIL %s\n", failure.c_str());
+        }
+        failed += failures.size();
+    }
+
+    std::printf("%d algorithms, %d round(s), sizes up to %d: %zu failure(s)\n", getAlgorithmCount(), rounds, maxSize,
+                failed);
+    return failed == 0 ? 0 : 1;
+}
+
+#endif
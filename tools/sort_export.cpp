@@ -0,0 +1,307 @@
+#include "../algorithms/algorithm_registry.h"
+#include "../algorithms/input_generator.h"
+#include "../algorithms/register_algorithms.h"
+#include "../algorithms/sort_run.h"
+#include "../algorithms/sort_verifier.h"
+#include "../algorithms/thread_pool.h"
+#include "frame_encoder.h"
+#include "ui/column_renderer.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <vector>
+
+/**
+ * Headless export of sort runs as video or PNG frame sequences
+ *
+ *   sortexport <output.y4m | frame-dir> [--algorithm NAME]... [--size N] [--input KIND] [--seed S]
+ *              [--every K | --frames N] [--max-frames N] [--width W] [--height H] [--fps F]
+ *              [--threads N]
+ *
+ * Renders into an offscreen sf::RenderTexture, so no window is opened. It
+ * still needs an OpenGL context: on a build machine without a display run it
+ * under Xvfb (xvfb-run -a sortexport ...) or a software GL such as Mesa's
+ * llvmpipe (LIBGL_ALWAYS_SOFTWARE=1).
+ *
+ * Every --algorithm gets its own lane, top to bottom, all sorting the same
+ * input (default Quick Sort on a shuffled 1..size, size 10^6). A frame is
+ * taken every K step calls (default 1); --frames N instead picks K so the
+ * longest run fits in about N frames, falling back to K when a run is too long
+ * to measure (see verificationStepBound). Lanes step in parallel, frames are read
+ * back on this thread (the GL context's), and encoding and writing overlap
+ * with rendering on the thread pool (see FrameEncoder).
+ */
+
+namespace
+{
+/** Smallest lane, in pixels, including the gap drawn between lanes */
+const unsigned MIN_LANE_HEIGHT = 16;
+const unsigned LANE_GAP = 4;
+
+struct Lane
+{
+    const AlgorithmInfo *algorithm = nullptr;
+    std::vector<int> keys;
+    SortRun run;
+    ColumnRenderer renderer;
+    long long calls = 0;
+    int highlight1 = -1, highlight2 = -1;
+    bool complete = false;
+};
+
+void printUsage()
+{
+    std::fprintf(stderr, "usage: sortexport <output.y4m | frame-dir> [--algorithm NAME]... [--size N] [--input KIND]\n"
+                         "                  [--seed S] [--every K | --frames N] [--max-frames N] [--width W]\n"
+                         "                  [--height H] [--fps F] [--threads N]\n"
+                         "input kinds: shuffled (default)");
+    for (int distribution = 1; distribution < DIST_COUNT; distribution++)
+    {
+        std::fprintf(stderr, ", %s", inputDistributionName(static_cast<InputDistribution>(distribution)));
+    }
+    for (int input = 0; input < INPUT_COUNT; input++)
+    {
+        std::fprintf(stderr, ", %s", verificationInputName(static_cast<VerificationInput>(input)));
+    }
+    std::fprintf(stderr, "\n");
+}
+
+bool makeInput(const char *kind, int size, unsigned seed, std::vector<int> &keys)
+{
+    InputSpec spec;
+    spec.seed = seed;
+    if (findInputDistribution(kind, spec.distribution))
+    {
+        keys.resize(size);
+        generateInput(spec, keys.data(), size);
+        return true;
+    }
+    for (int input = 0; input < INPUT_COUNT; input++)
+    {
+        if (std::strcmp(kind, verificationInputName(static_cast<VerificationInput>(input))) == 0)
+        {
+            makeVerificationInput(static_cast<VerificationInput>(input), size, seed, keys);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Step calls a run takes, counted on a copy of the input; -1 if it has not
+ * finished within verificationStepBound
+ */
+long long measureRunLength(const AlgorithmInfo &algorithm, const std::vector<int> &input)
+{
+    std::vector<int> probe(input);
+    SortRun run;
+    run.start(algorithm, static_cast<int>(probe.size()));
+    long long bound = verificationStepBound(static_cast<int>(probe.size()));
+    for (long long calls = 1; calls <= bound; calls++)
+    {
+        if (run.step(probe.data()).isComplete)
+            return calls;
+    }
+    return -1;
+}
+
+/**
+ * Up to steps calls on one lane, remembering the last swap to highlight it
+ */
+void advanceLane(Lane &lane, long long steps)
+{
+    for (long long i = 0; i < steps && !lane.complete; i++)
+    {
+        SwapResult result = lane.run.step(lane.keys.data());
+        lane.calls++;
+        if (result.swapped)
+        {
+            lane.highlight1 = result.index1;
+            lane.highlight2 = result.index2;
+        }
+        lane.complete = result.isComplete;
+    }
+    if (lane.complete)
+        lane.highlight1 = lane.highlight2 = -1;
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+    if (argc < 2 || argv[1][0] == '-')
+    {
+        printUsage();
+        return 1;
+    }
+
+    const char *output = argv[1];
+    std::vector<const char *> algorithmNames;
+    int size = 1000000;
+    const char *inputKind = "shuffled";
+    unsigned seed = 1;
+    long long every = 1;
+    long long targetFrames = 0;
+    long long maxFrames = 100000;
+    unsigned width = 1280, height = 720;
+    int fps = 60;
+    int threads = 0;
+
+    for (int i = 2; i < argc; i++)
+    {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--algorithm") == 0 && hasValue)
+            algorithmNames.push_back(argv[++i]);
+        else if (std::strcmp(argv[i], "--size") == 0 && hasValue)
+            size = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--input") == 0 && hasValue)
+            inputKind = argv[++i];
+        else if (std::strcmp(argv[i], "--seed") == 0 && hasValue)
+            seed = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        else if (std::strcmp(argv[i], "--every") == 0 && hasValue)
+            every = std::atoll(argv[++i]);
+        else if (std::strcmp(argv[i], "--frames") == 0 && hasValue)
+            targetFrames = std::atoll(argv[++i]);
+        else if (std::strcmp(argv[i], "--max-frames") == 0 && hasValue)
+            maxFrames = std::atoll(argv[++i]);
+        else if (std::strcmp(argv[i], "--width") == 0 && hasValue)
+            width = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        else if (std::strcmp(argv[i], "--height") == 0 && hasValue)
+            height = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        else if (std::strcmp(argv[i], "--fps") == 0 && hasValue)
+            fps = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--threads") == 0 && hasValue)
+            threads = std::atoi(argv[++i]);
+        else
+        {
+            printUsage();
+            return 1;
+        }
+    }
+    if (size < 1 || every < 1 || width == 0 || height == 0 || fps < 1)
+    {
+        printUsage();
+        return 1;
+    }
+    if (algorithmNames.empty())
+        algorithmNames.push_back("Quick Sort");
+
+    configureThreadPool(threads, false);
+    registerAllAlgorithms();
+
+    std::vector<int> input;
+    if (!makeInput(inputKind, size, seed, input))
+    {
+        std::fprintf(stderr, "unknown input kind: %s\n", inputKind);
+        printUsage();
+        return 1;
+    }
+
+    // Lanes hold their runs' state, so they stay where they were created
+    if (height / algorithmNames.size() < MIN_LANE_HEIGHT)
+    {
+        std::fprintf(stderr, "%zu lanes need --height of at least %zu\n", algorithmNames.size(),
+                     algorithmNames.size() * MIN_LANE_HEIGHT);
+        return 1;
+    }
+    std::deque<Lane> lanes(algorithmNames.size());
+    unsigned laneHeight = static_cast<unsigned>(height / lanes.size());
+    for (size_t i = 0; i < lanes.size(); i++)
+    {
+        lanes[i].algorithm = getAlgorithmByName(algorithmNames[i]);
+        if (!lanes[i].algorithm)
+        {
+            std::fprintf(stderr, "unknown algorithm: %s\n", algorithmNames[i]);
+            return 1;
+        }
+        lanes[i].keys = input;
+        lanes[i].run.start(*lanes[i].algorithm, size);
+        std::printf("lane %zu: %s\n", i + 1, lanes[i].algorithm->name);
+    }
+
+    if (targetFrames > 0)
+    {
+        long long longest = 1;
+        for (const Lane &lane : lanes)
+        {
+            long long length = measureRunLength(*lane.algorithm, input);
+            if (length < 0)
+            {
+                std::fprintf(stderr, "warning: %s takes over %lld step calls, ignoring --frames (--every %lld)\n",
+                             lane.algorithm->name, verificationStepBound(size), every);
+                longest = -1;
+                break;
+            }
+            longest = std::max(longest, length);
+        }
+        if (longest > 0)
+        {
+            every = std::max((longest + targetFrames - 1) / targetFrames, 1LL);
+            std::printf("longest run: %lld step calls, one frame every %lld\n", longest, every);
+        }
+    }
+
+    sf::RenderTexture canvas;
+    if (!canvas.create(width, height))
+    {
+        std::fprintf(stderr, "cannot create a %ux%u offscreen render texture (no OpenGL context? try xvfb-run)\n", width,
+                     height);
+        return 1;
+    }
+
+    FrameEncoder encoder;
+    std::string error;
+    if (!encoder.open(output, width, height, fps, error))
+    {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    bool running = true;
+    while (encoder.framesSubmitted() < maxFrames)
+    {
+        canvas.clear(sf::Color(30, 30, 30));
+        for (size_t i = 0; i < lanes.size(); i++)
+        {
+            Lane &lane = lanes[i];
+            lane.renderer.update(lane.keys.data(), size, 0, static_cast<unsigned>(i * laneHeight), width,
+                                 laneHeight - (lanes.size() > 1 ? LANE_GAP : 0), lane.highlight1, lane.highlight2);
+            lane.renderer.render(canvas);
+        }
+        canvas.display();
+        sf::Image frame = canvas.getTexture().copyToImage();
+        encoder.submit(frame.getPixelsPtr());
+
+        // The frame after the last run completes is the final, sorted one
+        if (!running)
+            break;
+        parallelFor(0, static_cast<long long>(lanes.size()), 1, [&](long long first, long long last) {
+            for (long long i = first; i < last; i++)
+            {
+                advanceLane(lanes[i], every);
+            }
+        });
+        running = std::any_of(lanes.begin(), lanes.end(), [](const Lane &lane) { return !lane.complete; });
+    }
+
+    if (!encoder.close(error))
+    {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    long long frames = encoder.framesSubmitted();
+    std::printf("%lld frames (%.1f s of video at %d fps) in %.1f s: %.1f frames/s, %.1fx realtime\n", frames,
+                static_cast<double>(frames) / fps, fps, seconds, frames / seconds, frames / (seconds * fps));
+    for (const Lane &lane : lanes)
+    {
+        std::printf("%s: %lld step calls%s\n", lane.algorithm->name, lane.calls,
+                    lane.complete ? "" : " (stopped at --max-frames)");
+    }
+    return 0;
+}
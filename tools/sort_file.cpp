@@ -0,0 +1,395 @@
+#include "../algorithms/algorithm_registry.h"
+#include "../algorithms/external_sort.h"
+#include "../algorithms/float_sort.h"
+#include "../algorithms/mapped_file.h"
+#include "../algorithms/radix_keys.h"
+#include "../algorithms/register_algorithms.h"
+#include "../algorithms/sort_runner.h"
+#include "../algorithms/string_sort.h"
+#include "../algorithms/thread_pool.h"
+#include "../algorithms/trace.h"
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+/**
+ * Command line front end for sorting binary files of raw little-endian ints
+ *
+ *   sortfile external <input> <output> [--memory-mb N] [--temp-dir DIR] [--algorithm NAME]
+ *       Sorts 32-bit files larger than RAM with sorted runs and a k-way merge
+ *
+ *   sortfile inplace <file> [--int64 | --float32 | --float64] [--algorithm NAME]
+ *                    [--nans last|first|sign] [--zero-as-positive]
+ *       Memory-maps the file and sorts it in place through the mapping;
+ *       floats go through order-preserving radix keys (see float_sort.h)
+ *
+ *   sortfile lines <input> <output> [--engine msd-radix|multikey-quicksort|lcp-merge]
+ *       Sorts the lines of a text file as byte strings (memcmp order)
+ *
+ * Every command also takes [--threads N] [--pin-threads] to size the shared
+ * thread pool and pin its workers across NUMA nodes
+ */
+
+static void printUsage()
+{
+    std::fprintf(stderr,
+                 "usage:\n"
+                 "  sortfile external <input> <output> [--memory-mb N] [--temp-dir DIR] [--algorithm NAME]\n"
+                 "  sortfile inplace <file> [--int64 | --float32 | --float64] [--algorithm NAME]\n"
+                 "                   [--nans last|first|sign] [--zero-as-positive]\n"
+                 "  sortfile lines <input> <output> [--engine msd-radix|multikey-quicksort|lcp-merge]\n"
+                 "options for every command: [--threads N] [--pin-threads]\n");
+}
+
+/**
+ * Apply and remove the thread pool options, which are valid for every command
+ */
+static void takeThreadOptions(int &argc, char **argv)
+{
+    int threads = 0;
+    bool pinThreads = false;
+    int kept = 1;
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+        {
+            threads = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--pin-threads") == 0)
+        {
+            pinThreads = true;
+        }
+        else
+        {
+            argv[kept++] = argv[i];
+        }
+    }
+    argc = kept;
+    configureThreadPool(threads, pinThreads);
+}
+
+static bool hostIsLittleEndian()
+{
+    const uint16_t probe = 1;
+    return *reinterpret_cast<const unsigned char *>(&probe) == 1;
+}
+
+static int runInPlace(int argc, char **argv)
+{
+    if (argc < 3)
+    {
+        printUsage();
+        return 1;
+    }
+
+    enum ElementKind
+    {
+        INT32,
+        INT64,
+        FLOAT32,
+        FLOAT64
+    };
+    const char *const kindNames[] = {"32-bit ints", "64-bit ints", "floats", "doubles"};
+    const size_t kindSizes[] = {sizeof(int32_t), sizeof(int64_t), sizeof(float), sizeof(double)};
+
+    ElementKind kind = INT32;
+    const AlgorithmInfo *algorithm = nullptr;
+    FloatOrder floatOrder = {NANS_LAST, false};
+    for (int i = 3; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--int64") == 0)
+        {
+            kind = INT64;
+        }
+        else if (std::strcmp(argv[i], "--float32") == 0)
+        {
+            kind = FLOAT32;
+        }
+        else if (std::strcmp(argv[i], "--float64") == 0)
+        {
+            kind = FLOAT64;
+        }
+        else if (std::strcmp(argv[i], "--algorithm") == 0 && i + 1 < argc)
+        {
+            std::string error;
+            algorithm = getBulkSortEngine(argv[++i], error);
+            if (!algorithm)
+            {
+                std::fprintf(stderr, "sortfile: %s\n", error.c_str());
+                return 1;
+            }
+        }
+        else if (std::strcmp(argv[i], "--nans") == 0 && i + 1 < argc)
+        {
+            if (!parseNanPlacement(argv[++i], floatOrder.nans))
+            {
+                printUsage();
+                return 1;
+            }
+        }
+        else if (std::strcmp(argv[i], "--zero-as-positive") == 0)
+        {
+            floatOrder.zeroAsPositive = true;
+        }
+        else
+        {
+            printUsage();
+            return 1;
+        }
+    }
+
+    if (!hostIsLittleEndian())
+    {
+        std::fprintf(stderr, "sortfile: inplace mode needs a little-endian host\n");
+        return 1;
+    }
+
+    // The registered algorithms work on int; 64-bit keys go through the wide radix path
+    if ((kind == INT64 || kind == FLOAT64) && algorithm && std::strcmp(algorithm->name, "Radix Sort") != 0)
+    {
+        std::fprintf(stderr, "sortfile: only Radix Sort handles --int64 and --float64 files\n");
+        return 1;
+    }
+
+    MappedFile file;
+    std::string error;
+    if (!file.open(argv[2], error))
+    {
+        std::fprintf(stderr, "sortfile: %s\n", error.c_str());
+        return 1;
+    }
+
+    size_t elementSize = kindSizes[kind];
+    if (file.size() % elementSize != 0)
+    {
+        std::fprintf(stderr, "sortfile: %s is not a whole number of %d-bit values\n", argv[2],
+                     static_cast<int>(elementSize * 8));
+        return 1;
+    }
+    size_t count = file.size() / elementSize;
+
+    auto start = std::chrono::steady_clock::now();
+    const char *engineName = "Radix Sort";
+    if (kind == INT64)
+    {
+        radixSortInt64(static_cast<int64_t *>(file.data()), count);
+    }
+    else if (kind == FLOAT64)
+    {
+        sortDoubles(static_cast<double *>(file.data()), count, floatOrder);
+    }
+    else if (kind == FLOAT32)
+    {
+        // Without --algorithm, the radix passes on the float keys
+        if (algorithm && std::strcmp(algorithm->name, "Radix Sort") == 0)
+            algorithm = nullptr;
+        if (!sortFloats(static_cast<float *>(file.data()), count, floatOrder, algorithm, error))
+        {
+            std::fprintf(stderr, "sortfile: %s\n", error.c_str());
+            return 1;
+        }
+        if (algorithm)
+            engineName = algorithm->name;
+    }
+    else
+    {
+        if (count > static_cast<size_t>(INT_MAX))
+        {
+            std::fprintf(stderr, "sortfile: more than %d ints; split the file or use external mode\n", INT_MAX);
+            return 1;
+        }
+
+        int *values = static_cast<int *>(file.data());
+        int size = static_cast<int>(count);
+        if (!algorithm)
+        {
+            algorithm = pickFastestAlgorithm(values, size < (1 << 18) ? size : (1 << 18));
+        }
+        if (!algorithm)
+        {
+            std::fprintf(stderr, "sortfile: no registered algorithm has a bulk sort path\n");
+            return 1;
+        }
+        engineName = algorithm->name;
+        runToCompletion(*algorithm, values, size);
+    }
+    double sortSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (!file.close())
+    {
+        std::fprintf(stderr, "sortfile: could not write %s back\n", argv[2]);
+        return 1;
+    }
+
+    std::printf("sorted %zu %s in place with %s in %.2fs\n", count, kindNames[kind], engineName, sortSeconds);
+    return 0;
+}
+
+static int runExternal(int argc, char **argv)
+{
+    if (argc < 4)
+    {
+        printUsage();
+        return 1;
+    }
+
+    ExternalSortOptions options;
+    options.memoryBytes = static_cast<size_t>(1024) * 1024 * 1024;
+    options.tempDirectory = ".";
+    options.engine = nullptr;
+
+    for (int i = 4; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--memory-mb") == 0 && i + 1 < argc)
+        {
+            options.memoryBytes = static_cast<size_t>(std::strtoull(argv[++i], nullptr, 10)) * 1024 * 1024;
+        }
+        else if (std::strcmp(argv[i], "--temp-dir") == 0 && i + 1 < argc)
+        {
+            options.tempDirectory = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--algorithm") == 0 && i + 1 < argc)
+        {
+            std::string error;
+            options.engine = getBulkSortEngine(argv[++i], error);
+            if (!options.engine)
+            {
+                std::fprintf(stderr, "sortfile: %s\n", error.c_str());
+                return 1;
+            }
+        }
+        else
+        {
+            printUsage();
+            return 1;
+        }
+    }
+
+    ExternalSortStats stats;
+    std::string error;
+    if (!externalSort(argv[2], argv[3], options, stats, error))
+    {
+        std::fprintf(stderr, "sortfile: %s\n", error.c_str());
+        return 1;
+    }
+
+    std::printf("sorted %lld ints with %s: %d runs in %.2fs, %d merge pass(es) in %.2fs\n",
+                stats.elements, stats.engineName ? stats.engineName : "-", stats.runs, stats.runSeconds,
+                stats.mergePasses, stats.mergeSeconds);
+    return 0;
+}
+
+static int runLines(int argc, char **argv)
+{
+    if (argc < 4)
+    {
+        printUsage();
+        return 1;
+    }
+
+    StringSortEngine engine = STRING_MSD_RADIX;
+    for (int i = 4; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--engine") == 0 && i + 1 < argc)
+        {
+            if (!findStringSortEngine(argv[++i], engine))
+            {
+                std::fprintf(stderr, "unknown string engine: %s\n", argv[i]);
+                return 1;
+            }
+        }
+        else
+        {
+            printUsage();
+            return 1;
+        }
+    }
+
+    std::FILE *input = std::fopen(argv[2], "rb");
+    if (!input)
+    {
+        std::fprintf(stderr, "sortfile: cannot open %s\n", argv[2]);
+        return 1;
+    }
+    std::string text;
+    char chunk[1 << 16];
+    size_t got;
+    while ((got = std::fread(chunk, 1, sizeof(chunk), input)) > 0)
+        text.append(chunk, got);
+    std::fclose(input);
+
+    // Close up the newlines in place: the lines end up packed back to back
+    std::vector<uint64_t> offsets(1, 0);
+    size_t packed = 0;
+    for (size_t i = 0; i < text.size(); i++)
+    {
+        if (text[i] == '\n')
+            offsets.push_back(packed);
+        else
+            text[packed++] = text[i];
+    }
+    if (offsets.back() != packed)
+        offsets.push_back(packed); // Last line without a newline
+    size_t count = offsets.size() - 1;
+    if (count > 0xFFFFFFFFULL)
+    {
+        std::fprintf(stderr, "sortfile: more than 2^32 - 1 lines\n");
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    StringBatch batch = {text.data(), offsets.data(), count};
+    std::vector<uint32_t> order(count);
+    sortStrings(engine, batch, order.data(), threadScratchArena());
+    double sortSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::FILE *output = std::fopen(argv[3], "wb");
+    if (!output)
+    {
+        std::fprintf(stderr, "sortfile: cannot create %s\n", argv[3]);
+        return 1;
+    }
+    bool written = true;
+    for (uint32_t line : order)
+    {
+        size_t length = offsets[line + 1] - offsets[line];
+        written = written && std::fwrite(text.data() + offsets[line], 1, length, output) == length &&
+                  std::fputc('\n', output) != EOF;
+    }
+    if (std::fclose(output) != 0 || !written)
+    {
+        std::fprintf(stderr, "sortfile: could not write %s\n", argv[3]);
+        return 1;
+    }
+
+    std::printf("sorted %zu lines with %s in %.2fs\n", count, stringSortEngineName(engine), sortSeconds);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    registerAllAlgorithms();
+    startTracingFromEnvironment();
+    takeThreadOptions(argc, argv);
+
+    if (argc >= 2 && std::strcmp(argv[1], "external") == 0)
+    {
+        return runExternal(argc, argv);
+    }
+    if (argc >= 2 && std::strcmp(argv[1], "inplace") == 0)
+    {
+        return runInPlace(argc, argv);
+    }
+    if (argc >= 2 && std::strcmp(argv[1], "lines") == 0)
+    {
+        return runLines(argc, argv);
+    }
+
+    printUsage();
+    return 1;
+}
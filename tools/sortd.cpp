@@ -0,0 +1,446 @@
+#include "../algorithms/algorithm_registry.h"
+#include "../algorithms/latency_histogram.h"
+#include "../algorithms/quick_sort.h"
+#include "../algorithms/register_algorithms.h"
+#include "../algorithms/sort_runner.h"
+#include "../algorithms/thread_pool.h"
+#include "sortd_protocol.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <condition_variable>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+/**
+ * Sorting service
+ *
+ *   sortd [--socket PATH] [--threads N] [--pin-threads] [--batch-max N]
+ *         [--batch-window-us N] [--parallel-threshold N] [--report-seconds N]
+ *
+ * Listens on a Unix socket (see sortd_protocol.h) and sorts memfd payloads in
+ * place with the registered algorithms. Requests below the parallel threshold
+ * are gathered into batches - up to batch-max requests, or whatever arrived
+ * within batch-window-us of the first - and the batch is spread over the
+ * shared thread pool, one request per task. Larger requests are sorted one at
+ * a time by a parallel engine that uses the whole pool by itself. Requests
+ * that name no algorithm are sorted by "Auto"; step-only and selection
+ * algorithms are refused. Payloads must have their size sealed (see
+ * sortd_protocol.h).
+ *
+ * Latency (arrival to reply) is recorded per request; clients can fetch
+ * p50/p90/p99/p99.9 with a STATS request, and the daemon prints them every
+ * report-seconds and on exit, together with how often Quick Sort's guard
+ * against adversarial input stepped in.
+ */
+
+namespace
+{
+struct Options
+{
+    std::string socketPath = SORTD_DEFAULT_SOCKET;
+    int batchMax = 64;
+    int batchWindowMicros = 200;
+    uint64_t parallelThreshold = 1 << 16;
+    int reportSeconds = 0;
+};
+
+struct Connection
+{
+    int fd;
+    std::mutex sendLock; // Replies come from several threads
+
+    explicit Connection(int fd) : fd(fd) {}
+    ~Connection() { close(fd); }
+
+    void reply(const SortdReply &message)
+    {
+        std::lock_guard<std::mutex> guard(sendLock);
+        sortdSend(fd, &message, sizeof(message));
+    }
+};
+
+struct Job
+{
+    std::shared_ptr<Connection> connection; // Keeps the socket open until the reply is sent
+    SortdRequest request;
+    int payload;
+    std::chrono::steady_clock::time_point arrived;
+};
+
+/**
+ * Jobs waiting for a worker; pop() blocks until there is one or the queue closes
+ */
+class JobQueue
+{
+public:
+    void push(Job job)
+    {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            jobs.push_back(std::move(job));
+        }
+        ready.notify_one();
+    }
+
+    /**
+     * Wait for a first job, then gather more until there are maxJobs or window has passed
+     */
+    bool pop(std::vector<Job> &batch, size_t maxJobs, std::chrono::microseconds window)
+    {
+        std::unique_lock<std::mutex> guard(lock);
+        ready.wait(guard, [this]() { return closed || !jobs.empty(); });
+        if (jobs.empty())
+            return false;
+
+        auto deadline = jobs.front().arrived + window;
+        ready.wait_until(guard, deadline, [this, maxJobs]() { return closed || jobs.size() >= maxJobs; });
+
+        batch.clear();
+        while (!jobs.empty() && batch.size() < maxJobs)
+        {
+            batch.push_back(std::move(jobs.front()));
+            jobs.pop_front();
+        }
+        return true;
+    }
+
+    void close()
+    {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            closed = true;
+        }
+        ready.notify_all();
+    }
+
+private:
+    std::mutex lock;
+    std::condition_variable ready;
+    std::deque<Job> jobs;
+    bool closed = false;
+};
+
+volatile std::sig_atomic_t stopRequested = 0;
+
+void requestStop(int)
+{
+    stopRequested = 1;
+}
+
+LatencyHistogram allLatency;
+LatencyHistogram batchedLatency;
+LatencyHistogram parallelLatency;
+std::atomic<uint64_t> batchCount(0);
+
+SortdLatency summarize(const LatencyHistogram &histogram)
+{
+    SortdLatency summary;
+    summary.count = histogram.count();
+    summary.p50 = histogram.percentile(50.0);
+    summary.p90 = histogram.percentile(90.0);
+    summary.p99 = histogram.percentile(99.0);
+    summary.p999 = histogram.percentile(99.9);
+    summary.max = histogram.maxValue();
+    return summary;
+}
+
+void printLatency(const char *label, const LatencyHistogram &histogram)
+{
+    SortdLatency summary = summarize(histogram);
+    std::printf("  %-9s %9llu req | p50 %7lluus | p90 %7lluus | p99 %7lluus | p99.9 %7lluus | max %7lluus\n",
+                label, static_cast<unsigned long long>(summary.count), static_cast<unsigned long long>(summary.p50),
+                static_cast<unsigned long long>(summary.p90), static_cast<unsigned long long>(summary.p99),
+                static_cast<unsigned long long>(summary.p999), static_cast<unsigned long long>(summary.max));
+}
+
+void printReport()
+{
+    std::printf("sortd latency (%llu batches):\n", static_cast<unsigned long long>(batchCount.load()));
+    printLatency("all", allLatency);
+    printLatency("batched", batchedLatency);
+    printLatency("parallel", parallelLatency);
+    QuickSortGuardCounts guard = quickSortGuardCounts();
+    std::printf("  quick sort guard: %lld pivot shuffles | %lld heap fallbacks\n", guard.pivotShuffles,
+                guard.heapFallbacks);
+    std::fflush(stdout);
+}
+
+/**
+ * Sort one payload in place and reply
+ */
+void runJob(Job &job, bool parallel)
+{
+    SortdReply reply;
+    std::memset(&reply, 0, sizeof(reply));
+    reply.magic = SORTD_MAGIC;
+    reply.status = SORTD_OK;
+    reply.id = job.request.id;
+
+    const AlgorithmInfo *algorithm = nullptr;
+    if (job.request.algorithm[0])
+    {
+        char name[sizeof(job.request.algorithm) + 1] = {0};
+        std::memcpy(name, job.request.algorithm, sizeof(job.request.algorithm));
+        // Selection and step-only engines would not sort the payload in bounded time
+        std::string error;
+        algorithm = getBulkSortEngine(name, error);
+        if (!algorithm)
+            reply.status = SORTD_UNKNOWN_ALGORITHM;
+    }
+    else
+    {
+        // Auto picks per input: sequential engines for small sorts, parallel ones for large
+        algorithm = getAlgorithmByName("Auto");
+    }
+
+    // The client keeps its end of the memfd; without size seals it could shrink
+    // the file mid-sort and fault this process with SIGBUS
+    const int SIZE_SEALS = F_SEAL_SHRINK | F_SEAL_GROW;
+    size_t bytes = job.request.count * sizeof(int);
+    struct stat info;
+    if (reply.status == SORTD_OK && (fstat(job.payload, &info) != 0 || static_cast<uint64_t>(info.st_size) < bytes))
+        reply.status = SORTD_BAD_REQUEST;
+    int seals = reply.status == SORTD_OK ? fcntl(job.payload, F_GET_SEALS) : 0;
+    if (reply.status == SORTD_OK && (seals < 0 || (seals & SIZE_SEALS) != SIZE_SEALS))
+        reply.status = SORTD_BAD_REQUEST;
+
+    if (reply.status == SORTD_OK && bytes > 0)
+    {
+        void *mapping = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, job.payload, 0);
+        if (mapping == MAP_FAILED)
+        {
+            reply.status = SORTD_MAP_FAILED;
+        }
+        else
+        {
+            auto start = std::chrono::steady_clock::now();
+            runToCompletion(*algorithm, static_cast<int *>(mapping), static_cast<int>(job.request.count));
+            reply.serviceMicros = std::chrono::duration_cast<std::chrono::microseconds>(
+                                      std::chrono::steady_clock::now() - start)
+                                      .count();
+            munmap(mapping, bytes);
+        }
+    }
+    if (algorithm)
+        std::strncpy(reply.engine, algorithm->name, sizeof(reply.engine) - 1);
+    close(job.payload);
+
+    job.connection->reply(reply);
+
+    uint64_t latency = std::chrono::duration_cast<std::chrono::microseconds>(
+                           std::chrono::steady_clock::now() - job.arrived)
+                           .count();
+    allLatency.record(latency);
+    (parallel ? parallelLatency : batchedLatency).record(latency);
+}
+
+void batchWorker(JobQueue &queue, const Options &options)
+{
+    std::vector<Job> batch;
+    while (queue.pop(batch, options.batchMax, std::chrono::microseconds(options.batchWindowMicros)))
+    {
+        batchCount++;
+        parallelFor(0, static_cast<long long>(batch.size()), 1, [&batch](long long first, long long last) {
+            for (long long i = first; i < last; i++)
+                runJob(batch[i], false);
+        });
+    }
+}
+
+void parallelWorker(JobQueue &queue)
+{
+    std::vector<Job> one;
+    while (queue.pop(one, 1, std::chrono::microseconds(0)))
+    {
+        runJob(one[0], true);
+    }
+}
+
+void printUsage()
+{
+    std::fprintf(stderr, "usage: sortd [--socket PATH] [--threads N] [--pin-threads] [--batch-max N]\n"
+                         "             [--batch-window-us N] [--parallel-threshold N] [--report-seconds N]\n");
+}
+}
+
+int main(int argc, char **argv)
+{
+    Options options;
+    int threads = 0;
+    bool pinThreads = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--socket") == 0 && hasValue)
+            options.socketPath = argv[++i];
+        else if (std::strcmp(argv[i], "--threads") == 0 && hasValue)
+            threads = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--pin-threads") == 0)
+            pinThreads = true;
+        else if (std::strcmp(argv[i], "--batch-max") == 0 && hasValue)
+            options.batchMax = std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--batch-window-us") == 0 && hasValue)
+            options.batchWindowMicros = std::max(0, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--parallel-threshold") == 0 && hasValue)
+            options.parallelThreshold = std::strtoull(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "--report-seconds") == 0 && hasValue)
+            options.reportSeconds = std::max(0, std::atoi(argv[++i]));
+        else
+        {
+            printUsage();
+            return 1;
+        }
+    }
+
+    registerAllAlgorithms();
+    configureThreadPool(threads, pinThreads);
+
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (options.socketPath.size() >= sizeof(address.sun_path))
+    {
+        std::fprintf(stderr, "sortd: socket path too long\n");
+        return 1;
+    }
+    std::strcpy(address.sun_path, options.socketPath.c_str());
+
+    int listener = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    unlink(options.socketPath.c_str());
+    if (listener < 0 || bind(listener, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 ||
+        listen(listener, 128) != 0)
+    {
+        std::fprintf(stderr, "sortd: cannot listen on %s: %s\n", options.socketPath.c_str(), std::strerror(errno));
+        return 1;
+    }
+
+    std::signal(SIGINT, requestStop);
+    std::signal(SIGTERM, requestStop);
+    std::signal(SIGPIPE, SIG_IGN);
+
+    JobQueue batchQueue;
+    JobQueue parallelQueue;
+    std::thread batchThread(batchWorker, std::ref(batchQueue), std::cref(options));
+    std::thread parallelThread(parallelWorker, std::ref(parallelQueue));
+
+    std::printf("sortd listening on %s (%d threads)\n", options.socketPath.c_str(), getThreadPool().size());
+    std::fflush(stdout);
+
+    std::map<int, std::shared_ptr<Connection>> connections;
+    auto lastReport = std::chrono::steady_clock::now();
+
+    while (!stopRequested)
+    {
+        std::vector<pollfd> watched;
+        watched.push_back({listener, POLLIN, 0});
+        for (const auto &entry : connections)
+        {
+            watched.push_back({entry.first, POLLIN, 0});
+        }
+
+        if (poll(watched.data(), watched.size(), 250) < 0 && errno != EINTR)
+            break;
+
+        if (watched[0].revents & POLLIN)
+        {
+            int client = accept4(listener, nullptr, nullptr, SOCK_CLOEXEC);
+            if (client >= 0)
+                connections[client] = std::make_shared<Connection>(client);
+        }
+
+        for (size_t w = 1; w < watched.size(); w++)
+        {
+            if (!watched[w].revents)
+                continue;
+
+            std::shared_ptr<Connection> connection = connections[watched[w].fd];
+            SortdRequest request;
+            int payload = -1;
+            ssize_t received = sortdReceive(connection->fd, &request, sizeof(request), payload);
+            if (received <= 0)
+            {
+                // Closed (or broken): in-flight jobs still hold the connection until they reply
+                if (payload >= 0)
+                    close(payload);
+                connections.erase(watched[w].fd);
+                continue;
+            }
+
+            SortdReply reply;
+            std::memset(&reply, 0, sizeof(reply));
+            reply.magic = SORTD_MAGIC;
+            reply.id = request.id;
+
+            if (received != sizeof(request) || request.magic != SORTD_MAGIC)
+            {
+                reply.status = SORTD_BAD_REQUEST;
+            }
+            else if (request.type == SORTD_STATS)
+            {
+                reply.status = SORTD_OK;
+                reply.all = summarize(allLatency);
+                reply.batched = summarize(batchedLatency);
+                reply.parallel = summarize(parallelLatency);
+                reply.batches = batchCount.load();
+                QuickSortGuardCounts guard = quickSortGuardCounts();
+                reply.pivotShuffles = static_cast<uint64_t>(guard.pivotShuffles);
+                reply.heapFallbacks = static_cast<uint64_t>(guard.heapFallbacks);
+            }
+            else if (request.type == SORTD_SORT && payload >= 0 && request.count <= static_cast<uint64_t>(INT_MAX))
+            {
+                Job job = {connection, request, payload, std::chrono::steady_clock::now()};
+                payload = -1;
+                if (request.count >= options.parallelThreshold)
+                    parallelQueue.push(std::move(job));
+                else
+                    batchQueue.push(std::move(job));
+                continue;
+            }
+            else
+            {
+                reply.status = SORTD_BAD_REQUEST;
+            }
+
+            if (payload >= 0)
+                close(payload);
+            connection->reply(reply);
+        }
+
+        if (options.reportSeconds > 0 &&
+            std::chrono::steady_clock::now() - lastReport >= std::chrono::seconds(options.reportSeconds))
+        {
+            printReport();
+            lastReport = std::chrono::steady_clock::now();
+        }
+    }
+
+    batchQueue.close();
+    parallelQueue.close();
+    batchThread.join();
+    parallelThread.join();
+    connections.clear();
+    close(listener);
+    unlink(options.socketPath.c_str());
+
+    printReport();
+    return 0;
+}
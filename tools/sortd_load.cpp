@@ -0,0 +1,198 @@
+#include "../algorithms/latency_histogram.h"
+#include "sortd_protocol.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+/**
+ * Load generator for sortd
+ *
+ *   sortd_load [--socket PATH] [--clients N] [--requests N] [--size N] [--algorithm NAME]
+ *
+ * Every client thread opens its own connection and memfd and sends requests
+ * back to back, checking each result. Prints the latency the clients saw,
+ * then the server's own statistics.
+ */
+
+namespace
+{
+int connectTo(const std::string &path)
+{
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+
+    int fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (fd >= 0 && connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0)
+    {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+void printLatency(const char *label, const SortdLatency &latency)
+{
+    std::printf("  %-9s %9llu req | p50 %7lluus | p90 %7lluus | p99 %7lluus | p99.9 %7lluus | max %7lluus\n",
+                label, static_cast<unsigned long long>(latency.count), static_cast<unsigned long long>(latency.p50),
+                static_cast<unsigned long long>(latency.p90), static_cast<unsigned long long>(latency.p99),
+                static_cast<unsigned long long>(latency.p999), static_cast<unsigned long long>(latency.max));
+}
+}
+
+int main(int argc, char **argv)
+{
+    std::string socketPath = SORTD_DEFAULT_SOCKET;
+    int clients = 4;
+    int requests = 1000;
+    uint64_t size = 1000;
+    std::string algorithm;
+
+    for (int i = 1; i < argc; i++)
+    {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--socket") == 0 && hasValue)
+            socketPath = argv[++i];
+        else if (std::strcmp(argv[i], "--clients") == 0 && hasValue)
+            clients = std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--requests") == 0 && hasValue)
+            requests = std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--size") == 0 && hasValue)
+            size = std::strtoull(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "--algorithm") == 0 && hasValue)
+            algorithm = argv[++i];
+        else
+        {
+            std::fprintf(stderr, "usage: sortd_load [--socket PATH] [--clients N] [--requests N] [--size N] "
+                                 "[--algorithm NAME]\n");
+            return 1;
+        }
+    }
+
+    // Leaves room for the terminating NUL of the request's name field
+    if (algorithm.size() >= sizeof(SortdRequest::algorithm))
+    {
+        std::fprintf(stderr, "sortd_load: algorithm name longer than %zu characters\n",
+                     sizeof(SortdRequest::algorithm) - 1);
+        return 1;
+    }
+
+    LatencyHistogram latency;
+    std::atomic<int> failures(0);
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+
+    for (int c = 0; c < clients; c++)
+    {
+        threads.emplace_back([&, c]() {
+            int connection = connectTo(socketPath);
+            int payload = memfd_create("sortd-payload", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+            size_t bytes = size * sizeof(int);
+
+            // The server only maps payloads whose size is sealed
+            void *mapping = MAP_FAILED;
+            if (connection >= 0 && payload >= 0 && ftruncate(payload, bytes) == 0 &&
+                fcntl(payload, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW) == 0)
+            {
+                mapping = bytes ? mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, payload, 0) : nullptr;
+            }
+            if (mapping == MAP_FAILED)
+            {
+                failures += requests;
+                if (payload >= 0)
+                    close(payload);
+                if (connection >= 0)
+                    close(connection);
+                return;
+            }
+
+            int *values = static_cast<int *>(mapping);
+            std::mt19937 random(c + 1);
+
+            for (int r = 0; r < requests; r++)
+            {
+                for (uint64_t i = 0; i < size; i++)
+                {
+                    values[i] = static_cast<int>(random());
+                }
+
+                SortdRequest request;
+                std::memset(&request, 0, sizeof(request));
+                request.magic = SORTD_MAGIC;
+                request.type = SORTD_SORT;
+                request.id = static_cast<uint64_t>(c) << 32 | r;
+                request.count = size;
+                std::memcpy(request.algorithm, algorithm.c_str(), algorithm.size());
+
+                auto sent = std::chrono::steady_clock::now();
+                SortdReply reply;
+                int unused = -1;
+                if (!sortdSend(connection, &request, sizeof(request), payload) ||
+                    sortdReceive(connection, &reply, sizeof(reply), unused) != sizeof(reply))
+                {
+                    failures++;
+                    break;
+                }
+                latency.record(std::chrono::duration_cast<std::chrono::microseconds>(
+                                   std::chrono::steady_clock::now() - sent)
+                                   .count());
+
+                if (reply.status != SORTD_OK || reply.id != request.id || !std::is_sorted(values, values + size))
+                    failures++;
+            }
+
+            if (values)
+                munmap(values, bytes);
+            close(payload);
+            close(connection);
+        });
+    }
+
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::printf("%d clients x %d requests of %llu ints in %.2fs (%.0f req/s), %d failed\n", clients, requests,
+                static_cast<unsigned long long>(size), seconds, clients * requests / seconds, failures.load());
+    SortdLatency seen = {latency.count(), latency.percentile(50.0), latency.percentile(90.0),
+                         latency.percentile(99.0), latency.percentile(99.9), latency.maxValue()};
+    std::printf("client latency:\n");
+    printLatency("all", seen);
+
+    int connection = connectTo(socketPath);
+    SortdRequest request;
+    std::memset(&request, 0, sizeof(request));
+    request.magic = SORTD_MAGIC;
+    request.type = SORTD_STATS;
+    SortdReply reply;
+    int unused = -1;
+    if (connection >= 0 && sortdSend(connection, &request, sizeof(request)) &&
+        sortdReceive(connection, &reply, sizeof(reply), unused) == sizeof(reply))
+    {
+        std::printf("server latency (%llu batches):\n", static_cast<unsigned long long>(reply.batches));
+        printLatency("all", reply.all);
+        printLatency("batched", reply.batched);
+        printLatency("parallel", reply.parallel);
+        std::printf("  quick sort guard: %llu pivot shuffles | %llu heap fallbacks\n",
+                    static_cast<unsigned long long>(reply.pivotShuffles),
+                    static_cast<unsigned long long>(reply.heapFallbacks));
+    }
+    if (connection >= 0)
+        close(connection);
+
+    return failures.load() == 0 ? 0 : 1;
+}
@@ -0,0 +1,138 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+
+/**
+ * Wire format between sortd and its clients (Linux only)
+ *
+ * The socket is a SOCK_SEQPACKET Unix socket, so every request and reply is
+ * one message. A sort request does not carry its data: the client writes
+ * `count` 32-bit ints into a memfd, maps it and passes the descriptor along
+ * with the request (SCM_RIGHTS). The memfd must be created with
+ * MFD_ALLOW_SEALING and carry F_SEAL_SHRINK and F_SEAL_GROW, so that its size
+ * cannot change under the server's mapping (a shrink would fault the server
+ * with SIGBUS). The server maps the same pages, sorts them in place and
+ * replies; the client reads the result from its own mapping.
+ * Replies come back in completion order - match them up by id.
+ */
+
+static const char *const SORTD_DEFAULT_SOCKET = "/tmp/sortd.sock";
+static const uint32_t SORTD_MAGIC = 0x534f5254; // "SORT"
+
+enum SortdRequestType : uint32_t
+{
+    SORTD_SORT = 1, // Sort the attached memfd
+    SORTD_STATS = 2 // Reply with the latency statistics and guard counts
+};
+
+enum SortdStatus : uint32_t
+{
+    SORTD_OK = 0,
+    SORTD_BAD_REQUEST = 1,       // Malformed, or the memfd is too small or its size is not sealed
+    SORTD_UNKNOWN_ALGORITHM = 2, // Not registered, or not a whole-array sort (isBulkSortEngine)
+    SORTD_MAP_FAILED = 3
+};
+
+struct SortdRequest
+{
+    uint32_t magic;
+    uint32_t type;
+    uint64_t id;        // Echoed in the reply
+    uint64_t count;     // Number of ints in the memfd
+    char algorithm[32]; // Registered name; empty lets the server choose
+};
+
+/**
+ * Latency from the request arriving to its reply being sent, in microseconds
+ */
+struct SortdLatency
+{
+    uint64_t count;
+    uint64_t p50;
+    uint64_t p90;
+    uint64_t p99;
+    uint64_t p999;
+    uint64_t max;
+};
+
+struct SortdReply
+{
+    uint32_t magic;
+    uint32_t status;
+    uint64_t id;
+    uint64_t serviceMicros; // Time spent sorting (sort replies)
+    char engine[32];        // Algorithm that sorted it (sort replies)
+
+    // Stats replies only
+    SortdLatency all;
+    SortdLatency batched;  // Small requests sorted together in batches
+    SortdLatency parallel; // Large requests given to the parallel engines
+    uint64_t batches;
+    uint64_t pivotShuffles; // Quick Sort bad split guard: random pivots taken
+    uint64_t heapFallbacks; // Quick Sort bad split guard: ranges heap sorted instead
+};
+
+/**
+ * Send one message, optionally passing a file descriptor with it
+ */
+inline bool sortdSend(int socket, const void *message, size_t length, int fd = -1)
+{
+    iovec part;
+    part.iov_base = const_cast<void *>(message);
+    part.iov_len = length;
+
+    msghdr header;
+    std::memset(&header, 0, sizeof(header));
+    header.msg_iov = &part;
+    header.msg_iovlen = 1;
+
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))];
+    if (fd >= 0)
+    {
+        std::memset(control, 0, sizeof(control));
+        header.msg_control = control;
+        header.msg_controllen = sizeof(control);
+        cmsghdr *rights = CMSG_FIRSTHDR(&header);
+        rights->cmsg_level = SOL_SOCKET;
+        rights->cmsg_type = SCM_RIGHTS;
+        rights->cmsg_len = CMSG_LEN(sizeof(int));
+        std::memcpy(CMSG_DATA(rights), &fd, sizeof(int));
+    }
+
+    return sendmsg(socket, &header, MSG_NOSIGNAL) == static_cast<ssize_t>(length);
+}
+
+/**
+ * Receive one message and the descriptor passed with it (-1 if none)
+ * @return: Message length, 0 when the peer has closed, -1 on error
+ */
+inline ssize_t sortdReceive(int socket, void *message, size_t length, int &fd)
+{
+    iovec part;
+    part.iov_base = message;
+    part.iov_len = length;
+
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))];
+    msghdr header;
+    std::memset(&header, 0, sizeof(header));
+    header.msg_iov = &part;
+    header.msg_iovlen = 1;
+    header.msg_control = control;
+    header.msg_controllen = sizeof(control);
+
+    fd = -1;
+    ssize_t received = recvmsg(socket, &header, MSG_CMSG_CLOEXEC);
+    if (received <= 0)
+        return received;
+
+    for (cmsghdr *rights = CMSG_FIRSTHDR(&header); rights; rights = CMSG_NXTHDR(&header, rights))
+    {
+        if (rights->cmsg_level == SOL_SOCKET && rights->cmsg_type == SCM_RIGHTS)
+            std::memcpy(&fd, CMSG_DATA(rights), sizeof(int));
+    }
+    return received;
+}